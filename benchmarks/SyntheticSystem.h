@@ -0,0 +1,78 @@
+#ifndef SYNTHETICSYSTEM_H
+#define SYNTHETICSYSTEM_H
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "AtomTable.h"
+#include "Frame.h"
+#include "PointCharge.h"
+#include "Topology.h"
+
+namespace cpet::bench {
+
+/* Charges spread through a 40 A cube about the origin, clear of the 2 A
+ * box the fields are computed in */
+inline std::vector<PointCharge> randomCharges(const size_t count,
+                                              const uint32_t seed = 1) {
+  std::mt19937 generator{seed};
+  std::uniform_real_distribution<double> coordinate(-20.0, 20.0);
+  std::uniform_real_distribution<double> charge(-1.0, 1.0);
+  std::vector<PointCharge> result;
+  result.reserve(count);
+  while (result.size() < count) {
+    const Eigen::Vector3d position{coordinate(generator),
+                                   coordinate(generator),
+                                   coordinate(generator)};
+    if (position.cwiseAbs().maxCoeff() > 3.0) {
+      result.emplace_back(position, charge(generator));
+    }
+  }
+  return result;
+}
+
+/* Frame whose atoms are named A:<i / 3 + 1>:C<i % 3> */
+inline Frame makeFrame(const std::vector<PointCharge>& charges) {
+  AtomTable atoms;
+  std::vector<Eigen::Vector3d> coordinates;
+  std::vector<double> values;
+  for (size_t i = 0; i < charges.size(); i++) {
+    atoms.push_back(AtomID{"A:" + std::to_string(i / 3 + 1) + ":C" +
+                           std::to_string(i % 3)});
+    coordinates.push_back(charges[i].coordinate);
+    values.push_back(charges[i].charge);
+  }
+  return Frame{std::move(coordinates),
+               std::make_shared<const Topology>(std::move(atoms),
+                                                std::move(values))};
+}
+
+/* Writes frames models of atoms randomCharges to a pqr file */
+inline void writeTrajectory(const std::string& file, const size_t atoms,
+                            const size_t frames) {
+  std::ofstream out(file);
+  out << std::fixed << std::setprecision(3);
+  for (size_t frame = 0; frame < frames; frame++) {
+    out << "MODEL " << frame + 1 << '\n';
+    const auto charges = randomCharges(atoms, static_cast<uint32_t>(frame));
+    for (size_t i = 0; i < charges.size(); i++) {
+      const auto& c = charges[i];
+      out << "ATOM  " << std::setw(5) << i + 1 << " C" << std::left
+          << std::setw(3) << i % 3 << std::right << " GLY A" << std::setw(4)
+          << i / 3 + 1 << "    " << std::setw(8) << c.coordinate[0]
+          << std::setw(8) << c.coordinate[1] << std::setw(8)
+          << c.coordinate[2] << std::setw(8) << c.charge << " 1.500\n";
+    }
+    out << "ENDMDL\n";
+  }
+}
+
+}  // namespace cpet::bench
+#endif  // SYNTHETICSYSTEM_H
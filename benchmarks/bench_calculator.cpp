@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "Calculator.h"
+
+namespace {
+/* A full run of the checked-in helix trajectory: field locations, a plot3d
+ * volume and a topology block with its distance matrix */
+void BM_CalculatorCompute(benchmark::State& state) {
+  const std::filesystem::path data{CPET_BENCHMARK_DATA};
+  const auto protein = (data / "helix.pqr").string();
+  const auto options = (data / "benchmark_options").string();
+
+  /* Results are written to the working directory */
+  const auto previous = std::filesystem::current_path();
+  const auto output =
+      std::filesystem::temp_directory_path() / "cpet_benchmark_output";
+  std::filesystem::create_directories(output);
+  std::filesystem::current_path(output);
+  for (auto _ : state) {
+    cpet::Calculator calculator{protein, options, {},
+                                static_cast<int>(state.range(0))};
+    calculator.compute();
+  }
+  std::filesystem::current_path(previous);
+  std::filesystem::remove_all(output);
+}
+BENCHMARK(BM_CalculatorCompute)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kSecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Box.h"
+#include "ElectricField.h"
+#include "FieldSolver.h"
+#include "SyntheticSystem.h"
+#include "System.h"
+#include "ThreadPool.h"
+
+namespace {
+/* Field at one point, summed over every charge */
+void BM_ElectricFieldAtPoint(benchmark::State& state) {
+  const auto charges = static_cast<size_t>(state.range(0));
+  const cpet::System system{
+      cpet::bench::makeFrame(cpet::bench::randomCharges(charges))};
+  const Eigen::Vector3d point{0.1, -0.2, 0.3};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(system.electricFieldAt(point));
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(charges));
+}
+BENCHMARK(BM_ElectricFieldAtPoint)->RangeMultiplier(8)->Range(64, 32768);
+
+/* Field at one packet of points in a single pass over the charges */
+void BM_ElectricFieldAtPacket(benchmark::State& state) {
+  const auto charges = static_cast<size_t>(state.range(0));
+  const cpet::System system{
+      cpet::bench::makeFrame(cpet::bench::randomCharges(charges))};
+  cpet::field::PointPacket points;
+  for (size_t i = 0; i < points.size(); i++) {
+    points[i] = Eigen::Vector3d{0.1, -0.2, 0.3} * static_cast<double>(i);
+  }
+  cpet::field::PointPacket fields;
+  for (auto _ : state) {
+    cpet::field::electricFieldAt(system.chargeStore(), points, fields);
+    benchmark::DoNotOptimize(fields);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(charges * points.size()));
+}
+BENCHMARK(BM_ElectricFieldAtPacket)->RangeMultiplier(8)->Range(64, 32768);
+
+/* Field at the points of a plot3d volume, by solver and thread count */
+void BM_ElectricFieldAtVolume(benchmark::State& state) {
+  const auto charges = static_cast<size_t>(state.range(0));
+  cpet::FieldSolver solver;
+  if (state.range(1) != 0) {
+    solver.type = cpet::FieldSolver::Type::multipole;
+  }
+  const cpet::System system{
+      cpet::bench::makeFrame(cpet::bench::randomCharges(charges))};
+  const cpet::Box box{{2, 2, 2}};
+  const auto points = box.partition({10, 10, 10});
+  cpet::util::ThreadPool pool{static_cast<int>(state.range(2))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        system.electricFieldAt(points, solver, box, pool));
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(points.size()));
+}
+BENCHMARK(BM_ElectricFieldAtVolume)
+    ->ArgNames({"charges", "multipole", "threads"})
+    ->ArgsProduct({{1024, 16384}, {0, 1}, {1, 4}})
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "DistanceMatrix.h"
+#include "Histogram2D.h"
+#include "ThreadPool.h"
+
+namespace {
+/* Distance-curvature samples of one frame into bins x bins */
+void BM_Construct2DHistogram(benchmark::State& state) {
+  const auto samples = static_cast<size_t>(state.range(0));
+  const auto bins = static_cast<int>(state.range(1));
+  std::mt19937 generator{1};
+  std::uniform_real_distribution<double> distance(0.0, 4.0);
+  std::exponential_distribution<double> curvature(2.0);
+  std::vector<double> x;
+  std::vector<double> y;
+  for (size_t i = 0; i < samples; i++) {
+    x.push_back(distance(generator));
+    y.push_back(curvature(generator));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cpet::histo::construct2DHistogram(
+        x, y, {bins, bins}, {0.0, 4.0}, {0.0, 5.0}));
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(samples));
+}
+BENCHMARK(BM_Construct2DHistogram)
+    ->ArgNames({"samples", "bins"})
+    ->ArgsProduct({{10000, 1000000}, {20, 200}});
+
+/* chi distances between every pair of frames of bins x bins histograms */
+void BM_ChiDistanceMatrix(benchmark::State& state) {
+  const auto frames = static_cast<size_t>(state.range(0));
+  const auto bins = static_cast<size_t>(state.range(1) * state.range(1));
+  std::mt19937 generator{1};
+  std::uniform_real_distribution<double> value(0.0, 1.0);
+  cpet::histo::HistogramMatrix histograms{frames, bins};
+  for (size_t frame = 0; frame < frames; frame++) {
+    double* row = histograms.row(frame);
+    double sum = 0.0;
+    for (size_t bin = 0; bin < bins; bin++) {
+      row[bin] = value(generator) < 0.1 ? value(generator) : 0.0;
+      sum += row[bin];
+    }
+    for (size_t bin = 0; bin < bins; bin++) {
+      row[bin] /= sum;
+    }
+  }
+  cpet::util::ThreadPool pool{static_cast<int>(state.range(2))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        cpet::histo::chiDistanceMatrix(histograms, pool));
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(frames * (frames - 1) / 2));
+}
+BENCHMARK(BM_ChiDistanceMatrix)
+    ->ArgNames({"frames", "bins", "threads"})
+    ->ArgsProduct({{100, 1000}, {20, 200}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "SyntheticSystem.h"
+#include "TrajectoryReader.h"
+
+namespace {
+/* Every frame of a pqr trajectory, read a window at a time as compute()
+ * does */
+void BM_ReadTrajectory(benchmark::State& state) {
+  const auto atoms = static_cast<size_t>(state.range(0));
+  const auto frames = static_cast<size_t>(state.range(1));
+  const auto file = (std::filesystem::temp_directory_path() /
+                     ("cpet_benchmark_" + std::to_string(atoms) + "_" +
+                      std::to_string(frames) + ".pqr"))
+                        .string();
+  cpet::bench::writeTrajectory(file, atoms, frames);
+  constexpr size_t WINDOW = 8;
+  for (auto _ : state) {
+    const auto reader = cpet::TrajectoryReader::open(file, 0, 1);
+    size_t read = 0;
+    for (auto window = reader->next(WINDOW); !window.empty();
+         window = reader->next(WINDOW)) {
+      read += window.size();
+    }
+    benchmark::DoNotOptimize(read);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(atoms * frames));
+  state.SetBytesProcessed(
+      state.iterations() *
+      static_cast<int64_t>(std::filesystem::file_size(file)));
+  std::filesystem::remove(file);
+}
+BENCHMARK(BM_ReadTrajectory)
+    ->ArgNames({"atoms", "frames"})
+    ->ArgsProduct({{1000, 20000}, {10, 100}})
+    ->Unit(benchmark::kMillisecond);
+}  // namespace
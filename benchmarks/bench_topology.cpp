@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+
+#include "Box.h"
+#include "FieldSolver.h"
+#include "Integrator.h"
+#include "Random.h"
+#include "SyntheticSystem.h"
+#include "System.h"
+#include "ThreadPool.h"
+
+namespace {
+/* Streamline samples of one frame, as drawn by a topology block */
+void BM_TopologySamples(benchmark::State& state) {
+  const auto samples = static_cast<int>(state.range(0));
+  const cpet::System system{cpet::bench::makeFrame(
+      cpet::bench::randomCharges(static_cast<size_t>(state.range(1))))};
+  const cpet::Box box{{2, 2, 2}};
+  constexpr double STEP_SIZE = 0.01;
+  cpet::util::ThreadPool pool{static_cast<int>(state.range(2))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(system.electricFieldTopologyIn(
+        pool, box, STEP_SIZE, samples, cpet::FieldSolver{},
+        cpet::GridInterpolation{}, cpet::Integrator{},
+        cpet::util::SampleStream{1, 0, 0}));
+  }
+  state.SetItemsProcessed(state.iterations() * samples);
+}
+BENCHMARK(BM_TopologySamples)
+    ->ArgNames({"samples", "charges", "threads"})
+    ->ArgsProduct({{100, 1000}, {256, 4096}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
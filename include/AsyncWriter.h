@@ -0,0 +1,67 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+/* C++ STL HEADER FILES */
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+/* CPET HEADER FILES */
+#include "RAIIThread.h"
+
+namespace cpet {
+namespace util {
+
+/* Number of windows of results that may wait to be written */
+constexpr size_t DEFAULT_WRITE_QUEUE = 4;
+
+/* Runs output jobs in submission order on one background thread, so
+ * results are formatted and written while the next window computes. A job
+ * owns the results it writes. submit blocks while capacity jobs are
+ * waiting, which bounds the memory held by unwritten results. */
+class AsyncWriter {
+ public:
+  using Job = std::function<void()>;
+
+  explicit AsyncWriter(size_t capacity = DEFAULT_WRITE_QUEUE);
+
+  AsyncWriter(const AsyncWriter&) = delete;
+
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+  /* Finishes the queued jobs */
+  ~AsyncWriter();
+
+  /* Queues a job. The first exception thrown by an earlier job is rethrown
+   * here instead, and no further jobs run after it. */
+  void submit(Job job);
+
+  /* Blocks until every queued job has run, then rethrows the first
+   * exception thrown by one */
+  void wait();
+
+ private:
+  size_t capacity_;
+  std::deque<Job> jobs_;
+  bool busy_{false};
+  bool stop_{false};
+  std::exception_ptr error_{nullptr};
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+
+  /* Declared last: started after and joined before the state it uses */
+  RAIIThread thread_;
+
+  void run_();
+};
+
+}  // namespace util
+}  // namespace cpet
+#endif  // ASYNCWRITER_H
@@ -9,8 +9,8 @@
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <string_view>
 #include <utility>
-#include <sstream>
 
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <Eigen/Dense>
@@ -106,39 +106,45 @@ class AtomID {
     }
   }
 
+  /* ID of an atom in a structure file line. Reads the fields in place, so
+   * the only allocation is the ID string itself. */
   [[nodiscard]] static inline AtomID generateID(const std::string_view line,
                                                 const constants::FileType ft) {
-    std::stringstream result_stream;
     switch (ft) {
       case constants::FileType::pqr: {
-        const auto tokens = util::split(line, ' ');
-        if (tokens.size() <= constants::PQR_MIN_INDEX) {
-          throw cpet::value_error("pqr line too short: " +
-                                  static_cast<std::string>(line));
+        std::string_view rest = line;
+        std::string_view atom;
+        std::string_view chain;
+        std::string_view residue;
+        for (size_t i = 0; i <= constants::PQR_MIN_INDEX; i++) {
+          const auto token = util::nextToken(rest);
+          if (token.empty()) {
+            throw cpet::value_error("pqr line too short: " +
+                                    static_cast<std::string>(line));
+          }
+          if (i == constants::PQR_ATOMID_INDEX) {
+            atom = token;
+          } else if (i == constants::PQR_CHAIN_INDEX) {
+            chain = token;
+          } else if (i == constants::PQR_RESNUM_INDEX) {
+            residue = token;
+          }
         }
-        result_stream << tokens[constants::PQR_CHAIN_INDEX] << ':'
-                      << tokens[constants::PQR_RESNUM_INDEX] << ':'
-                      << tokens[constants::PQR_ATOMID_INDEX];
-      } break;
+        return fromFields_(chain, residue, atom);
+      }
       case constants::FileType::pdb:
       default:
         if (line.size() < constants::PDB_MIN_LINE_LENGTH) {
           throw cpet::value_error("pdb line too short: " +
                                   static_cast<std::string>(line));
         }
-        result_stream << line.substr(constants::PDB_CHAIN_START,
-                                     constants::PDB_CHAIN_WIDTH)
-                      << ':'
-                      << line.substr(constants::PDB_RESNUM_START,
-                                     constants::PDB_RESNUM_WIDTH)
-                      << ':'
-                      << line.substr(constants::PDB_ATOMID_START,
-                                     constants::PDB_ATOMID_WIDTH);
+        return fromFields_(
+            line.substr(constants::PDB_CHAIN_START, constants::PDB_CHAIN_WIDTH),
+            line.substr(constants::PDB_RESNUM_START,
+                        constants::PDB_RESNUM_WIDTH),
+            line.substr(constants::PDB_ATOMID_START,
+                        constants::PDB_ATOMID_WIDTH));
     };
-
-    auto result = result_stream.str();
-    result.erase(remove(begin(result), end(result), ' '), end(result));
-    return AtomID(result);
   }
 
   [[nodiscard]] inline std::optional<Eigen::Vector3d> position()
@@ -180,6 +186,39 @@ class AtomID {
   std::string id_;
   mutable std::optional<Eigen::Vector3d> position_;
 
+  struct Validated {};
+
+  /* For IDs already known to be valid */
+  inline AtomID(Validated /*unused*/, std::string id) noexcept
+      : id_(std::move(id)) {}
+
+  /* chain:residue:atom with blanks dropped. Checks the same things as
+   * validID without splitting the ID back apart. */
+  [[nodiscard]] static inline AtomID fromFields_(std::string_view chain,
+                                                 std::string_view residue,
+                                                 std::string_view atom) {
+    std::string id;
+    id.reserve(chain.size() + residue.size() + atom.size() + 2);
+    const auto append = [&id](std::string_view field) {
+      std::copy_if(field.begin(), field.end(), std::back_inserter(id),
+                   [](char c) { return c != ' '; });
+    };
+    append(chain);
+    id += ':';
+    append(residue);
+    id += ':';
+    append(atom);
+
+    const auto isField = [](std::string_view field) {
+      field = util::trim(field);
+      return !field.empty() && field.find(':') == std::string_view::npos;
+    };
+    if (!isField(chain) || !util::toDouble(residue) || !isField(atom)) {
+      throw cpet::value_error("Invalid atom ID: " + id);
+    }
+    return AtomID{Validated{}, std::move(id)};
+  }
+
   [[nodiscard]] static inline std::string decodeConstant_(Constants c) {
     switch (c) {
       case AtomID::Constants::origin:
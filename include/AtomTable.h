@@ -0,0 +1,65 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ATOMTABLE_H
+#define ATOMTABLE_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "AtomID.h"
+#include "Exceptions.h"
+
+namespace cpet {
+
+/* The AtomIDs of a topology, interned once. Atom i of a frame has the i-th
+ * ID, so coordinates carry no ID of their own. */
+class AtomTable {
+ public:
+  using index_type = uint32_t;
+
+  /* Appends the ID of the next atom and returns its index */
+  inline index_type push_back(AtomID id) {
+    if (atoms_.size() >= std::numeric_limits<index_type>::max()) {
+      throw cpet::value_error("Too many atoms in topology");
+    }
+    const auto index = static_cast<index_type>(atoms_.size());
+    /* Repeated IDs resolve to their first atom */
+    index_.try_emplace(id.ID(), index);
+    atoms_.emplace_back(std::move(id));
+    return index;
+  }
+
+  inline void reserve(size_t n) {
+    atoms_.reserve(n);
+    index_.reserve(n);
+  }
+
+  /* Index of the first atom with this ID in O(1) */
+  [[nodiscard]] inline std::optional<index_type> find(
+      const AtomID& id) const {
+    if (const auto iter = index_.find(id.ID()); iter != index_.end()) {
+      return iter->second;
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] inline const AtomID& operator[](size_t i) const noexcept {
+    return atoms_[i];
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return atoms_.size(); }
+
+ private:
+  std::vector<AtomID> atoms_;
+  std::unordered_map<std::string, index_type> index_;
+};
+}  // namespace cpet
+#endif  // ATOMTABLE_H
@@ -0,0 +1,142 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef BINARYCURSOR_H
+#define BINARYCURSOR_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet {
+namespace util {
+
+/* Reads fixed size numbers from a binary buffer, such as a memory mapped
+ * file, in a given byte order. Reading past the end throws cpet::io_error. */
+class BinaryCursor {
+ public:
+  enum class Endian { little, big };
+
+  explicit inline BinaryCursor(std::string_view data,
+                               Endian endian = Endian::big) noexcept
+      : data_(data), endian_(endian) {}
+
+  inline void endian(Endian endian) noexcept { endian_ = endian; }
+
+  [[nodiscard]] inline Endian endian() const noexcept { return endian_; }
+
+  [[nodiscard]] inline int32_t readInt32() {
+    return static_cast<int32_t>(readUnsigned_<uint32_t>());
+  }
+
+  [[nodiscard]] inline uint64_t readUInt64() {
+    return readUnsigned_<uint64_t>();
+  }
+
+  /* A 64 bit size or index; throws if it does not fit a size_t */
+  [[nodiscard]] inline size_t readSize() {
+    return toSize_(readUInt64());
+  }
+
+  [[nodiscard]] inline float readFloat() {
+    const auto bits = readUnsigned_<uint32_t>();
+    float result{0};
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+  [[nodiscard]] inline double readDouble() {
+    const auto bits = readUnsigned_<uint64_t>();
+    double result{0};
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+  /* The next count bytes, without copying */
+  [[nodiscard]] inline std::string_view readBytes(size_t count) {
+    require_(count);
+    const auto result = data_.substr(offset_, count);
+    offset_ += count;
+    return result;
+  }
+
+  /* A string prefixed by its 32 bit length */
+  [[nodiscard]] inline std::string_view readString() {
+    const auto length = readInt32();
+    if (length < 0) {
+      throw cpet::io_error("Negative string length in binary data");
+    }
+    return readBytes(static_cast<size_t>(length));
+  }
+
+  inline void skip(size_t count) {
+    require_(count);
+    offset_ += count;
+  }
+
+  inline void seek(size_t offset) {
+    if (offset > data_.size()) {
+      throw cpet::io_error("Seek past the end of binary data");
+    }
+    offset_ = offset;
+  }
+
+  [[nodiscard]] inline size_t offset() const noexcept { return offset_; }
+
+  [[nodiscard]] inline size_t remaining() const noexcept {
+    return data_.size() - offset_;
+  }
+
+  [[nodiscard]] inline bool atEnd() const noexcept {
+    return offset_ == data_.size();
+  }
+
+ private:
+  std::string_view data_;
+  size_t offset_{0};
+  Endian endian_;
+
+  inline void require_(size_t count) const {
+    if (count > remaining()) {
+      throw cpet::io_error("Unexpected end of binary data");
+    }
+  }
+
+  /* A template so that the narrowing branch is only compiled where size_t
+   * is 32 bits */
+  template <class Unsigned>
+  [[nodiscard]] static inline size_t toSize_(Unsigned value) {
+    if constexpr (sizeof(size_t) < sizeof(Unsigned)) {
+      if (value > SIZE_MAX) {
+        throw cpet::io_error("Size in binary data does not fit in memory");
+      }
+      return static_cast<size_t>(value);
+    } else {
+      return value;
+    }
+  }
+
+  template <class Unsigned>
+  [[nodiscard]] inline Unsigned readUnsigned_() {
+    require_(sizeof(Unsigned));
+    Unsigned result{0};
+    for (size_t i = 0; i < sizeof(Unsigned); i++) {
+      const auto byte = static_cast<unsigned char>(data_[offset_ + i]);
+      const size_t shift =
+          (endian_ == Endian::big) ? (sizeof(Unsigned) - 1 - i) * 8 : i * 8;
+      result |= static_cast<Unsigned>(static_cast<Unsigned>(byte) << shift);
+    }
+    offset_ += sizeof(Unsigned);
+    return result;
+  }
+};
+
+}  // namespace util
+}  // namespace cpet
+#endif  // BINARYCURSOR_H
@@ -0,0 +1,66 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef BINARYWRITER_H
+#define BINARYWRITER_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace cpet {
+namespace util {
+
+/* Appends fixed size numbers to a byte buffer in little-endian order, the
+ * counterpart of a little-endian BinaryCursor */
+class BinaryWriter {
+ public:
+  inline void writeInt32(int32_t value) {
+    writeUnsigned_(static_cast<uint32_t>(value));
+  }
+
+  inline void writeUInt64(uint64_t value) { writeUnsigned_(value); }
+
+  inline void writeFloat(float value) {
+    uint32_t bits{0};
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUnsigned_(bits);
+  }
+
+  inline void writeDouble(double value) {
+    uint64_t bits{0};
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUnsigned_(bits);
+  }
+
+  inline void writeBytes(std::string_view bytes) { buffer_.append(bytes); }
+
+  /* Length prefixed, read back by BinaryCursor::readString */
+  inline void writeString(std::string_view str) {
+    writeInt32(static_cast<int32_t>(str.size()));
+    writeBytes(str);
+  }
+
+  [[nodiscard]] inline const std::string& buffer() const noexcept {
+    return buffer_;
+  }
+
+  inline void clear() noexcept { buffer_.clear(); }
+
+ private:
+  std::string buffer_;
+
+  template <class Unsigned>
+  inline void writeUnsigned_(Unsigned value) {
+    for (size_t i = 0; i < sizeof(Unsigned); i++) {
+      buffer_.push_back(static_cast<char>((value >> (i * 8)) & 0xFFU));
+    }
+  }
+};
+
+}  // namespace util
+}  // namespace cpet
+#endif  // BINARYWRITER_H
@@ -5,10 +5,10 @@
 #define BOX_H
 
 /* C++ STL HEADER FILES */
-#include <random>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 
 /* EXTERNAL LIBRARY HEADER FILES */
@@ -17,10 +17,13 @@
 
 /* CPET HEADER FILES */
 #include "Exceptions.h"
+#include "Random.h"
 #include "Utilities.h"
 #include "Volume.h"
 namespace cpet {
-class Box : public Volume {
+/* Final, so calls through a Box& bind statically and inline into the
+ * streamline loops visitVolume instantiates for it */
+class Box final : public Volume {
  public:
   explicit inline Box(const std::array<double, 3>& sides) : sides_(sides) {
     constexpr auto is_less_than_zero = [](const double side) -> bool {
@@ -59,28 +62,28 @@ class Box : public Volume {
     return 2 * sqrt(diag);
   }
 
+  [[nodiscard]] inline double boundingRadius() const noexcept override {
+    return diagonal() / 2.0;
+  }
+
+  [[nodiscard]] inline Eigen::Vector3d halfExtents() const noexcept override {
+    return {sides_[0], sides_[1], sides_[2]};
+  }
+
   [[nodiscard]] inline bool isInside(
-      const Eigen::Vector3d& position) const override {
+      const Eigen::Vector3d& position) const noexcept override {
     const Eigen::Vector3d displaced = position - center_;
-    for (size_t i = 0; i < 3; i++) {
-      if (abs(displaced[static_cast<long>(i)]) >= sides_.at(i)) {
-        return false;
-      }
-    }
-    return true;
+    return std::abs(displaced[0]) < sides_[0] &&
+           std::abs(displaced[1]) < sides_[1] &&
+           std::abs(displaced[2]) < sides_[2];
   }
 
-  [[nodiscard]] inline Eigen::Vector3d randomPoint() const noexcept override {
-    std::array<std::uniform_real_distribution<double>, 3> distribution;
-    initializeDistributions_(distribution);
-    constexpr auto getRandomNumber =
-        [](std::uniform_real_distribution<double>& dis) -> double {
-      return dis(*(util::randomNumberGenerator()));
-    };
-
+  [[nodiscard]] inline Eigen::Vector3d randomPoint(
+      util::SampleRandom& random) const noexcept override {
     Eigen::Vector3d result;
-    std::transform(distribution.begin(), distribution.end(), result.begin(),
-                   getRandomNumber);
+    for (size_t i = 0; i < sides_.size(); i++) {
+      result[static_cast<long>(i)] = random.uniform(-sides_[i], sides_[i]);
+    }
     return result + center_;
   }
 
@@ -95,17 +98,15 @@ class Box : public Volume {
   }
 
   [[nodiscard]] inline int randomDistance(
-      double stepSize) const noexcept override {
-    std::uniform_int_distribution<int> distribution(
-        1, static_cast<int>(diagonal() / stepSize));
-    return distribution(*util::randomNumberGenerator());
+      double stepSize, util::SampleRandom& random) const noexcept override {
+    return random.uniformInt(1, static_cast<int>(diagonal() / stepSize));
   }
 
   [[nodiscard]] inline std::string type() const noexcept override {
     return "box";
   }
 
-  [[nodiscard]] inline std::vector<Eigen::Vector3d> partition(
+  [[nodiscard]] inline StructuredGrid grid(
       const std::array<int, 3>& density) const noexcept override {
     /* Prevents division by zero later */
     constexpr auto is_zero = [](const int dens) -> bool { return dens == 0.0; };
@@ -113,36 +114,29 @@ class Box : public Volume {
       return {};
     }
 
-    std::vector<Eigen::Vector3d> result;
-    result.reserve(
-        static_cast<size_t>(abs(density[0] * density[1] * density[2])));
-
-    double x = -1 * sides_[0];
-    while (x <= sides_[0]) {
-      double y = -1 * sides_[1];
-      while (y <= sides_[1]) {
-        double z = -1 * sides_[2];
-        while (z <= sides_[2]) {
-          result.emplace_back(x + center_[0], y + center_[1], z + center_[2]);
-          z += static_cast<double>(static_cast<float>(sides_[2] / density[2]));
-        }
-        y += (sides_[1] / density[1]);
+    /* Steps of sides / density from -side up to side. The z step is
+     * rounded to float as it always has been, and each axis keeps as many
+     * points as stepping there one step at a time reaches, so grids and
+     * their outputs are unchanged. */
+    StructuredGrid result;
+    for (size_t axis = 0; axis < 3; axis++) {
+      double step = sides_[axis] / density[axis];
+      if (axis == 2) {
+        step = static_cast<double>(static_cast<float>(step));
+      }
+      size_t count = 0;
+      for (double x = -sides_[axis]; x <= sides_[axis]; x += step) {
+        count++;
       }
-      x += (sides_[0] / density[0]);
+      const auto a = static_cast<long>(axis);
+      result.origin[a] = center_[a] - sides_[axis];
+      result.spacing[a] = step;
+      result.dims[axis] = count;
     }
     return result;
   }
 
  private:
-  inline void initializeDistributions_(
-      std::array<std::uniform_real_distribution<double>, 3>& distribution)
-      const noexcept {
-    for (size_t i = 0; i < distribution.size(); i++) {
-      distribution.at(i) = std::uniform_real_distribution<double>(
-          -1 * sides_.at(i), sides_.at(i));
-    }
-  }
-
   std::array<double, 3> sides_;
 };
 }  // namespace cpet
@@ -5,6 +5,7 @@
 #define CALCULATOR_H
 
 /* C++ STL HEADER FILES */
+#include <memory>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -13,63 +14,50 @@
 #include <Eigen/Dense>
 
 /* CPET HEADER FILES */
+#include "AsyncWriter.h"
+#include "Device.h"
+#include "FramePlan.h"
 #include "Option.h"
 #include "PointCharge.h"
 #include "System.h"
+#include "ThreadPool.h"
 #include "TopologyRegion.h"
 #include "Frame.h"
+#include "Topology.h"
+#include "TrajectoryReader.h"
 
 namespace cpet {
 
 class Calculator {
  public:
+  /* Each of chargesFiles gives the atoms of proteinFile one charge set.
+   * Fields are reported for every set; topology samples use the first. */
   Calculator(std::string proteinFile, const std::string& optionFile,
-             std::string chargesFile = "", int nThreads = 1);
+             std::vector<std::string> chargesFiles = {}, int nThreads = 1,
+             Device device = Device{});
 
   void compute();
 
  private:
   std::string proteinFile_;
   Option option_;
-  std::string chargeFile_;
-  int numberOfThreads_;
-  std::vector<Frame> frameTrajectory_;
-  std::vector<System> systems_;
-
-  void fixCharges_();
-
-  void computeTopology_() const;
-
-  void computeEField_() const;
-
-  void computeVolume_() const;
-
-  inline void loadPointChargeTrajectory_() {
-    frameTrajectory_ =
-        Frame::loadFramesFromFile(proteinFile_, option_.coordinatesStartIndex(),
-                                  option_.coordinatesStepSize());
-  }
-
-  inline void createSystems_() {
-    if (!systems_.empty()) {
-      systems_.clear();
-    }
-
-    const auto make_system = [this](const Frame& frame) -> System {
-      return System{frame, this->option_};
-    };
-
-    systems_.reserve(frameTrajectory_.size());
-    std::transform(frameTrajectory_.begin(), frameTrajectory_.end(),
-                   std::back_inserter(systems_), make_system);
-  }
-
-  inline void transformSystems_() {
-    std::for_each(systems_.begin(), systems_.end(),
-                  [](auto& system) { system.transformToUserSpace(); });
-  }
-
-  [[nodiscard]] std::vector<double> loadChargesFile_() const;
+  std::vector<std::string> chargeFiles_;
+  Device device_;
+  /* Builds each frame's data once for every block */
+  FramePlan plan_;
+  /* Shared by every compute stage for the lifetime of the calculation */
+  mutable util::ThreadPool pool_;
+  /* Writes per-frame results in the background; declared after option_ so
+   * it finishes before the blocks its jobs use are destroyed */
+  util::AsyncWriter writer_;
+
+  /* IDs and charges of the first structure in the first charges file, with
+   * the charges of the same structure in every file as its charge sets */
+  [[nodiscard]] std::shared_ptr<const Topology> loadChargesFiles_() const;
+
+  /* The trajectory, charges and frames topology samples are drawn from,
+   * for checkpoint keys */
+  [[nodiscard]] std::string checkpointInput_() const;
 };
 }  // namespace cpet
 #endif  // CALCULATOR_H
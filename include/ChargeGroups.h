@@ -0,0 +1,106 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef CHARGEGROUPS_H
+#define CHARGEGROUPS_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "Topology.h"
+#include "Utilities.h"
+
+namespace cpet {
+
+/* The charged atoms of a topology grouped by residue or chain, in order of
+ * their first atom, so a field can be split into the contribution of every
+ * group in one sweep over the charges */
+class ChargeGroups {
+ public:
+  enum class Key { residue, chain };
+
+  using index_type = Topology::index_type;
+
+  inline ChargeGroups(const Topology& topology, const Key key) {
+    std::unordered_map<std::string, size_t> groupOf;
+    std::vector<size_t> groups;
+    groups.reserve(topology.chargedAtoms().size());
+    for (const auto atom : topology.chargedAtoms()) {
+      auto name = nameOf_(topology.atoms()[atom].ID(), key);
+      const auto [iter, added] = groupOf.try_emplace(name, names_.size());
+      if (added) {
+        names_.push_back(std::move(name));
+      }
+      groups.push_back(iter->second);
+    }
+
+    /* Counting sort of the charged atoms by group, keeping file order
+     * within each group */
+    offsets_.assign(names_.size() + 1, 0);
+    for (const auto group : groups) {
+      offsets_[group + 1]++;
+    }
+    for (size_t group = 0; group < names_.size(); group++) {
+      offsets_[group + 1] += offsets_[group];
+    }
+    atoms_.resize(groups.size());
+    auto next = offsets_;
+    for (size_t i = 0; i < groups.size(); i++) {
+      atoms_[next[groups[i]]++] = topology.chargedAtoms()[i];
+    }
+  }
+
+  /* Parses "residue" or "chain" */
+  [[nodiscard]] static inline Key keyFromString(const std::string& name) {
+    const auto lower = util::tolower(name);
+    if (lower == "residue") {
+      return Key::residue;
+    }
+    if (lower == "chain") {
+      return Key::chain;
+    }
+    throw cpet::invalid_option("Invalid Option: Unknown decomposition " +
+                               name + ", expected residue or chain");
+  }
+
+  [[nodiscard]] static inline std::string name(const Key key) {
+    return key == Key::residue ? "residue" : "chain";
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return names_.size(); }
+
+  /* chain:residue or chain */
+  [[nodiscard]] inline const std::vector<std::string>& names() const noexcept {
+    return names_;
+  }
+
+  /* Charged atoms ordered by group; those of group g are
+   * [offsets()[g], offsets()[g + 1]) */
+  [[nodiscard]] inline const std::vector<index_type>& atoms() const noexcept {
+    return atoms_;
+  }
+
+  [[nodiscard]] inline const std::vector<size_t>& offsets() const noexcept {
+    return offsets_;
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::vector<index_type> atoms_;
+  std::vector<size_t> offsets_{0};
+
+  /* IDs are chain:residue:atom */
+  [[nodiscard]] static inline std::string nameOf_(std::string_view id,
+                                                  const Key key) {
+    const auto end = (key == Key::residue) ? id.rfind(':') : id.find(':');
+    return std::string{id.substr(0, end)};
+  }
+};
+}  // namespace cpet
+#endif  // CHARGEGROUPS_H
@@ -0,0 +1,85 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cpet::util {
+
+/* The processes of an MPI run, or just this one in builds without MPI
+ * (CPET_USE_MPI). Every rank runs the whole calculation and splits the
+ * topology samples of each frame with share(). Every method that talks to
+ * the other ranks must be called by all of them, in the same order. */
+class Cluster {
+ public:
+  /* Starts MPI for its lifetime; only one may exist, in main */
+  class Session {
+   public:
+    Session(int& argc, char**& argv);
+
+    Session(const Session&) = delete;
+
+    Session& operator=(const Session&) = delete;
+
+    ~Session();
+  };
+
+  [[nodiscard]] static const Cluster& instance() noexcept;
+
+  [[nodiscard]] inline int rank() const noexcept { return rank_; }
+
+  [[nodiscard]] inline int size() const noexcept { return size_; }
+
+  [[nodiscard]] inline bool root() const noexcept { return rank_ == 0; }
+
+  /* The items [begin, end) of count that this rank works on. Ranks get
+   * consecutive parts, in rank order, that differ by at most one item. */
+  [[nodiscard]] inline std::pair<size_t, size_t> share(
+      const size_t count) const noexcept {
+    const auto ranks = static_cast<size_t>(size_);
+    const auto self = static_cast<size_t>(rank_);
+    const size_t base = count / ranks;
+    const size_t extra = count % ranks;
+    const size_t begin = self * base + std::min(self, extra);
+    return {begin, begin + base + (self < extra ? 1 : 0)};
+  }
+
+  /* Sums values element-wise over every rank into those of the root */
+  void sumToRoot(std::vector<int64_t>& values) const;
+
+  /* Sum of value over every rank, on every rank */
+  [[nodiscard]] uint64_t sum(uint64_t value) const;
+
+  /* Smallest min and largest max over every rank, on every rank */
+  void extremes(double& min, double& max) const;
+
+  /* Ends every rank of the run with code; for errors that only some ranks
+   * hit, as the others would wait for them in a collective call forever.
+   * Does nothing in builds without MPI. */
+  void abort(int code) const;
+
+  /* Writes the root's header and then the data of every rank, in rank
+   * order, to file, the ranks writing their parts at once */
+  void writeOrdered(const std::string& file, std::string_view header,
+                    std::string_view data) const;
+
+ private:
+  Cluster() = default;
+
+  int rank_{0};
+  int size_{1};
+
+  static Cluster& mutableInstance_() noexcept;
+};
+
+}  // namespace cpet::util
+#endif  // CLUSTER_H
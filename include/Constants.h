@@ -28,6 +28,10 @@ constexpr int PQR_RESNUM_INDEX = 5;
 constexpr int PQR_ATOMID_INDEX = 2;
 constexpr int PQR_MIN_INDEX = PQR_RESNUM_INDEX;
 
+constexpr double PI = 3.14159265358979323846;
+constexpr double PERM_SPACE = 0.0055263495;
+constexpr double TO_V_PER_ANG = (1.0 / (4.0 * PI * PERM_SPACE));
+
 enum class FileType { pdb, pqr };
 
 }  // namespace cpet::constants
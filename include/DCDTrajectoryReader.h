@@ -0,0 +1,59 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef DCDTRAJECTORYREADER_H
+#define DCDTRAJECTORYREADER_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "BinaryCursor.h"
+#include "Frame.h"
+#include "MappedFile.h"
+#include "Topology.h"
+#include "TrajectoryReader.h"
+
+namespace cpet {
+
+/* CHARMM/NAMD DCD trajectory, in either byte order, with coordinates in
+ * Angstrom. Every frame has the same size, so selected frames are read at
+ * their offset and skipped frames are never touched. Fixed atoms and 4D
+ * coordinates are not supported. */
+class DCDTrajectoryReader : public TrajectoryReader {
+ public:
+  DCDTrajectoryReader(const std::string& file,
+                      std::shared_ptr<const Topology> topology, int start,
+                      int step);
+
+  [[nodiscard]] std::optional<Frame> next() override;
+
+  /* Frames in the file, counted from its size rather than the header */
+  [[nodiscard]] inline size_t numberOfFrames() const noexcept {
+    return numberOfFrames_;
+  }
+
+ private:
+  util::MappedFile file_;
+  util::BinaryCursor cursor_;
+  size_t numberOfAtoms_{0};
+  bool hasUnitCell_{false};
+  size_t firstFrameOffset_{0};
+  size_t frameSize_{0};
+  size_t numberOfFrames_{0};
+  size_t nextFrame_{0};
+
+  void readHeader_(const std::string& file);
+
+  /* Reads one of the X, Y or Z records of a frame into coordinates */
+  void readAxis_(std::vector<Eigen::Vector3d>& coordinates, size_t axis);
+};
+}  // namespace cpet
+#endif  // DCDTRAJECTORYREADER_H
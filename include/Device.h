@@ -0,0 +1,41 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+/* C++ STL HEADER FILES */
+#include <string>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "Utilities.h"
+
+namespace cpet {
+
+/* Where the fields and streamlines of a run are computed */
+struct Device {
+  enum class Type { cpu, gpu };
+
+  Type type{Type::cpu};
+
+  [[nodiscard]] inline bool gpu() const noexcept { return type == Type::gpu; }
+
+  [[nodiscard]] inline std::string description() const {
+    return gpu() ? "gpu" : "cpu";
+  }
+
+  /* Parses the value of --device, "cpu" or "gpu" */
+  [[nodiscard]] static inline Device fromString(const std::string& name) {
+    const auto lower = util::tolower(name);
+    if (lower == "cpu") {
+      return {Type::cpu};
+    }
+    if (lower == "gpu") {
+      return {Type::gpu};
+    }
+    throw cpet::invalid_option("Invalid Option: Unknown device " + name);
+  }
+};
+}  // namespace cpet
+#endif  // DEVICE_H
@@ -0,0 +1,84 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Histogram2D.h"
+#include "ThreadPool.h"
+
+namespace cpet::histo {
+
+/* Symmetric matrix of distances with a zero diagonal. Only the upper
+ * triangle is stored, packed column after column: (0, 1), (0, 2), (1, 2),
+ * (0, 3), ..., so adding frames appends their columns and leaves the
+ * distances among the earlier frames where they are. */
+class DistanceMatrix {
+ public:
+  explicit inline DistanceMatrix(const size_t size)
+      : size_(size), packed_(entries_(size), 0.0) {}
+
+  [[nodiscard]] inline size_t size() const noexcept { return size_; }
+
+  [[nodiscard]] inline double operator()(size_t i, size_t j) const noexcept {
+    if (i == j) {
+      return 0.0;
+    }
+    if (i > j) {
+      std::swap(i, j);
+    }
+    return packed_[index_(i, j)];
+  }
+
+  /* Entry (i, j) of the upper triangle, i < j */
+  [[nodiscard]] inline double& upper(const size_t i, const size_t j) noexcept {
+    return packed_[index_(i, j)];
+  }
+
+  [[nodiscard]] inline const std::vector<double>& packed() const noexcept {
+    return packed_;
+  }
+
+  /* Grows to size frames; the distances to the new ones start at zero */
+  inline void grow(const size_t size) {
+    if (size > size_) {
+      size_ = size;
+      packed_.resize(entries_(size), 0.0);
+    }
+  }
+
+ private:
+  size_t size_;
+  std::vector<double> packed_;
+
+  [[nodiscard]] static inline size_t entries_(const size_t size) noexcept {
+    return size > 1 ? size * (size - 1) / 2 : 0;
+  }
+
+  [[nodiscard]] static inline size_t index_(const size_t i,
+                                            const size_t j) noexcept {
+    return entries_(j) + i;
+  }
+};
+
+/* chiDistance between every pair of rows of histograms. Only the upper
+ * triangle is computed, in tiles of rows that are compared a block of bins
+ * at a time so the block stays in cache; tiles run in parallel on pool. */
+[[nodiscard]] DistanceMatrix chiDistanceMatrix(
+    const HistogramMatrix& histograms, util::ThreadPool& pool);
+
+/* Grows matrix, which holds the distances between the first matrix.size()
+ * rows of histograms, to all of them. Only the distances to the new rows
+ * are computed, with the same tiles, so the result equals
+ * chiDistanceMatrix(histograms, pool). */
+void extendChiDistanceMatrix(const HistogramMatrix& histograms,
+                             DistanceMatrix& matrix, util::ThreadPool& pool);
+
+}  // namespace cpet::histo
+#endif  // DISTANCEMATRIX_H
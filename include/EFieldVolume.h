@@ -18,6 +18,11 @@
 #include <Eigen/Dense>
 
 /* CPET HEADER FILES */
+#include "AsyncWriter.h"
+#include "FieldSolver.h"
+#include "OutputFormat.h"
+#include "StructuredGrid.h"
+#include "ThreadPool.h"
 #include "Volume.h"
 
 namespace cpet {
@@ -33,7 +38,7 @@ class EFieldVolume {
         sampleDensity_(density),
         showPlot_(plot),
         output_(std::move(output)) {
-    points_ = volume_->partition(sampleDensity_);
+    grid_ = volume_->grid(sampleDensity_);
   }
 
   [[nodiscard]] inline std::string name() const {
@@ -67,13 +72,29 @@ class EFieldVolume {
     return sampleDensity_;
   }
 
-  [[nodiscard]] constexpr const std::vector<Eigen::Vector3d>& points()
-      const noexcept {
-    return points_;
+  /* The points the field is computed at */
+  [[nodiscard]] constexpr const StructuredGrid& grid() const noexcept {
+    return grid_;
   }
 
   [[nodiscard]] constexpr bool showPlot() const noexcept { return showPlot_; }
 
+  [[nodiscard]] constexpr const FieldSolver& solver() const noexcept {
+    return solver_;
+  }
+
+  inline void solver(const FieldSolver& fieldSolver) noexcept {
+    solver_ = fieldSolver;
+  }
+
+  [[nodiscard]] constexpr const OutputFormat& outputFormat() const noexcept {
+    return outputFormat_;
+  }
+
+  inline void outputFormat(const OutputFormat& format) noexcept {
+    outputFormat_ = format;
+  }
+
   [[nodiscard]] constexpr const std::optional<std::string>& output()
       const noexcept {
     return output_;
@@ -92,20 +113,39 @@ class EFieldVolume {
   [[nodiscard]] static EFieldVolume fromBlock(
       const std::vector<std::string>& options);
 
-  void computeVolumeWith(const std::vector<System>& systems) const;
+  /* Computes and plots a window of consecutive frames and queues their
+   * output on writer. firstFrame is the trajectory index of systems[0]; the
+   * output file is started over when it is 0 and appended to otherwise. */
+  void computeVolumeWith(const std::vector<System>& systems,
+                         util::ThreadPool& pool, util::AsyncWriter& writer,
+                         size_t firstFrame = 0) const;
 
  private:
   std::unique_ptr<Volume> volume_;
   std::array<int, 3> sampleDensity_;
-  std::vector<Eigen::Vector3d> points_;
+  StructuredGrid grid_;
   bool showPlot_{false};
   std::optional<std::string> output_{std::nullopt};
+  FieldSolver solver_{};
+  OutputFormat outputFormat_{};
+
+  /* What the output needs of a frame once its System is gone */
+  struct FrameField {
+    Eigen::Vector3d center;
+    Eigen::Matrix3d basis;
+    std::vector<Eigen::Vector3d> field;
+  };
 
   void plot_(const std::vector<Eigen::Vector3d>& electricField) const;
 
-  void writeOutput_(
-      const std::vector<System>& systems,
-      const std::vector<std::vector<Eigen::Vector3d>>& results) const;
+  void writeOutput_(const std::vector<FrameField>& frames,
+                    size_t firstFrame) const;
+
+  /* The grid once, as its origin, spacing and dimensions, and the number
+   * of charge sets K, then per frame its center, basis and field array (3K
+   * values per point, sets innermost) */
+  void writeBinaryOutput_(const std::vector<FrameField>& frames,
+                          size_t firstFrame) const;
 };
 }  // namespace cpet
 #endif  // EFIELDVOLUME_H
@@ -0,0 +1,134 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ELECTRICFIELD_H
+#define ELECTRICFIELD_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "PointChargeStore.h"
+
+namespace cpet::field {
+
+enum class KernelISA { scalar, avx2, avx512 };
+
+/* Best instruction set supported by the running CPU. Determined once. */
+[[nodiscard]] KernelISA detectKernelISA() noexcept;
+
+[[nodiscard]] bool isSupported(KernelISA isa) noexcept;
+
+[[nodiscard]] std::string name(KernelISA isa);
+
+/* Coulomb field (V/Ang) at position from every charge in the store, using the
+ * kernel selected by detectKernelISA() */
+[[nodiscard]] Eigen::Vector3d electricFieldAt(
+    const PointChargeStore& charges, const Eigen::Vector3d& position) noexcept;
+
+/* Same as above with an explicit kernel; falls back to the scalar kernel if
+ * the requested one is not supported on this CPU. */
+[[nodiscard]] Eigen::Vector3d electricFieldAt(const PointChargeStore& charges,
+                                              const Eigen::Vector3d& position,
+                                              KernelISA isa) noexcept;
+
+/* The field (V/Ang) at a point and its Jacobian (V/Ang^2),
+ * gradient(i, j) = dE_i / dx_j */
+struct FieldGradient {
+  Eigen::Vector3d field;
+  Eigen::Matrix3d gradient;
+};
+
+/* Field and Jacobian at position, summed in one pass over the charges */
+[[nodiscard]] FieldGradient fieldGradientAt(
+    const PointChargeStore& charges, const Eigen::Vector3d& position) noexcept;
+
+/* Same as above with an explicit kernel, falling back to the scalar one if
+ * the requested one is not supported on this CPU */
+[[nodiscard]] FieldGradient fieldGradientAt(const PointChargeStore& charges,
+                                            const Eigen::Vector3d& position,
+                                            KernelISA isa) noexcept;
+
+/* Curvature (1/Ang) of the field line through a point,
+ * |E x (grad E . E)| / |E|^3 */
+[[nodiscard]] inline double curvature(const FieldGradient& value) noexcept {
+  const double norm = value.field.norm();
+  return value.field.cross(value.gradient * value.field).norm() /
+         (norm * norm * norm);
+}
+
+/* Adds the field from charges [begin, end) at position to raw, without the
+ * constants::TO_V_PER_ANG prefactor. Building block for solvers that only
+ * sum part of the store directly. */
+void accumulateRange(const PointChargeStore& charges, size_t begin, size_t end,
+                     const Eigen::Vector3d& position,
+                     Eigen::Vector3d& raw) noexcept;
+
+/* Number of charges per block in the batched kernel; the four coordinate and
+ * charge arrays of one block (32 KiB) stay resident in L1/L2 while every point
+ * of a tile is evaluated against it. */
+constexpr size_t CHARGE_BLOCK_SIZE = 1024;
+
+/* Number of points evaluated against one charge block before moving on */
+constexpr size_t POINT_TILE_SIZE = 64;
+
+/* Batched evaluation: results[i] is the field at positions[i]. Points are
+ * tiled against blocks of charges so the charge arrays are streamed through
+ * cache once per tile instead of once per point. */
+void electricFieldAt(const PointChargeStore& charges,
+                     const Eigen::Vector3d* positions, size_t count,
+                     Eigen::Vector3d* results) noexcept;
+
+/* Fields of every charge set of a store at count positions:
+ * results[i * charges.sets() + set] is the field of that set at
+ * positions[i]. The geometry of each charge is computed once per point and
+ * applied to up to four sets at a time, so several sets cost far less than
+ * as many stores. */
+void electricFieldsAt(const ChargeSetStore& charges,
+                      const Eigen::Vector3d* positions, size_t count,
+                      Eigen::Vector3d* results) noexcept;
+
+/* Same as above with an explicit kernel, falling back to the scalar one if
+ * the requested one is not supported on this CPU */
+void electricFieldsAt(const ChargeSetStore& charges,
+                      const Eigen::Vector3d* positions, size_t count,
+                      Eigen::Vector3d* results, KernelISA isa) noexcept;
+
+/* Fields of consecutive groups of charges at count positions: group g is
+ * charges [offsets[g], offsets[g + 1]) of the store and
+ * results[i * groups + g] is its field at positions[i], with groups =
+ * offsets.size() - 1. Each group is evaluated at every position while its
+ * charges are in cache, so the whole split costs one pass over the store
+ * per position, like a single field. */
+void groupFieldsAt(const PointChargeStore& charges,
+                   const std::vector<size_t>& offsets,
+                   const Eigen::Vector3d* positions, size_t count,
+                   Eigen::Vector3d* results) noexcept;
+
+/* Number of points of a packet, evaluated together in one pass over the
+ * charges */
+constexpr size_t PACKET_SIZE = 16;
+
+using PointPacket = std::array<Eigen::Vector3d, PACKET_SIZE>;
+
+/* Packet evaluation: fields[i] is the field at positions[i]. The points sit
+ * in the SIMD lanes and every charge is loaded once for all of them. The
+ * field at a point does not depend on the other points of the packet. */
+void electricFieldAt(const PointChargeStore& charges,
+                     const PointPacket& positions,
+                     PointPacket& fields) noexcept;
+
+/* Same as above with an explicit kernel, falling back to the scalar one if
+ * the requested one is not supported on this CPU */
+void electricFieldAt(const PointChargeStore& charges,
+                     const PointPacket& positions, PointPacket& fields,
+                     KernelISA isa) noexcept;
+
+}  // namespace cpet::field
+#endif  // ELECTRICFIELD_H
@@ -0,0 +1,56 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FARFIELDEXPANSION_H
+#define FARFIELDEXPANSION_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "PointChargeStore.h"
+
+namespace cpet {
+
+/* Splits the charges of a frame into those within cutoff of center, which
+ * are summed exactly, and the rest, which are collapsed into a Taylor
+ * expansion of their field about center through the octupole term of the
+ * potential (field, field gradient and field Hessian). For evaluation points
+ * within r of center the truncation error of a far charge at distance d
+ * scales as (r / d)^3. */
+class FarFieldExpansion {
+ public:
+  FarFieldExpansion() = default;
+
+  FarFieldExpansion(const PointChargeStore& charges,
+                    const Eigen::Vector3d& center, double cutoff);
+
+  [[nodiscard]] Eigen::Vector3d electricFieldAt(
+      const Eigen::Vector3d& position) const noexcept;
+
+  [[nodiscard]] inline size_t numberOfNearCharges() const noexcept {
+    return near_.size();
+  }
+
+  [[nodiscard]] inline size_t numberOfFarCharges() const noexcept {
+    return numberOfFarCharges_;
+  }
+
+ private:
+  Eigen::Vector3d center_{0, 0, 0};
+  PointChargeStore near_;
+  size_t numberOfFarCharges_{0};
+
+  /* Unscaled far-field E, dE_a/dx_b and d2E_a/dx_b dx_c at center_ */
+  Eigen::Vector3d field_{0, 0, 0};
+  Eigen::Matrix3d gradient_{Eigen::Matrix3d::Zero()};
+  std::array<Eigen::Matrix3d, 3> hessian_{Eigen::Matrix3d::Zero(),
+                                          Eigen::Matrix3d::Zero(),
+                                          Eigen::Matrix3d::Zero()};
+};
+}  // namespace cpet
+#endif  // FARFIELDEXPANSION_H
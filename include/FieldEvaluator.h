@@ -0,0 +1,101 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FIELDEVALUATOR_H
+#define FIELDEVALUATOR_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "ElectricField.h"
+#include "FarFieldExpansion.h"
+#include "FieldGrid.h"
+#include "Octree.h"
+#include "PointChargeStore.h"
+
+namespace cpet {
+
+/* A FieldSolver resolved against one System (and, for solvers that need it,
+ * one sampling region). Cheap to copy except for the far-field variant; safe
+ * to share between threads. Must not outlive the System it came from. */
+class FieldEvaluator {
+ public:
+  explicit inline FieldEvaluator(const PointChargeStore& charges) noexcept
+      : mode_(Mode::direct), charges_(&charges) {}
+
+  inline FieldEvaluator(const Octree& tree, double theta) noexcept
+      : mode_(Mode::octree), tree_(&tree), theta_(theta) {}
+
+  explicit inline FieldEvaluator(FarFieldExpansion expansion) noexcept
+      : mode_(Mode::farfield), expansion_(std::move(expansion)) {}
+
+  explicit inline FieldEvaluator(
+      std::shared_ptr<const FieldGrid> grid) noexcept
+      : mode_(Mode::grid), grid_(std::move(grid)) {}
+
+  [[nodiscard]] inline Eigen::Vector3d operator()(
+      const Eigen::Vector3d& position) const noexcept {
+    switch (mode_) {
+      case Mode::octree:
+        return tree_->electricFieldAt(position, theta_);
+      case Mode::farfield:
+        return expansion_.electricFieldAt(position);
+      case Mode::grid:
+        return grid_->electricFieldAt(position);
+      case Mode::direct:
+      default:
+        return field::electricFieldAt(*charges_, position);
+    }
+  }
+
+  /* Field and Jacobian at position. The direct sum evaluates both in one
+   * pass over the charges; the approximate solvers differentiate their own
+   * field by central differences. */
+  [[nodiscard]] inline field::FieldGradient gradientAt(
+      const Eigen::Vector3d& position) const noexcept {
+    if (mode_ == Mode::direct) {
+      return field::fieldGradientAt(*charges_, position);
+    }
+    constexpr double STEP = 1e-4;
+    field::FieldGradient result{(*this)(position), Eigen::Matrix3d::Zero()};
+    for (Eigen::Index axis = 0; axis < 3; ++axis) {
+      const Eigen::Vector3d offset = STEP * Eigen::Vector3d::Unit(axis);
+      result.gradient.col(axis) =
+          ((*this)(position + offset) - (*this)(position - offset)) /
+          (2.0 * STEP);
+    }
+    return result;
+  }
+
+  /* fields[i] is the field at positions[i]. The direct sum evaluates the
+   * whole packet in one pass over the charges; the other solvers walk their
+   * structures point by point. */
+  inline void operator()(const field::PointPacket& positions,
+                         field::PointPacket& fields) const noexcept {
+    if (mode_ == Mode::direct) {
+      field::electricFieldAt(*charges_, positions, fields);
+      return;
+    }
+    for (size_t i = 0; i < field::PACKET_SIZE; ++i) {
+      fields[i] = (*this)(positions[i]);
+    }
+  }
+
+ private:
+  enum class Mode { direct, octree, farfield, grid };
+
+  Mode mode_;
+  const PointChargeStore* charges_{nullptr};
+  const Octree* tree_{nullptr};
+  double theta_{0.0};
+  FarFieldExpansion expansion_{};
+  std::shared_ptr<const FieldGrid> grid_{nullptr};
+};
+}  // namespace cpet
+#endif  // FIELDEVALUATOR_H
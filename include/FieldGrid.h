@@ -0,0 +1,151 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FIELDGRID_H
+#define FIELDGRID_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "Utilities.h"
+
+namespace cpet {
+
+constexpr double DEFAULT_GRID_SPACING = 0.1;
+
+/* Whether a topology block wants the field precomputed on a lattice and
+ * interpolated instead of being summed at every streamline step */
+struct GridInterpolation {
+  enum class Type { none, trilinear, tricubic };
+
+  Type type{Type::none};
+
+  /* Lattice spacing (Ang). Trilinear error scales as spacing^2, tricubic as
+   * spacing^4. */
+  double spacing{DEFAULT_GRID_SPACING};
+
+  [[nodiscard]] constexpr bool enabled() const noexcept {
+    return type != Type::none;
+  }
+
+  [[nodiscard]] inline std::string description() const {
+    switch (type) {
+      case Type::trilinear:
+        return "trilinear " + std::to_string(spacing);
+      case Type::tricubic:
+        return "tricubic " + std::to_string(spacing);
+      case Type::none:
+      default:
+        return "none";
+    }
+  }
+
+  /* Parses the options following an "interpolate" key, e.g. "tricubic 0.05"
+   */
+  [[nodiscard]] static inline GridInterpolation fromOptions(
+      const std::vector<std::string>& options) {
+    if (options.empty()) {
+      throw cpet::invalid_option(
+          "Invalid Option: interpolate requires a type");
+    }
+    GridInterpolation result;
+    const auto type = util::tolower(options[0]);
+    if (type == "none") {
+      result.type = Type::none;
+    } else if (type == "trilinear") {
+      result.type = Type::trilinear;
+    } else if (type == "tricubic") {
+      result.type = Type::tricubic;
+    } else {
+      throw cpet::invalid_option("Invalid Option: Unknown interpolation " +
+                                 options[0]);
+    }
+    if (options.size() > 1) {
+      if (!util::isDouble(options[1])) {
+        throw cpet::invalid_option(
+            "Invalid Option: interpolation spacing should be numeric");
+      }
+      result.spacing = std::stod(options[1]);
+      if (result.spacing <= 0.0) {
+        throw cpet::invalid_option(
+            "Invalid Option: interpolation spacing should be > 0");
+      }
+    }
+    return result;
+  }
+};
+
+/* Electric field tabulated on a regular lattice spanning [lower, upper].
+ * The lattice is built in two steps so the caller can evaluate all nodes in
+ * one batched call: construct, evaluate nodes(), hand the result to values().
+ * Positions outside the lattice are extrapolated from the nearest cell, so
+ * the lattice should be padded to cover everywhere it will be queried. */
+class FieldGrid {
+ public:
+  /* Fewest nodes per axis; the tricubic stencil is 4 wide */
+  static constexpr int MIN_NODES = 4;
+
+  FieldGrid(const Eigen::Vector3d& lower, const Eigen::Vector3d& upper,
+            double spacing, GridInterpolation::Type type);
+
+  /* Lattice positions, x-major, in the order values() expects */
+  [[nodiscard]] std::vector<Eigen::Vector3d> nodes() const;
+
+  void values(std::vector<Eigen::Vector3d> fields);
+
+  /* Up to maxProbes cell centers, where interpolation error is largest */
+  [[nodiscard]] std::vector<Eigen::Vector3d> probes(size_t maxProbes) const;
+
+  /* Largest |interpolated - exact| / |exact| over the probes. Recorded as
+   * errorEstimate(). */
+  double estimateError(const std::vector<Eigen::Vector3d>& probes,
+                       const std::vector<Eigen::Vector3d>& exact);
+
+  /* Outside the grid, the field at the nearest point of it; NaN if
+   * position is not finite */
+  [[nodiscard]] Eigen::Vector3d electricFieldAt(
+      const Eigen::Vector3d& position) const noexcept;
+
+  [[nodiscard]] inline size_t size() const noexcept {
+    return static_cast<size_t>(dims_.prod());
+  }
+
+  [[nodiscard]] inline const Eigen::Array3i& dimensions() const noexcept {
+    return dims_;
+  }
+
+  [[nodiscard]] constexpr double errorEstimate() const noexcept {
+    return errorEstimate_;
+  }
+
+ private:
+  Eigen::Vector3d lower_;
+  Eigen::Array3d spacing_;
+  Eigen::Array3i dims_;
+  GridInterpolation::Type type_;
+  std::vector<Eigen::Vector3d> values_;
+  double errorEstimate_{0.0};
+
+  [[nodiscard]] inline size_t index_(int i, int j, int k) const noexcept {
+    return (static_cast<size_t>(i) * static_cast<size_t>(dims_[1]) +
+            static_cast<size_t>(j)) *
+               static_cast<size_t>(dims_[2]) +
+           static_cast<size_t>(k);
+  }
+
+  [[nodiscard]] Eigen::Vector3d trilinear_(
+      const Eigen::Vector3d& position) const noexcept;
+
+  [[nodiscard]] Eigen::Vector3d tricubic_(
+      const Eigen::Vector3d& position) const noexcept;
+};
+}  // namespace cpet
+#endif  // FIELDGRID_H
@@ -12,10 +12,13 @@
 #include <utility>
 
 /* CPET HEADER FILES */
+#include "AsyncWriter.h"
 #include "AtomID.h"
+#include "ChargeGroups.h"
 #include "Exceptions.h"
 #include "Utilities.h"
 #include "PointCharge.h"
+#include "ThreadPool.h"
 
 namespace cpet {
 
@@ -50,7 +53,24 @@ constexpr PlotStyles& operator|=(PlotStyles& lhs, const PlotStyles rhs) {
 
 class FieldLocations {
  public:
-  void computeEFieldsWith(const std::vector<System>& systems) const;
+  /* Fields at every location for a window of frames, as
+   * results[location][frame * sets + set] with one entry per charge set of
+   * the systems */
+  [[nodiscard]] std::vector<std::vector<Eigen::Vector3d>> computeEFieldsWith(
+      const std::vector<System>& systems, util::ThreadPool& pool) const;
+
+  /* With a decompose line, splits the field at every location of each
+   * frame into the contribution of each residue or chain (first charge
+   * set) and queues the table of the window for writing. firstFrame is the
+   * trajectory index of systems.front(). */
+  void decomposeWith(const std::vector<System>& systems,
+                     util::ThreadPool& pool, util::AsyncWriter& writer,
+                     size_t firstFrame) const;
+
+  /* Logs, writes and plots the fields of the whole trajectory, computed
+   * with chargeSets charge sets */
+  void report(const std::vector<std::vector<Eigen::Vector3d>>& results,
+              size_t chargeSets = 1) const;
 
   [[nodiscard]] constexpr const std::vector<AtomID>& locations()
       const noexcept {
@@ -76,6 +96,11 @@ class FieldLocations {
     }
   }
 
+  [[nodiscard]] inline const std::optional<ChargeGroups::Key>& decompose()
+      const noexcept {
+    return decompose_;
+  }
+
   [[nodiscard]] bool showPlots() const noexcept {
     // Check if user specified any plots
     return util::countSetBits(static_cast<unsigned int>(plotStyle_)) != 0;
@@ -91,6 +116,8 @@ class FieldLocations {
   std::vector<AtomID> locations_;
   PlotStyles plotStyle_{0};
   std::optional<std::string> output_{std::nullopt};
+  std::optional<ChargeGroups::Key> decompose_{std::nullopt};
+  std::string decompositionOutput_;
 
   [[nodiscard]] inline static PlotStyles decodePlotStyle_(
       const std::vector<std::string>& tokens) {
@@ -126,8 +153,17 @@ class FieldLocations {
     return ((plotStyle_ & PlotStyles::m) == PlotStyles::m);
   }
 
-  void writeOutput_(
-      const std::vector<std::vector<Eigen::Vector3d>>& results) const;
+  /* Where the locations are in system: given points or atom positions */
+  [[nodiscard]] std::vector<Eigen::Vector3d> positionsIn_(
+      const System& system) const;
+
+  /* fields[frame][location * groups + group] */
+  void writeDecomposition_(
+      const std::vector<std::vector<Eigen::Vector3d>>& fields,
+      const std::vector<std::string>& groups, size_t firstFrame) const;
+
+  void writeOutput_(const std::vector<std::vector<Eigen::Vector3d>>& results,
+                    size_t chargeSets) const;
 
   void plot_(const std::vector<std::vector<Eigen::Vector3d>>& results) const;
 };
@@ -0,0 +1,91 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FIELDSOLVER_H
+#define FIELDSOLVER_H
+
+/* C++ STL HEADER FILES */
+#include <string>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "Utilities.h"
+
+namespace cpet {
+
+constexpr double DEFAULT_OPENING_ANGLE = 0.5;
+constexpr double DEFAULT_NEAR_FIELD_FACTOR = 3.0;
+
+/* How a block wants the electric field evaluated */
+struct FieldSolver {
+  enum class Type { direct, barneshut, multipole };
+
+  Type type{Type::direct};
+
+  /* Barnes-Hut opening angle: a node of width w at distance d is used as a
+   * whole when w / d < theta. Smaller is more accurate. */
+  double theta{DEFAULT_OPENING_ANGLE};
+
+  /* Far-field multipole: charges further than this many bounding radii from
+   * the center of the sampling volume are collapsed into an expansion */
+  double nearFieldFactor{DEFAULT_NEAR_FIELD_FACTOR};
+
+  [[nodiscard]] inline std::string description() const {
+    switch (type) {
+      case Type::barneshut:
+        return "barneshut " + std::to_string(theta);
+      case Type::multipole:
+        return "multipole " + std::to_string(nearFieldFactor);
+      case Type::direct:
+      default:
+        return "direct";
+    }
+  }
+
+  /* Parses the options following a "solver" key, e.g. "barneshut 0.3" or
+   * "multipole 4" */
+  [[nodiscard]] static inline FieldSolver fromOptions(
+      const std::vector<std::string>& options) {
+    if (options.empty()) {
+      throw cpet::invalid_option("Invalid Option: solver requires a type");
+    }
+    FieldSolver result;
+    const auto type = util::tolower(options[0]);
+    if (type == "direct") {
+      result.type = Type::direct;
+    } else if (type == "barneshut") {
+      result.type = Type::barneshut;
+      if (options.size() > 1) {
+        if (!util::isDouble(options[1])) {
+          throw cpet::invalid_option(
+              "Invalid Option: solver opening angle should be numeric");
+        }
+        result.theta = std::stod(options[1]);
+        if (result.theta < 0.0) {
+          throw cpet::invalid_option(
+              "Invalid Option: solver opening angle should be >= 0");
+        }
+      }
+    } else if (type == "multipole") {
+      result.type = Type::multipole;
+      if (options.size() > 1) {
+        if (!util::isDouble(options[1])) {
+          throw cpet::invalid_option(
+              "Invalid Option: solver near field factor should be numeric");
+        }
+        result.nearFieldFactor = std::stod(options[1]);
+        if (result.nearFieldFactor < 1.0) {
+          throw cpet::invalid_option(
+              "Invalid Option: solver near field factor should be >= 1");
+        }
+      }
+    } else {
+      throw cpet::invalid_option("Invalid Option: Unknown solver " +
+                                 options[0]);
+    }
+    return result;
+  }
+};
+}  // namespace cpet
+#endif  // FIELDSOLVER_H
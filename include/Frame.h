@@ -5,147 +5,74 @@
 #define FRAME_H
 
 /* C++ STL HEADER FILES */
+#include <cstddef>
+#include <memory>
 #include <utility>
 #include <vector>
-#include <algorithm>
-#include <utility>
 
 /* EXTERNAL LIBRARY HEADER FILES */
-#include <spdlog/spdlog.h>
+#include <Eigen/Dense>
 
 /* CPET HEADER FILES */
-#include "PointCharge.h"
-#include "Utilities.h"
-#include "Constants.h"
+#include "Exceptions.h"
+#include "Topology.h"
 
 namespace cpet {
+
+/* Coordinates of one frame of a trajectory, 24 bytes per atom. IDs and
+ * charges are in the topology shared with the other frames. */
 class Frame {
  public:
-  using const_iterator = std::vector<PointCharge>::const_iterator;
-  using iterator = std::vector<PointCharge>::iterator;
-  using const_reverse_iterator =
-      std::vector<PointCharge>::const_reverse_iterator;
-  using reverse_iterator = std::vector<PointCharge>::reverse_iterator;
-
-  explicit Frame(std::vector<PointCharge> pcs)
-      : pointCharges_(std::move(pcs)) {}
-
-  [[nodiscard]] inline std::vector<PointCharge>::const_iterator find(
-      const AtomID& id) const {
-    return util::find_if_ex(pointCharges_.begin(), pointCharges_.end(),
-                            [&id](const auto& pc) { return pc.id == id; });
-  }
-
-  [[nodiscard]] inline const_iterator begin() const noexcept {
-    return pointCharges_.begin();
-  }
+  using const_iterator = std::vector<Eigen::Vector3d>::const_iterator;
+  using iterator = std::vector<Eigen::Vector3d>::iterator;
 
-  [[nodiscard]] inline const_iterator end() const noexcept {
-    return pointCharges_.end();
-  }
-
-  [[nodiscard]] inline iterator begin() noexcept {
-    return pointCharges_.begin();
+  Frame(std::vector<Eigen::Vector3d> coordinates,
+        std::shared_ptr<const Topology> topology)
+      : coordinates_(std::move(coordinates)), topology_(std::move(topology)) {
+    if (topology_ == nullptr || topology_->size() != coordinates_.size()) {
+      throw cpet::value_error(
+          "Inconsistent number of coordinates and atoms in frame");
+    }
   }
 
-  [[nodiscard]] inline iterator end() noexcept { return pointCharges_.end(); }
-
-  [[nodiscard]] inline const_reverse_iterator rbegin() const noexcept {
-    return pointCharges_.rbegin();
+  /* Coordinate of the first atom with this ID, found in O(1) */
+  [[nodiscard]] inline const Eigen::Vector3d& find(const AtomID& id) const {
+    if (const auto index = topology_->find(id)) {
+      return coordinates_[*index];
+    }
+    throw cpet::value_not_found("Could not find atom " + id.ID());
   }
 
-  [[nodiscard]] inline const_reverse_iterator rend() const noexcept {
-    return pointCharges_.rend();
+  [[nodiscard]] inline const_iterator begin() const noexcept {
+    return coordinates_.begin();
   }
 
-  [[nodiscard]] inline reverse_iterator rbegin() noexcept {
-    return pointCharges_.rbegin();
+  [[nodiscard]] inline const_iterator end() const noexcept {
+    return coordinates_.end();
   }
 
-  [[nodiscard]] inline reverse_iterator rend() noexcept {
-    return pointCharges_.rend();
+  [[nodiscard]] inline iterator begin() noexcept {
+    return coordinates_.begin();
   }
 
-  inline void updateCharges(const std::vector<double>& charges) {
-    if (pointCharges_.size() != charges.size()) {
-      SPDLOG_ERROR("Structure size: {}, number of charges: {}",
-                   pointCharges_.size(), charges.size());
-      throw cpet::value_error(
-          "Inconsistent number of point charges in trajectory and in charge "
-          "file");
-    }
-    for (size_t i = 0; i < pointCharges_.size(); i++) {
-      pointCharges_[i].charge = charges[i];
-    }
-  }
+  [[nodiscard]] inline iterator end() noexcept { return coordinates_.end(); }
 
-  inline void push_back(const PointCharge& value) {
-    pointCharges_.push_back(value);
+  [[nodiscard]] inline const Eigen::Vector3d& operator[](
+      size_t i) const noexcept {
+    return coordinates_[i];
   }
 
-  inline void push_Back(PointCharge&& value) {
-    pointCharges_.push_back(std::move(value));
+  [[nodiscard]] inline const Topology& topology() const noexcept {
+    return *topology_;
   }
 
-  [[nodiscard]] inline static std::vector<Frame> loadFramesFromFile(
-      const std::string& file, const int start, const int skip) {
-    SPDLOG_DEBUG("Loading point charge trajectory from {} ...", file);
-    std::vector<PointCharge> tmpHolder;
-    std::vector<Frame> frameTrajectory;
-
-    std::function<void(const std::string& line)> addPointCharge;
-
-    if (util::endswith(file, ".pqr")) {
-      addPointCharge = [&](const std::string& line) {
-        const auto tokens = util::split(line, ' ');
-        tmpHolder.emplace_back(
-            Eigen::Vector3d({std::stod(tokens[constants::PQR_XCOORD_INDEX]),
-                             std::stod(tokens[constants::PQR_YCOORD_INDEX]),
-                             std::stod(tokens[constants::PQR_ZCOORD_INDEX])}),
-            std::stod(tokens[constants::PQR_CHARGE_INDEX]),
-            AtomID::generateID(line, constants::FileType::pqr));
-      };
-    } else {
-      /* Assume we have a pdb then */
-      addPointCharge = [&](const std::string& line) {
-        tmpHolder.emplace_back(
-            Eigen::Vector3d(
-                {std::stod(line.substr(constants::PDB_XCOORD_START,
-                                       constants::PDB_COORD_WIDTH)),
-                 std::stod(line.substr(constants::PDB_YCOORD_START,
-                                       constants::PDB_COORD_WIDTH)),
-                 std::stod(line.substr(constants::PDB_ZCOORD_START,
-                                       constants::PDB_COORD_WIDTH))}),
-            std::stod(line.substr(constants::PDB_CHARGE_START,
-                                  constants::PDB_CHARGE_WIDTH)),
-            AtomID::generateID(line, constants::FileType::pdb));
-      };
-    }
-
-    util::forEachLineIn(
-        file, [&, structureIndex = 0](const std::string& line) mutable {
-          if (structureIndex < start || (start - structureIndex) % skip != 0) {
-            /* No need to collect frames */
-            if (util::startswith(line, "ENDMDL")) {
-              ++structureIndex;
-            }
-          } else if (util::startswith(line, "ENDMDL")) {
-            frameTrajectory.emplace_back(tmpHolder);
-            tmpHolder.clear();
-            ++structureIndex;
-          } else if (util::startswith(line, "ATOM") ||
-                     util::startswith(line, "HETATM")) {
-            addPointCharge(line);
-          }
-        });
-    if (!tmpHolder.empty()) {
-      frameTrajectory.emplace_back(tmpHolder);
-    }
-    return frameTrajectory;
+  [[nodiscard]] inline size_t size() const noexcept {
+    return coordinates_.size();
   }
 
  private:
-  std::vector<PointCharge> pointCharges_;
+  std::vector<Eigen::Vector3d> coordinates_;
+  std::shared_ptr<const Topology> topology_;
 };
 
 }  // namespace cpet
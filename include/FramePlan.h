@@ -0,0 +1,49 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FRAMEPLAN_H
+#define FRAMEPLAN_H
+
+/* C++ STL HEADER FILES */
+#include <string>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Device.h"
+#include "Frame.h"
+#include "Option.h"
+#include "System.h"
+#include "ThreadPool.h"
+
+namespace cpet {
+
+/* The system of frame with the center and basis of the align line of
+ * option, and an octree if a block of option uses one; its coordinates are
+ * still those of frame until transformToUserSpace() */
+[[nodiscard]] System systemFor(Frame frame, const Option& option);
+
+/* How each window of frames is run. Every block of the option file works
+ * on the same per-frame data: the coordinates in user space and the charge
+ * arrays, Barnes-Hut octree and device copy built from them. The plan
+ * builds that once per frame, for the frames of a window in parallel;
+ * every block then runs on the window, which is freed before the next one
+ * is read. */
+class FramePlan {
+ public:
+  /* option must outlive the plan */
+  inline FramePlan(const Option& option, const Device device) noexcept
+      : option_(option), device_(device) {}
+
+  /* Systems of frames, ready for every block */
+  [[nodiscard]] std::vector<System> prepare(std::vector<Frame> frames,
+                                            util::ThreadPool& pool) const;
+
+  /* The blocks run on each frame */
+  [[nodiscard]] std::string description() const;
+
+ private:
+  const Option& option_;
+  Device device_;
+};
+}  // namespace cpet
+#endif  // FRAMEPLAN_H
@@ -0,0 +1,76 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef FRAMEVIEW_H
+#define FRAMEVIEW_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "Integrator.h"
+#include "PathSample.h"
+#include "PointChargeStore.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "Volume.h"
+
+namespace cpet {
+
+/* Caller-owned coordinates of size atoms: atom i is at data[i * stride],
+ * data[i * stride + 1] and data[i * stride + 2]. A stride of 3 reads packed
+ * x y z triples; larger strides skip padding or other per-atom fields. */
+struct CoordinateView {
+  const double* data{nullptr};
+  size_t size{0};
+  size_t stride{3};
+};
+
+/* Caller-owned charges (e): atom i carries data[i * stride] */
+struct ChargeView {
+  const double* data{nullptr};
+  size_t stride{1};
+};
+
+/* Entry point of libcpet for programs that already hold a frame in memory:
+ * fields and topology samples of the coordinates and charges the caller
+ * points at, with no files, atom IDs or option file. The views are read
+ * once, when the constructor packs the charged atoms into the arrays the
+ * field kernels stream, and need not outlive the FrameView. Positions and
+ * volumes are in the coordinates of the views (Ang). */
+class FrameView {
+ public:
+  FrameView(const CoordinateView& coordinates, const ChargeView& charges);
+
+  /* Number of charged atoms */
+  [[nodiscard]] inline size_t size() const noexcept { return store_.size(); }
+
+  [[nodiscard]] inline const PointChargeStore& chargeStore() const noexcept {
+    return store_;
+  }
+
+  /* fields[i] is the field (V/Ang) at positions[i], summed directly */
+  void electricFieldAt(const Eigen::Vector3d* positions, size_t count,
+                       Eigen::Vector3d* fields) const noexcept;
+
+  /* As above, split across pool */
+  void electricFieldAt(const Eigen::Vector3d* positions, size_t count,
+                       Eigen::Vector3d* fields, util::ThreadPool& pool) const;
+
+  /* Draws samples [0, count) of stream in volume into out, as a %topology
+   * block with the same volume, step size and integrator would */
+  void electricFieldTopologyIn(const Volume& volume, double stepSize,
+                               size_t count, PathSample* out,
+                               util::ThreadPool& pool,
+                               const Integrator& integrator = Integrator{},
+                               const util::SampleStream& stream =
+                                   util::SampleStream{}) const;
+
+ private:
+  PointChargeStore store_;
+};
+}  // namespace cpet
+#endif  // FRAMEVIEW_H
@@ -0,0 +1,88 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef GPUFIELD_H
+#define GPUFIELD_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "PathSample.h"
+#include "PointChargeStore.h"
+#include "Random.h"
+
+namespace cpet::gpu {
+
+/* Fields summed on the GPU differ from the direct CPU sum only in rounding
+ * (fused multiply-adds): by at most this much relative to their magnitude.
+ * Streamlines follow the same steps, so topology samples agree to about the
+ * same precision, except for the rare line that ends within that distance
+ * of the sampling box and stops one step earlier or later. */
+constexpr double FIELD_TOLERANCE = 1e-10;
+
+/* True if cpet was built with CUDA (CPET_USE_CUDA) and a GPU is visible */
+[[nodiscard]] bool available() noexcept;
+
+/* A topology block as plain values the GPU can copy: the sampling box, its
+ * step rules and the integrator */
+struct TraceSettings {
+  enum class Method { euler, rk4, dormandprince };
+
+  Method method{Method::euler};
+  /* Dormand-Prince: largest accepted position error (Ang) per step */
+  double tolerance{0.0};
+  double stepSize{0.0};
+  /* Dormand-Prince: largest step, so no step skips a corner of the box */
+  double maxStep{0.0};
+  /* Streamlines are drawn between 1 and maxSteps steps long */
+  int maxSteps{1};
+  std::array<double, 3> center{};
+  std::array<double, 3> halfWidths{};
+};
+
+/* One traced topology sample with the work it took */
+struct TracedSample {
+  PathSample sample;
+  uint32_t steps;
+  uint32_t evaluations;
+  bool reachedLength;
+};
+
+/* The charges of one frame, uploaded to the GPU once and used by every field
+ * evaluation and streamline of the frame. The direct sum is the only solver
+ * on the GPU. Calls from several threads are serialized. */
+class Charges {
+ public:
+  explicit Charges(const PointChargeStore& store);
+
+  Charges(const Charges&) = delete;
+
+  Charges& operator=(const Charges&) = delete;
+
+  ~Charges();
+
+  /* results[i] is the field (V/Ang) at positions[i] */
+  void fieldAt(const Eigen::Vector3d* positions, size_t count,
+               Eigen::Vector3d* results) const;
+
+  /* Traces samples [first, first + count) of stream, one GPU thread each,
+   * drawing the same random numbers as the CPU */
+  [[nodiscard]] std::vector<TracedSample> trace(
+      const TraceSettings& settings, const util::SampleStream& stream,
+      size_t first, size_t count) const;
+
+ private:
+  struct Buffers;
+  std::unique_ptr<Buffers> buffers_;
+};
+
+}  // namespace cpet::gpu
+#endif  // GPUFIELD_H
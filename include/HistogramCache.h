@@ -0,0 +1,81 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef HISTOGRAMCACHE_H
+#define HISTOGRAMCACHE_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+/* CPET HEADER FILES */
+#include "DistanceMatrix.h"
+#include "Histogram2D.h"
+#include "ThreadPool.h"
+#include "TopologyHistograms.h"
+
+namespace cpet {
+
+/* The normalized histograms of the frames a distance matrix was computed
+ * over, with their limits and the matrix itself, so that frames added to a
+ * trajectory later are only compared against the cached ones. The file
+ * holds one record per frame, its histogram and its distances to the
+ * frames before it, so appending frames appends records. A record cut
+ * short by a kill is dropped when the file is opened again. */
+class HistogramCache {
+ public:
+  /* Loads what an earlier run cached in file for the same bins, and the
+   * same limits if they are fixed. A missing file, or one written for
+   * other bins or limits, starts empty. */
+  HistogramCache(std::string file, const std::array<int, 2>& bins,
+                 const std::optional<HistogramLimits>& limits);
+
+  [[nodiscard]] inline size_t frames() const noexcept {
+    return matrix_.size();
+  }
+
+  /* Limits the cached frames were binned with; only set if frames() > 0 */
+  [[nodiscard]] inline const std::optional<HistogramLimits>& limits()
+      const noexcept {
+    return limits_;
+  }
+
+  /* Distances between every cached frame */
+  [[nodiscard]] inline const histo::DistanceMatrix& matrix() const noexcept {
+    return matrix_;
+  }
+
+  /* Forgets the cached frames; the file is rewritten on the next append */
+  void clear();
+
+  /* Caches the rows of histograms, binned with limits, after the cached
+   * frames and computes their distances to every frame. limits must be
+   * those of the cached frames, if any. */
+  void append(const histo::HistogramMatrix& histograms,
+              const HistogramLimits& limits, util::ThreadPool& pool);
+
+  [[nodiscard]] inline const std::string& file() const noexcept {
+    return file_;
+  }
+
+ private:
+  std::string file_;
+  std::array<int, 2> bins_;
+  std::optional<HistogramLimits> limits_{std::nullopt};
+  histo::HistogramMatrix histograms_;
+  histo::DistanceMatrix matrix_{0};
+  /* Length of the file up to the last complete record */
+  size_t end_{0};
+
+  [[nodiscard]] inline size_t binCount_() const noexcept {
+    return static_cast<size_t>(bins_[0]) * static_cast<size_t>(bins_[1]);
+  }
+
+  /* Reads the records of the file; false if it was written for other bins
+   * or limits */
+  bool load_(const std::optional<HistogramLimits>& fixed);
+};
+}  // namespace cpet
+#endif  // HISTOGRAMCACHE_H
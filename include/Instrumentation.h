@@ -5,9 +5,15 @@
 #define INSTRUMENTATION_H
 
 /* C++ STL HEADER FILES */
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <utility>
 
 /* EXTERNAL LIBRARY HEADER FILES */
@@ -65,4 +71,101 @@ class Timer {
 
   std::function<void(const float)> func_{[](const float /*unused*/) {}};
 };
+
+namespace cpet::util {
+
+/* Where a run spends its time and how much work it does. Stage times are
+ * summed by name and counters by kind, from any thread. Until enable() is
+ * called, both cost a relaxed load and a branch. */
+class Profiler {
+ public:
+  enum class Counter : size_t {
+    framesRead,
+    samples,
+    samplesLeftVolume,
+    samplesReachedLength,
+    integrationSteps,
+    fieldEvaluations,
+    count
+  };
+
+  struct Stage {
+    double seconds{0.0};
+    uint64_t calls{0};
+  };
+
+  [[nodiscard]] static Profiler& instance() noexcept;
+
+  inline void enable() noexcept {
+    enabled_.store(true, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] inline bool enabled() const noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  inline void add(const Counter counter, const uint64_t value = 1) noexcept {
+    if (enabled()) {
+      counters_[static_cast<size_t>(counter)].fetch_add(
+          value, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] inline uint64_t count(const Counter counter) const noexcept {
+    return counters_[static_cast<size_t>(counter)].load(
+        std::memory_order_relaxed);
+  }
+
+  void addTime(const std::string& stage, double seconds);
+
+  [[nodiscard]] std::map<std::string, Stage> stages() const;
+
+  /* Writes the stages, counters and steps per sample as CSV if file ends
+   * in .csv and as JSON otherwise */
+  void writeReport(const std::string& file) const;
+
+  /* Clears every stage and counter, leaving enabled() as is */
+  void reset();
+
+ private:
+  Profiler() = default;
+
+  std::atomic<bool> enabled_{false};
+  std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::count)>
+      counters_{};
+  mutable std::mutex mutex_;
+  std::map<std::string, Stage> stages_;
+};
+
+/* Adds the time until it is destroyed to a stage of the Profiler */
+class ProfileStage {
+ public:
+  explicit inline ProfileStage(const char* name) noexcept
+      : name_(Profiler::instance().enabled() ? name : nullptr) {
+    if (name_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ProfileStage(const ProfileStage&) = delete;
+
+  ProfileStage& operator=(const ProfileStage&) = delete;
+
+  inline ~ProfileStage() {
+    if (name_ != nullptr) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_;
+      try {
+        Profiler::instance().addTime(name_, elapsed.count());
+      } catch (...) {
+      }
+    }
+  }
+
+ private:
+  const char* name_;
+  std::chrono::time_point<std::chrono::steady_clock> start_{};
+};
+
+}  // namespace cpet::util
 #endif  // INSTRUMENTATION_H
@@ -0,0 +1,128 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "FieldEvaluator.h"
+#include "PathSample.h"
+#include "Random.h"
+#include "Utilities.h"
+#include "Volume.h"
+
+namespace cpet {
+
+constexpr double DEFAULT_INTEGRATOR_TOLERANCE = 1e-6;
+
+/* How a topology block wants field lines traced */
+struct Integrator {
+  enum class Type { euler, rk4, dormandprince };
+
+  Type type{Type::euler};
+
+  /* Dormand-Prince: largest accepted position error (Ang) per step */
+  double tolerance{DEFAULT_INTEGRATOR_TOLERANCE};
+
+  [[nodiscard]] inline std::string description() const {
+    switch (type) {
+      case Type::rk4:
+        return "rk4";
+      case Type::dormandprince:
+        return "dormandprince " + std::to_string(tolerance);
+      case Type::euler:
+      default:
+        return "euler";
+    }
+  }
+
+  /* Parses the options following an "integrator" key, e.g. "rk4" or
+   * "dormandprince 1e-8" */
+  [[nodiscard]] static inline Integrator fromOptions(
+      const std::vector<std::string>& options) {
+    if (options.empty()) {
+      throw cpet::invalid_option("Invalid Option: integrator requires a type");
+    }
+    Integrator result;
+    const auto type = util::tolower(options[0]);
+    if (type == "euler") {
+      result.type = Type::euler;
+    } else if (type == "rk4") {
+      result.type = Type::rk4;
+    } else if (type == "dormandprince" || type == "rk45") {
+      result.type = Type::dormandprince;
+      if (options.size() > 1) {
+        if (!util::isDouble(options[1])) {
+          throw cpet::invalid_option(
+              "Invalid Option: integrator tolerance should be numeric");
+        }
+        result.tolerance = std::stod(options[1]);
+        if (result.tolerance <= 0.0) {
+          throw cpet::invalid_option(
+              "Invalid Option: integrator tolerance should be > 0");
+        }
+      }
+    } else {
+      throw cpet::invalid_option("Invalid Option: Unknown integrator " +
+                                 options[0]);
+    }
+    return result;
+  }
+};
+
+namespace streamline {
+
+/* Where a traced field line ended, how long it was and how many field
+ * evaluations and accepted steps it took */
+struct Trace {
+  Eigen::Vector3d position;
+  double length;
+  size_t evaluations;
+  size_t steps{0};
+};
+
+/* Follows the field line through start, parameterized by arc length, until
+ * it leaves region or reaches maxLength. stepSize is the fixed step of the
+ * Euler and RK4 integrators and the initial step of Dormand-Prince, whose
+ * steps adapt to the tolerance but shrink back to stepSize to resolve where
+ * the line leaves the region. */
+[[nodiscard]] Trace trace(const FieldEvaluator& field, const Volume& region,
+                          const Eigen::Vector3d& start, double maxLength,
+                          double stepSize, const Integrator& integrator);
+
+/* Where a field line starts and how long it may grow */
+struct Start {
+  Eigen::Vector3d position;
+  double maxLength;
+};
+
+/* traces[i] is trace(field, region, starts[i].position, starts[i].maxLength,
+ * stepSize, integrator). Euler and RK4 advance field::PACKET_SIZE lines in
+ * lock step, so each stage evaluates the field at all of them in one pass
+ * over the charges; a line that ends hands its lane to the next start.
+ * Dormand-Prince lines pick their own step sizes and are traced one by
+ * one. */
+void tracePackets(const FieldEvaluator& field, const Volume& region,
+                  const Start* starts, size_t count, double stepSize,
+                  const Integrator& integrator, Trace* traces);
+
+/* Topology samples [first, first + count) of stream into out: each draws
+ * a start in region and a length, traces its field line in packets and
+ * records the distance between the ends and their mean curvature */
+void sampleTopology(const FieldEvaluator& field, const Volume& region,
+                    double stepSize, const Integrator& integrator,
+                    const util::SampleStream& stream, size_t first,
+                    size_t count, PathSample* out);
+
+}  // namespace streamline
+}  // namespace cpet
+#endif  // INTEGRATOR_H
@@ -0,0 +1,65 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cpet {
+namespace util {
+
+/* Read-only memory map of a whole file. Its contents are read straight from
+ * the page cache, with no copy into a buffer. */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& file);
+
+  MappedFile(const MappedFile&) = delete;
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile();
+
+  [[nodiscard]] inline std::string_view view() const noexcept {
+    return {data_, size_};
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return size_; }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+/* Walks the lines of a buffer without copying them. Line endings (\n or
+ * \r\n) are not part of the returned lines. */
+class LineScanner {
+ public:
+  explicit inline LineScanner(std::string_view text) noexcept : rest_(text) {}
+
+  [[nodiscard]] inline std::optional<std::string_view> next() noexcept {
+    if (rest_.empty()) {
+      return std::nullopt;
+    }
+    const auto end = rest_.find('\n');
+    auto line = rest_.substr(0, end);
+    rest_.remove_prefix((end == std::string_view::npos) ? rest_.size()
+                                                        : end + 1);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    return line;
+  }
+
+ private:
+  std::string_view rest_;
+};
+
+}  // namespace util
+}  // namespace cpet
+#endif  // MAPPEDFILE_H
@@ -0,0 +1,70 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef OCTREE_H
+#define OCTREE_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "PointChargeStore.h"
+
+namespace cpet {
+
+/* Barnes-Hut tree over a set of point charges. Each node stores its total
+ * charge, dipole and traceless quadrupole moment about its geometric center;
+ * nodes that are small compared to their distance from the evaluation point
+ * are treated as a single multipole, everything else is opened until the
+ * leaves, which are summed directly with the SIMD kernel. Protein charges are
+ * close to neutral per residue, so the quadrupole term carries most of the
+ * far field. */
+class Octree {
+ public:
+  static constexpr size_t DEFAULT_LEAF_SIZE = 32;
+  static constexpr int MAX_DEPTH = 24;
+
+  Octree() = default;
+
+  explicit Octree(const PointChargeStore& charges,
+                  size_t leafSize = DEFAULT_LEAF_SIZE);
+
+  /* Field (V/Ang) at position using opening angle theta. theta = 0 opens
+   * every node and reproduces direct summation. */
+  [[nodiscard]] Eigen::Vector3d electricFieldAt(const Eigen::Vector3d& position,
+                                                double theta) const noexcept;
+
+  [[nodiscard]] inline size_t numberOfNodes() const noexcept {
+    return nodes_.size();
+  }
+
+  [[nodiscard]] inline bool empty() const noexcept { return nodes_.empty(); }
+
+ private:
+  struct Node {
+    Eigen::Vector3d center;
+    double halfWidth;
+    double charge;
+    Eigen::Vector3d dipole;
+    Eigen::Matrix3d quadrupole;
+    size_t begin;
+    size_t end;
+    std::array<int32_t, 8> children;
+    bool leaf;
+  };
+
+  /* Charges reordered so that every node covers a contiguous range */
+  PointChargeStore charges_;
+  std::vector<Node> nodes_;
+
+  int32_t build_(const PointChargeStore& charges, std::vector<size_t>& order,
+                 size_t begin, size_t end, const Eigen::Vector3d& center,
+                 double halfWidth, size_t leafSize, int depth);
+};
+}  // namespace cpet
+#endif  // OCTREE_H
@@ -0,0 +1,124 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef OUTPUTFORMAT_H
+#define OUTPUTFORMAT_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "BinaryCursor.h"
+#include "BinaryWriter.h"
+#include "Exceptions.h"
+#include "Utilities.h"
+
+namespace cpet {
+
+/* Largest uncompressed chunk of a binary array */
+constexpr size_t OUTPUT_CHUNK_BYTES = 1U << 20U;
+
+/* How a block writes its results. Text is the human readable default.
+ * Binary files start with a magic string and the precision, then hold
+ * arrays of reals written by writeReals. */
+struct OutputFormat {
+  enum class Encoding { text, binary };
+  enum class Precision { float32, float64 };
+
+  Encoding encoding{Encoding::text};
+  Precision precision{Precision::float32};
+
+  /* Chunks are byte shuffled and zlib compressed. A chunk that does not
+   * shrink is stored as is. */
+  bool compressed{false};
+
+  [[nodiscard]] constexpr bool binary() const noexcept {
+    return encoding == Encoding::binary;
+  }
+
+  [[nodiscard]] constexpr size_t bytesPerReal() const noexcept {
+    return (precision == Precision::float32) ? sizeof(float) : sizeof(double);
+  }
+
+  [[nodiscard]] inline std::string description() const {
+    if (!binary()) {
+      return "text";
+    }
+    std::string result = "binary ";
+    result += (precision == Precision::float32) ? "float32" : "float64";
+    if (compressed) {
+      result += " compressed";
+    }
+    return result;
+  }
+
+  /* Writes the magic string followed by the precision and compression */
+  void writeHeader(util::BinaryWriter& writer, std::string_view magic) const;
+
+  /* Appends values as a count followed by chunks of at most
+   * OUTPUT_CHUNK_BYTES, each stored as [raw size][stored size][bytes] */
+  void writeReals(util::BinaryWriter& writer,
+                  const std::vector<double>& values) const;
+
+  /* Appends only the chunks of writeReals. Chunks stand alone, so the
+   * chunks of several parts of an array may follow one count of them all */
+  void writeChunks(util::BinaryWriter& writer,
+                   const std::vector<double>& values) const;
+
+  /* True if data starts with the magic string of a binary file */
+  [[nodiscard]] static inline bool isBinary(std::string_view data,
+                                            std::string_view magic) noexcept {
+    return data.substr(0, magic.size()) == magic;
+  }
+
+  /* Reads the header written by writeHeader; the cursor must be little
+   * endian */
+  [[nodiscard]] static OutputFormat readHeader(util::BinaryCursor& cursor,
+                                               std::string_view magic);
+
+  [[nodiscard]] std::vector<double> readReals(
+      util::BinaryCursor& cursor) const;
+
+  /* Parses the options following a "format" key, e.g. "text" or
+   * "binary float64 compressed" */
+  [[nodiscard]] static inline OutputFormat fromOptions(
+      const std::vector<std::string>& options) {
+    if (options.empty()) {
+      throw cpet::invalid_option("Invalid Option: format requires a type");
+    }
+    OutputFormat result;
+    const auto type = util::tolower(options[0]);
+    if (type == "text") {
+      if (options.size() > 1) {
+        throw cpet::invalid_option(
+            "Invalid Option: text format takes no further options");
+      }
+      return result;
+    }
+    if (type != "binary") {
+      throw cpet::invalid_option("Invalid Option: Unknown format " +
+                                 options[0]);
+    }
+    result.encoding = Encoding::binary;
+    for (auto option = options.begin() + 1; option != options.end();
+         ++option) {
+      const auto value = util::tolower(*option);
+      if (value == "float32") {
+        result.precision = Precision::float32;
+      } else if (value == "float64") {
+        result.precision = Precision::float64;
+      } else if (value == "compressed") {
+        result.compressed = true;
+      } else {
+        throw cpet::invalid_option("Invalid Option: Unknown binary format " +
+                                   *option);
+      }
+    }
+    return result;
+  }
+};
+}  // namespace cpet
+#endif  // OUTPUTFORMAT_H
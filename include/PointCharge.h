@@ -11,25 +11,24 @@
 #include <Eigen/Dense>
 
 /* CPET HEADER FILES */
-#include "AtomID.h"
 #include "Utilities.h"
 
 namespace cpet {
 
+/* Coordinate and charge of one atom as read from a structure file. Frames
+ * keep the coordinate; the charge and ID belong to the Topology. */
 struct PointCharge {
   Eigen::Vector3d coordinate;
 
   double charge;
 
-  AtomID id;
-
-  inline PointCharge(Eigen::Vector3d coord, double q, AtomID aid) noexcept
-      : coordinate(std::move(coord)), charge(q), id(std::move(aid)) {}
+  inline PointCharge(Eigen::Vector3d coord, double q) noexcept
+      : coordinate(std::move(coord)), charge(q) {}
 
   [[nodiscard]] inline bool operator==(const PointCharge& pc) const {
-    return (coordinate == pc.coordinate) && (charge == pc.charge) &&
-           (id == pc.id);
+    return (coordinate == pc.coordinate) && (charge == pc.charge);
   }
-} __attribute__((aligned(128)));
+};
+static_assert(sizeof(PointCharge) == 4 * sizeof(double));
 }  // namespace cpet
 #endif  // POINTCHARGE_H
@@ -0,0 +1,137 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef POINTCHARGESTORE_H
+#define POINTCHARGESTORE_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "PointCharge.h"
+
+namespace cpet {
+
+/* Packed structure-of-arrays copy of the point charges, so the field kernels
+ * load each coordinate of several charges with one vector load. */
+class PointChargeStore {
+ public:
+  using array_type = std::vector<double, Eigen::aligned_allocator<double>>;
+
+  PointChargeStore() = default;
+
+  template <class InputIt>
+  inline PointChargeStore(InputIt first, InputIt last) {
+    assign(first, last);
+  }
+
+  template <class InputIt>
+  inline void assign(InputIt first, InputIt last) {
+    clear();
+    reserve(static_cast<size_t>(std::distance(first, last)));
+    for (; first != last; ++first) {
+      push_back(first->coordinate, first->charge);
+    }
+  }
+
+  inline void push_back(const Eigen::Vector3d& coordinate, double charge) {
+    x_.push_back(coordinate[0]);
+    y_.push_back(coordinate[1]);
+    z_.push_back(coordinate[2]);
+    q_.push_back(charge);
+  }
+
+  inline void reserve(size_t count) {
+    x_.reserve(count);
+    y_.reserve(count);
+    z_.reserve(count);
+    q_.reserve(count);
+  }
+
+  inline void clear() noexcept {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    q_.clear();
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return q_.size(); }
+
+  [[nodiscard]] inline bool empty() const noexcept { return q_.empty(); }
+
+  [[nodiscard]] inline const double* x() const noexcept { return x_.data(); }
+
+  [[nodiscard]] inline const double* y() const noexcept { return y_.data(); }
+
+  [[nodiscard]] inline const double* z() const noexcept { return z_.data(); }
+
+  [[nodiscard]] inline const double* q() const noexcept { return q_.data(); }
+
+  [[nodiscard]] inline Eigen::Vector3d coordinate(size_t i) const noexcept {
+    return {x_[i], y_[i], z_[i]};
+  }
+
+ private:
+  array_type x_;
+  array_type y_;
+  array_type z_;
+  array_type q_;
+};
+
+/* Several charge sets on the same coordinates, e.g. one per force field or
+ * protonation state: the coordinates of the atoms charged in any set, and
+ * one charge array per set. The field kernels compute the geometry of each
+ * charge once and apply it to every set. */
+class ChargeSetStore {
+ public:
+  using array_type = PointChargeStore::array_type;
+
+  explicit inline ChargeSetStore(size_t sets = 0) : q_(sets) {}
+
+  /* charges[set] is the charge of this coordinate in each set */
+  inline void push_back(const Eigen::Vector3d& coordinate,
+                        const double* charges) {
+    x_.push_back(coordinate[0]);
+    y_.push_back(coordinate[1]);
+    z_.push_back(coordinate[2]);
+    for (size_t set = 0; set < q_.size(); set++) {
+      q_[set].push_back(charges[set]);
+    }
+  }
+
+  inline void reserve(size_t count) {
+    x_.reserve(count);
+    y_.reserve(count);
+    z_.reserve(count);
+    for (auto& charges : q_) {
+      charges.reserve(count);
+    }
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return x_.size(); }
+
+  [[nodiscard]] inline size_t sets() const noexcept { return q_.size(); }
+
+  [[nodiscard]] inline const double* x() const noexcept { return x_.data(); }
+
+  [[nodiscard]] inline const double* y() const noexcept { return y_.data(); }
+
+  [[nodiscard]] inline const double* z() const noexcept { return z_.data(); }
+
+  [[nodiscard]] inline const double* q(size_t set) const noexcept {
+    return q_[set].data();
+  }
+
+ private:
+  array_type x_;
+  array_type y_;
+  array_type z_;
+  std::vector<array_type> q_;
+};
+}  // namespace cpet
+#endif  // POINTCHARGESTORE_H
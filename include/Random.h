@@ -0,0 +1,134 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* The generators also run in CUDA kernels (GpuField.cu), which reach the
+ * constexpr members of std::array through --expt-relaxed-constexpr */
+#ifdef __CUDACC__
+#define CPET_HOST_DEVICE __host__ __device__
+#else
+#define CPET_HOST_DEVICE
+#endif
+
+namespace cpet::util {
+
+/* Philox4x32-10 (Salmon et al., SC11): 10 rounds of a keyed bijection on a
+ * 128-bit counter. Every (counter, key) gives independent random bits, so
+ * a draw depends on what it is for rather than on what was drawn before. */
+class Philox4x32 {
+ public:
+  using Counter = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+
+  [[nodiscard]] CPET_HOST_DEVICE static constexpr Counter generate(
+      Counter counter, Key key) noexcept {
+    constexpr int ROUNDS = 10;
+    for (int round = 0; round < ROUNDS; round++) {
+      if (round > 0) {
+        key[0] += KEY_INCREMENT_0;
+        key[1] += KEY_INCREMENT_1;
+      }
+      const uint64_t product0 = uint64_t{MULTIPLIER_0} * counter[0];
+      const uint64_t product1 = uint64_t{MULTIPLIER_1} * counter[2];
+      counter = {high_(product1) ^ counter[1] ^ key[0], low_(product1),
+                 high_(product0) ^ counter[3] ^ key[1], low_(product0)};
+    }
+    return counter;
+  }
+
+ private:
+  static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53;
+  static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+  static constexpr uint32_t KEY_INCREMENT_0 = 0x9E3779B9;
+  static constexpr uint32_t KEY_INCREMENT_1 = 0xBB67AE85;
+
+  [[nodiscard]] CPET_HOST_DEVICE static constexpr uint32_t high_(
+      const uint64_t x) noexcept {
+    return static_cast<uint32_t>(x >> 32U);
+  }
+
+  [[nodiscard]] CPET_HOST_DEVICE static constexpr uint32_t low_(
+      const uint64_t x) noexcept {
+    return static_cast<uint32_t>(x);
+  }
+};
+
+/* The random numbers of one topology sample, keyed by the seed and
+ * counted from the frame and sample index. The same sample draws the same
+ * numbers whichever thread computes it and however many threads there
+ * are, so runs with a seed are reproducible and resumed runs continue
+ * exactly. */
+class SampleRandom {
+ public:
+  CPET_HOST_DEVICE inline SampleRandom(const uint64_t seed,
+                                       const uint64_t frame,
+                                       const uint64_t sample) noexcept
+      : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32U)},
+        counter_{0, static_cast<uint32_t>(sample),
+                 static_cast<uint32_t>(sample >> 32U),
+                 static_cast<uint32_t>(frame)} {}
+
+  /* Uniform in [min, max) */
+  [[nodiscard]] CPET_HOST_DEVICE inline double uniform(
+      const double min, const double max) noexcept {
+    /* The top 53 bits fill the mantissa of a double in [0, 1) */
+    constexpr double UNIT = 1.0 / static_cast<double>(uint64_t{1} << 53U);
+    const double unit = static_cast<double>(next_() >> 11U) * UNIT;
+    return min + (max - min) * unit;
+  }
+
+  /* Uniform over the integers [min, max] */
+  [[nodiscard]] CPET_HOST_DEVICE inline int uniformInt(
+      const int min, const int max) noexcept {
+    if (max <= min) {
+      return min;
+    }
+    const auto range =
+        static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    /* The bias of the modulo is below 2^-31 for any int range */
+    return static_cast<int>(static_cast<int64_t>(min) +
+                            static_cast<int64_t>(next_() % range));
+  }
+
+ private:
+  Philox4x32::Key key_;
+  Philox4x32::Counter counter_;
+  Philox4x32::Counter block_{};
+  size_t used_{4};
+
+  /* Draws come four 32-bit words per counter increment */
+  [[nodiscard]] CPET_HOST_DEVICE inline uint64_t next_() noexcept {
+    if (used_ + 2 > block_.size()) {
+      block_ = Philox4x32::generate(counter_, key_);
+      ++counter_[0];
+      used_ = 0;
+    }
+    const uint64_t result =
+        (uint64_t{block_[used_]} << 32U) | uint64_t{block_[used_ + 1]};
+    used_ += 2;
+    return result;
+  }
+};
+
+/* The random numbers of consecutive samples of one frame: the i-th draws
+ * from SampleRandom{seed, frame, firstSample + i} */
+struct SampleStream {
+  uint64_t seed{0};
+  uint64_t frame{0};
+  uint64_t firstSample{0};
+
+  [[nodiscard]] CPET_HOST_DEVICE inline SampleRandom at(
+      const uint64_t i) const noexcept {
+    return {seed, frame, firstSample + i};
+  }
+};
+
+}  // namespace cpet::util
+#endif  // RANDOM_H
@@ -0,0 +1,124 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef SAMPLECONVERGENCE_H
+#define SAMPLECONVERGENCE_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Histogram2D.h"
+#include "PathSample.h"
+#include "TopologyHistograms.h"
+
+namespace cpet {
+
+constexpr size_t DEFAULT_CONVERGENCE_MIN_SAMPLES = 1000;
+constexpr size_t DEFAULT_CONVERGENCE_BATCH = 1000;
+/* Bins of the histogram convergence is judged on when the block has no
+ * bins key */
+constexpr int DEFAULT_CONVERGENCE_BINS = 20;
+
+/* When a frame has drawn enough topology samples: after at least
+ * minSamples, every batch of batchSize is drawn only if the batch before it
+ * still moved the normalized cumulative histogram by tolerance or more, in
+ * chiDistance */
+struct SampleConvergence {
+  double tolerance;
+  size_t minSamples{DEFAULT_CONVERGENCE_MIN_SAMPLES};
+  size_t batchSize{DEFAULT_CONVERGENCE_BATCH};
+
+  [[nodiscard]] inline std::string description() const {
+    return "chi distance < " + std::to_string(tolerance) + " after " +
+           std::to_string(minSamples) + " samples, batches of " +
+           std::to_string(batchSize);
+  }
+};
+
+/* Follows the cumulative histogram of the samples of one frame. Its axes
+ * are the fixed limits, or the range of the first minSamples samples: later
+ * samples outside them do not count towards convergence, but are still
+ * kept. */
+class ConvergenceMonitor {
+ public:
+  inline ConvergenceMonitor(const SampleConvergence& settings,
+                            const std::array<int, 2>& bins,
+                            std::optional<HistogramLimits> limits)
+      : settings_(settings), bins_(bins), limits_(limits) {}
+
+  /* Adds the next samples; true once the frame has converged */
+  inline bool add(const std::vector<PathSample>& samples) {
+    count_ += samples.size();
+    if (!histogram_) {
+      pending_.insert(pending_.end(), samples.begin(), samples.end());
+      if (count_ < settings_.minSamples) {
+        return false;
+      }
+      const auto limits = limitsOf_(pending_);
+      histogram_ =
+          histo::Histogram2D64{bins_, limits.distance, limits.curvature};
+      addAll_(pending_);
+      std::vector<PathSample>{}.swap(pending_);
+      previous_ = histo::normalize(histogram_->counts());
+      return false;
+    }
+
+    addAll_(samples);
+    auto current = histo::normalize(histogram_->counts());
+    distance_ = histo::chiDistance(previous_, current);
+    previous_ = std::move(current);
+    return distance_ < settings_.tolerance;
+  }
+
+  /* Samples added so far */
+  [[nodiscard]] inline size_t count() const noexcept { return count_; }
+
+  /* chiDistance across the last batch; infinite before the first */
+  [[nodiscard]] inline double distance() const noexcept { return distance_; }
+
+ private:
+  SampleConvergence settings_;
+  std::array<int, 2> bins_;
+  std::optional<HistogramLimits> limits_;
+  std::optional<histo::Histogram2D64> histogram_{std::nullopt};
+  std::vector<PathSample> pending_;
+  std::vector<double> previous_;
+  size_t count_{0};
+  double distance_{std::numeric_limits<double>::infinity()};
+
+  inline void addAll_(const std::vector<PathSample>& samples) noexcept {
+    for (const auto& sample : samples) {
+      histogram_->add(sample.distance, sample.curvature);
+    }
+  }
+
+  [[nodiscard]] inline HistogramLimits limitsOf_(
+      const std::vector<PathSample>& samples) const {
+    if (limits_) {
+      return *limits_;
+    }
+    histo::Range distance;
+    histo::Range curvature;
+    for (const auto& sample : samples) {
+      distance.add(sample.distance);
+      curvature.add(sample.curvature);
+    }
+    /* Widened so a degenerate range still makes a valid axis */
+    const auto span = [](const histo::Range& range) {
+      if (range.empty()) {
+        return std::array<double, 2>{0.0, 1.0};
+      }
+      const double pad = (range.max > range.min) ? 0.0 : 0.5;
+      return std::array<double, 2>{range.min - pad, range.max + pad};
+    };
+    return {span(distance), span(curvature)};
+  }
+};
+}  // namespace cpet
+#endif  // SAMPLECONVERGENCE_H
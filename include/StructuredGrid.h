@@ -0,0 +1,97 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef STRUCTUREDGRID_H
+#define STRUCTUREDGRID_H
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+namespace cpet {
+
+/* The points origin + (i, j, k) * spacing of a regular grid, with
+ * 0 <= i < dims[0] and so on, described instead of stored. Point
+ * (i, j, k) has index (i * dims[1] + j) * dims[2] + k, so z varies
+ * fastest. */
+struct StructuredGrid {
+  /* Points along each edge of a cubic tile; a tile is one batch of the
+   * field kernel */
+  static constexpr size_t TILE_EDGE = 4;
+  static constexpr size_t TILE_POINTS = TILE_EDGE * TILE_EDGE * TILE_EDGE;
+
+  using TileIndices = std::array<size_t, TILE_POINTS>;
+
+  Eigen::Vector3d origin{0, 0, 0};
+  Eigen::Vector3d spacing{0, 0, 0};
+  std::array<size_t, 3> dims{0, 0, 0};
+
+  [[nodiscard]] inline size_t size() const noexcept {
+    return dims[0] * dims[1] * dims[2];
+  }
+
+  [[nodiscard]] inline Eigen::Vector3d point(size_t i, size_t j,
+                                             size_t k) const noexcept {
+    return origin + Eigen::Vector3d{static_cast<double>(i) * spacing[0],
+                                    static_cast<double>(j) * spacing[1],
+                                    static_cast<double>(k) * spacing[2]};
+  }
+
+  [[nodiscard]] inline Eigen::Vector3d point(size_t index) const noexcept {
+    const size_t k = index % dims[2];
+    const size_t j = (index / dims[2]) % dims[1];
+    return point(index / (dims[1] * dims[2]), j, k);
+  }
+
+  /* Every point, in index order */
+  [[nodiscard]] inline std::vector<Eigen::Vector3d> points() const {
+    std::vector<Eigen::Vector3d> result;
+    result.reserve(size());
+    for (size_t i = 0; i < dims[0]; i++) {
+      for (size_t j = 0; j < dims[1]; j++) {
+        for (size_t k = 0; k < dims[2]; k++) {
+          result.push_back(point(i, j, k));
+        }
+      }
+    }
+    return result;
+  }
+
+  /* Number of cubic tiles of TILE_EDGE points a side covering the grid;
+   * those on the far faces are cut short */
+  [[nodiscard]] inline size_t tiles() const noexcept {
+    return tilesAlong_(0) * tilesAlong_(1) * tilesAlong_(2);
+  }
+
+  /* Writes the indices of the points of tile t and returns how many */
+  inline size_t tile(const size_t t, TileIndices& indices) const noexcept {
+    const size_t tk = t % tilesAlong_(2);
+    const size_t tj = (t / tilesAlong_(2)) % tilesAlong_(1);
+    const size_t ti = t / (tilesAlong_(1) * tilesAlong_(2));
+    const auto end = [this](size_t axis, size_t first) {
+      return std::min(first + TILE_EDGE, dims[axis]);
+    };
+
+    size_t count = 0;
+    for (size_t i = ti * TILE_EDGE; i < end(0, ti * TILE_EDGE); i++) {
+      for (size_t j = tj * TILE_EDGE; j < end(1, tj * TILE_EDGE); j++) {
+        for (size_t k = tk * TILE_EDGE; k < end(2, tk * TILE_EDGE); k++) {
+          indices[count++] = (i * dims[1] + j) * dims[2] + k;
+        }
+      }
+    }
+    return count;
+  }
+
+ private:
+  [[nodiscard]] inline size_t tilesAlong_(size_t axis) const noexcept {
+    return (dims[axis] + TILE_EDGE - 1) / TILE_EDGE;
+  }
+};
+}  // namespace cpet
+#endif  // STRUCTUREDGRID_H
@@ -6,6 +6,7 @@
 
 /* C++ STL HEADER FILES */
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -17,9 +18,19 @@
 #include <Eigen/Dense>
 
 /* CPET HEADER FILES */
-#include "Option.h"
+#include "ChargeGroups.h"
+#include "Device.h"
+#include "FieldEvaluator.h"
+#include "FieldGrid.h"
+#include "FieldSolver.h"
+#include "GpuField.h"
+#include "Integrator.h"
+#include "Octree.h"
 #include "PointCharge.h"
-#include "TopologyRegion.h"
+#include "PointChargeStore.h"
+#include "Random.h"
+#include "StructuredGrid.h"
+#include "ThreadPool.h"
 #include "Utilities.h"
 #include "Volume.h"
 #include "Frame.h"
@@ -29,18 +40,118 @@ namespace cpet {
 
 class System {
  public:
-  System(Frame frame, const Option& options);
+  /* The user space of frame is centered at center, with the orthonormal
+   * basis as columns; transformToUserSpace() moves the coordinates there.
+   * Barnes-Hut solvers use an octree only if useOctree, and fall back to
+   * direct summation otherwise. */
+  explicit System(Frame frame,
+                  const Eigen::Vector3d& center = Eigen::Vector3d::Zero(),
+                  const Eigen::Matrix3d& basis = Eigen::Matrix3d::Identity(),
+                  bool useOctree = false);
+
+  /* As above, moved to user space as after transformToUserSpace() and
+   * useDevice(device), with the charge arrays, octree and device copy built
+   * once, from the final coordinates */
+  [[nodiscard]] static System inUserSpace(Frame frame,
+                                          const Eigen::Vector3d& center,
+                                          const Eigen::Matrix3d& basis,
+                                          bool useOctree, const Device& device);
+
+  /* Orthonormal basis whose first vector is along direction1 and whose
+   * second lies in the plane of direction1 and direction2; throws
+   * cpet::value_error if they are parallel */
+  [[nodiscard]] static Eigen::Matrix3d orthonormalBasis(
+      const Eigen::Vector3d& direction1, const Eigen::Vector3d& direction2);
 
   [[nodiscard]] Eigen::Vector3d electricFieldAt(
       const Eigen::Vector3d& position) const;
 
+  [[nodiscard]] Eigen::Vector3d electricFieldAt(
+      const Eigen::Vector3d& position, const FieldSolver& solver) const;
+
+  [[nodiscard]] std::vector<Eigen::Vector3d> electricFieldAt(
+      const std::vector<Eigen::Vector3d>& positions) const;
+
+  [[nodiscard]] std::vector<Eigen::Vector3d> electricFieldAt(
+      const std::vector<Eigen::Vector3d>& positions,
+      const FieldSolver& solver) const;
+
+  /* As above, split across pool; multipole solvers are expanded about
+   * region. On a GPU every charge is summed, whatever the solver. */
+  [[nodiscard]] std::vector<Eigen::Vector3d> electricFieldAt(
+      const std::vector<Eigen::Vector3d>& positions, const FieldSolver& solver,
+      const Volume& region, util::ThreadPool& pool) const;
+
+  /* Number of charge sets of the topology; the first is the one every
+   * other field method and topology sampling use */
+  [[nodiscard]] inline size_t chargeSets() const noexcept {
+    return frame_.topology().chargeSets().size();
+  }
+
+  /* Fields of every charge set at positions, summed directly on the CPU:
+   * results[i * chargeSets() + set] */
+  [[nodiscard]] std::vector<Eigen::Vector3d> electricFieldsAt(
+      const std::vector<Eigen::Vector3d>& positions) const;
+
+  /* As above, split across pool */
+  [[nodiscard]] std::vector<Eigen::Vector3d> electricFieldsAt(
+      const std::vector<Eigen::Vector3d>& positions,
+      util::ThreadPool& pool) const;
+
+  /* Field of every group of charges at positions, summed directly with the
+   * first charge set: results[i * groups.size() + group]. The groups sum to
+   * electricFieldAt(positions). */
+  [[nodiscard]] std::vector<Eigen::Vector3d> groupFieldsAt(
+      const std::vector<Eigen::Vector3d>& positions,
+      const ChargeGroups& groups) const;
+
+  /* Resolves solver against this system. Solvers that depend on the sampling
+   * region (multipole) fall back to direct summation without one. */
+  [[nodiscard]] FieldEvaluator fieldEvaluator(const FieldSolver& solver) const;
+
+  [[nodiscard]] FieldEvaluator fieldEvaluator(const FieldSolver& solver,
+                                              const Volume& region) const;
+
+  /* Called with each batch of samples as soon as it is done; returning
+   * false stops the sampling after that batch */
+  using SampleBatchCallback =
+      std::function<bool(const std::vector<PathSample>&)>;
+
+  /* Samples in batches of batchSize, or all at once if it is 0, passing
+   * every batch to onBatch. Fewer than numberOfSamples are returned if
+   * onBatch stops early. Sample i draws its random numbers from
+   * stream.at(i), so the samples do not depend on the number of threads.
+   * On a GPU the field is summed directly, so solver and interpolation do
+   * not apply, and the volume must be a box. */
   [[nodiscard]] std::vector<PathSample> electricFieldTopologyIn(
-      int numOfThreads, const Volume& volume, const double stepsize,
-      const int numberOfSamples) const;
+      util::ThreadPool& pool, const Volume& volume, const double stepsize,
+      const int numberOfSamples, const FieldSolver& solver = FieldSolver{},
+      const GridInterpolation& interpolation = GridInterpolation{},
+      const Integrator& integrator = Integrator{},
+      const util::SampleStream& stream = util::SampleStream{},
+      size_t batchSize = 0, const SampleBatchCallback& onBatch = nullptr) const;
+
+  /* Tabulates the field given by solver over the bounding box of region,
+   * grown by padding, and estimates the interpolation error against solver
+   * at cell centers */
+  [[nodiscard]] FieldGrid fieldGrid(const FieldSolver& solver,
+                                    const Volume& region,
+                                    const GridInterpolation& interpolation,
+                                    double padding,
+                                    util::ThreadPool& pool) const;
+
+  /* Uploads the charges of the frame once if device is a GPU, which then
+   * computes its fields and streamlines */
+  inline void useDevice(const Device& device) {
+    gpuCharges_ = device.gpu()
+                      ? std::make_shared<const gpu::Charges>(chargeStore_)
+                      : nullptr;
+  }
 
   inline void transformToUserSpace() {
     translateSystemToCenter_();
     transformToUserBasis_();
+    buildChargeStore_();
   }
 
   [[nodiscard]] inline Eigen::Vector3d transformToUserSpace(
@@ -61,37 +172,63 @@ class System {
     return basisMatrix_;
   }
 
+  /* Field at the points of grid, with solver expanded about region; with
+   * several charge sets, every set's, interleaved as by electricFieldsAt
+   * and summed directly */
   [[nodiscard]] std::vector<Eigen::Vector3d> computeElectricFieldIn(
-      const EFieldVolume& volume) const noexcept;
+      const StructuredGrid& grid, const FieldSolver& solver,
+      const Volume& region, util::ThreadPool& pool) const;
 
   [[nodiscard]] constexpr const Frame& frame() const noexcept { return frame_; }
 
- private:
-  static inline void constructOrthonormalBasis_(
-      std::array<Eigen::Vector3d, 3>& basis) noexcept {
-    SPDLOG_DEBUG("Constructing orthonormal basis...");
-    basis[2] = basis[0].cross(basis[1]);
-    basis[1] = basis[2].cross(basis[0]);
-
-    basis[2] = basis[2] / basis[2].norm();
-    basis[1] = basis[1] / basis[1].norm();
+  [[nodiscard]] inline const PointChargeStore& chargeStore() const noexcept {
+    return chargeStore_;
   }
 
-  [[nodiscard]] double curvatureAt_(const Eigen::Vector3d& alpha_0,
-                                    double stepSize) const noexcept;
+ private:
+  /* Selects the constructor that leaves the charge arrays to the caller */
+  struct Deferred {};
+
+  System(Frame frame, const Eigen::Vector3d& center,
+         const Eigen::Matrix3d& basis, bool useOctree, Deferred);
 
-  [[nodiscard]] PathSample sampleElectricFieldTopologyIn_(
-      const Volume& region, double stepSize) const noexcept;
+  /* Only the charged atoms of the topology contribute to the field */
+  inline void buildChargeStore_() {
+    const auto& topology = frame_.topology();
+    chargeStore_.clear();
+    chargeStore_.reserve(topology.chargedAtoms().size());
+    for (const auto atom : topology.chargedAtoms()) {
+      chargeStore_.push_back(frame_[atom], topology.charges()[atom]);
+    }
+    if (chargeSets() > 1) {
+      const auto& sets = topology.chargeSets();
+      chargeSetStore_ = ChargeSetStore{sets.size()};
+      chargeSetStore_.reserve(topology.chargedAtomsOfAnySet().size());
+      std::vector<double> charges(sets.size());
+      for (const auto atom : topology.chargedAtomsOfAnySet()) {
+        for (size_t set = 0; set < sets.size(); set++) {
+          charges[set] = sets[set][atom];
+        }
+        chargeSetStore_.push_back(frame_[atom], charges.data());
+      }
+    }
+    if (useOctree_) {
+      SPDLOG_DEBUG("Building Barnes-Hut octree...");
+      octree_ = Octree(chargeStore_);
+    }
+    if (gpuCharges_ != nullptr) {
+      gpuCharges_ = std::make_shared<const gpu::Charges>(chargeStore_);
+    }
+  }
 
-  inline void forEachPointCharge_(
-      const std::function<void(PointCharge&)>& func) {
-    std::for_each(pointCharges_.begin(), pointCharges_.end(), func);
+  inline void forEachCoordinate_(
+      const std::function<void(Eigen::Vector3d&)>& func) {
     std::for_each(frame_.begin(), frame_.end(), func);
   }
 
   inline void translateSystemTo_(const Eigen::Vector3d& position) {
-    forEachPointCharge_(
-        [&position](PointCharge& pc) { pc.coordinate -= position; });
+    forEachCoordinate_(
+        [&position](Eigen::Vector3d& coordinate) { coordinate -= position; });
   }
 
   inline void translateSystemToCenter_() {
@@ -111,27 +248,25 @@ class System {
     Eigen::Matrix3d inverse = basisMatrix_.inverse();
     SPDLOG_DEBUG("[User Basis]");
     SPDLOG_DEBUG(inverse);
-    forEachPointCharge_([&inverse](PointCharge& pc) {
-      pc.coordinate = inverse * pc.coordinate;
+    forEachCoordinate_([&inverse](Eigen::Vector3d& coordinate) {
+      coordinate = inverse * coordinate;
     });
   }
 
   [[maybe_unused]] inline void transformToDefaultBasis_() {
     SPDLOG_DEBUG("Translating to default basis");
-    forEachPointCharge_([this](PointCharge& pc) {
-      pc.coordinate = basisMatrix_ * pc.coordinate;
+    forEachCoordinate_([this](Eigen::Vector3d& coordinate) {
+      coordinate = basisMatrix_ * coordinate;
     });
   }
 
-  [[nodiscard]] inline Eigen::Vector3d nextPoint_(
-      const Eigen::Vector3d& pos, const double stepSize) const noexcept {
-    Eigen::Vector3d f = electricFieldAt(pos);
-    f /= f.norm();
-    return (pos + stepSize * f);
-  }
-
   Frame frame_;
-  std::vector<PointCharge> pointCharges_;
+  PointChargeStore chargeStore_;
+  /* Every charge set, when the topology has more than one */
+  ChargeSetStore chargeSetStore_;
+  bool useOctree_{false};
+  Octree octree_;
+  std::shared_ptr<const gpu::Charges> gpuCharges_{nullptr};
   Eigen::Vector3d center_;
   Eigen::Matrix3d basisMatrix_;
 };
@@ -0,0 +1,175 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "RAIIThread.h"
+
+namespace cpet {
+namespace util {
+
+/* Persistent work-stealing pool. Every thread owns a deque of tasks: it
+ * pops the newest task from its own deque and, when that is empty, steals
+ * the oldest task from another. The thread calling parallelFor takes part in
+ * the work, so a pool of size n starts n - 1 workers. */
+class ThreadPool {
+ public:
+  explicit ThreadPool(int numberOfThreads = 1);
+
+  ThreadPool(const ThreadPool&) = delete;
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  /* Number of threads that run tasks, including the caller of parallelFor */
+  [[nodiscard]] inline size_t size() const noexcept { return queues_.size(); }
+
+  /* Calls func(begin, end, thread) over [0, count) in chunks of at most
+   * chunkSize and blocks until every chunk is done. thread is in [0, size())
+   * and is the index of the thread running the chunk, so buffers indexed by
+   * it need no locking. The first exception thrown by a chunk is rethrown
+   * here once all chunks have finished. func may itself call parallelFor,
+   * but while it waits there its thread runs other chunks, of this call or
+   * any other, under the same index: a chunk must not keep using a buffer
+   * indexed by thread across a nested parallelFor. Tasks should only be
+   * submitted from one thread outside the pool at a time, since all such
+   * threads share an index. */
+  template <class Function>
+  void parallelFor(size_t count, size_t chunkSize, Function&& func) {
+    if (count == 0) {
+      return;
+    }
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    const size_t self = currentThread_();
+    if (size() == 1 || chunks == 1) {
+      func(size_t{0}, count, self);
+      return;
+    }
+
+    Completion done{chunks};
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+      const size_t begin = chunk * chunkSize;
+      const size_t end = std::min(count, begin + chunkSize);
+      push_((self + chunk) % size(), [this, &func, &done, begin, end]() {
+        try {
+          func(begin, end, currentThread_());
+        } catch (...) {
+          done.fail(std::current_exception());
+        }
+        done.finish();
+      });
+    }
+    wakeWorkers_();
+
+    while (!done.finished()) {
+      if (!runOne_(self)) {
+        done.waitFor(IDLE_WAIT);
+      }
+    }
+    done.rethrow();
+  }
+
+  /* Chunk size that gives every thread several chunks of [0, count) to
+   * balance uneven work */
+  [[nodiscard]] inline size_t chunkSizeFor(size_t count) const noexcept {
+    constexpr size_t CHUNKS_PER_THREAD = 8;
+    return std::max<size_t>(1, count / (size() * CHUNKS_PER_THREAD));
+  }
+
+ private:
+  using Task = std::function<void()>;
+
+  /* How long a thread with nothing to steal waits before looking again */
+  static constexpr std::chrono::microseconds IDLE_WAIT{200};
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /* Tracks the chunks of one parallelFor call */
+  class Completion {
+   public:
+    explicit inline Completion(size_t count) noexcept : remaining_(count) {}
+
+    inline void finish() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--remaining_ == 0) {
+        finished_.notify_all();
+      }
+    }
+
+    inline void fail(std::exception_ptr error) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::move(error);
+      }
+    }
+
+    [[nodiscard]] inline bool finished() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return remaining_ == 0;
+    }
+
+    inline void waitFor(std::chrono::microseconds duration) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished_.wait_for(lock, duration, [this] { return remaining_ == 0; });
+    }
+
+    inline void rethrow() {
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    size_t remaining_;
+    std::exception_ptr error_{nullptr};
+  };
+
+  /* One deque per worker and a last one shared by outside callers */
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<RAIIThread> workers_;
+
+  std::atomic<bool> stop_{false};
+  std::atomic<size_t> queued_{0};
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+
+  void push_(size_t queue, Task task);
+
+  void wakeWorkers_();
+
+  /* Runs one task from thread's own deque or stolen from another; false if
+   * every deque was empty */
+  bool runOne_(size_t thread);
+
+  void workerLoop_(size_t thread);
+
+  /* Index of the calling thread in this pool; outside callers get the last
+   * index */
+  [[nodiscard]] size_t currentThread_() const noexcept;
+};
+
+}  // namespace util
+}  // namespace cpet
+#endif  // THREADPOOL_H
@@ -0,0 +1,131 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "AtomTable.h"
+#include "Exceptions.h"
+
+namespace cpet {
+
+/* Everything about the atoms of a trajectory except where they are: IDs,
+ * charges and which atoms carry charge. Loaded once and shared by every
+ * frame, which only stores coordinates. A topology may carry several charge
+ * sets for the same atoms (e.g. one per force field); the first is the one
+ * charges() returns and the only one topology sampling uses. */
+class Topology {
+ public:
+  using index_type = AtomTable::index_type;
+
+  Topology() = default;
+
+  inline Topology(AtomTable atoms, std::vector<double> charges)
+      : atoms_(std::move(atoms)) {
+    if (atoms_.size() != charges.size()) {
+      throw cpet::value_error(
+          "Inconsistent number of atom IDs and charges in topology");
+    }
+    chargeSets_.front() = std::move(charges);
+    buildChargedAtoms_();
+  }
+
+  /* Same atoms with other charges, e.g. from a separate charge file */
+  [[nodiscard]] inline Topology withCharges(
+      std::vector<double> charges) const {
+    std::vector<std::vector<double>> sets;
+    sets.push_back(std::move(charges));
+    return withChargeSets(std::move(sets));
+  }
+
+  /* Same atoms with one or more charge sets, e.g. one per charge file */
+  [[nodiscard]] inline Topology withChargeSets(
+      std::vector<std::vector<double>> sets) const {
+    if (sets.empty()) {
+      throw cpet::value_error("A topology needs at least one charge set");
+    }
+    for (const auto& charges : sets) {
+      if (size() != charges.size()) {
+        SPDLOG_ERROR("Structure size: {}, number of charges: {}", size(),
+                     charges.size());
+        throw cpet::value_error(
+            "Inconsistent number of point charges in trajectory and in "
+            "charge file");
+      }
+    }
+    Topology result{*this};
+    result.chargeSets_ = std::move(sets);
+    result.buildChargedAtoms_();
+    return result;
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return atoms_.size(); }
+
+  [[nodiscard]] inline const AtomTable& atoms() const noexcept {
+    return atoms_;
+  }
+
+  [[nodiscard]] inline const std::vector<double>& charges() const noexcept {
+    return chargeSets_.front();
+  }
+
+  [[nodiscard]] inline const std::vector<std::vector<double>>& chargeSets()
+      const noexcept {
+    return chargeSets_;
+  }
+
+  /* Atoms with a nonzero charge in the first set, in order. The rest add
+   * nothing to its field. */
+  [[nodiscard]] inline const std::vector<index_type>& chargedAtoms()
+      const noexcept {
+    return chargedAtoms_;
+  }
+
+  /* Atoms with a nonzero charge in any set, in order */
+  [[nodiscard]] inline const std::vector<index_type>& chargedAtomsOfAnySet()
+      const noexcept {
+    return chargeSets_.size() > 1 ? anySetChargedAtoms_ : chargedAtoms_;
+  }
+
+  [[nodiscard]] inline std::optional<index_type> find(
+      const AtomID& id) const {
+    return atoms_.find(id);
+  }
+
+ private:
+  AtomTable atoms_;
+  /* Never empty */
+  std::vector<std::vector<double>> chargeSets_ =
+      std::vector<std::vector<double>>(1);
+  std::vector<index_type> chargedAtoms_;
+  std::vector<index_type> anySetChargedAtoms_;
+
+  inline void buildChargedAtoms_() {
+    chargedAtoms_.clear();
+    anySetChargedAtoms_.clear();
+    for (size_t i = 0; i < size(); i++) {
+      const auto index = static_cast<index_type>(i);
+      if (chargeSets_.front()[i] != 0.0) {
+        chargedAtoms_.push_back(index);
+      }
+      if (chargeSets_.size() > 1 &&
+          std::any_of(chargeSets_.begin(), chargeSets_.end(),
+                      [i](const auto& set) { return set[i] != 0.0; })) {
+        anySetChargedAtoms_.push_back(index);
+      }
+    }
+  }
+};
+}  // namespace cpet
+#endif  // TOPOLOGY_H
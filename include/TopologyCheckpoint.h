@@ -0,0 +1,61 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef TOPOLOGYCHECKPOINT_H
+#define TOPOLOGYCHECKPOINT_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "PathSample.h"
+
+namespace cpet {
+
+/* Append-only record of the topology samples computed so far, so a run
+ * that is killed can resume where it stopped. Every batch of samples is
+ * appended with its frame index and flushed. A record cut short by the
+ * kill is dropped when the file is opened again. */
+class TopologyCheckpoint {
+ public:
+  /* Loads what an earlier run with the same key recorded in file, or
+   * starts the file. The key describes the sampling; a file written with
+   * another key is rejected rather than mixed with new samples. */
+  TopologyCheckpoint(std::string file, const std::string& key);
+
+  TopologyCheckpoint(const TopologyCheckpoint&) = delete;
+
+  TopologyCheckpoint& operator=(const TopologyCheckpoint&) = delete;
+
+  /* Removes and returns the samples recorded for frame */
+  [[nodiscard]] std::vector<PathSample> take(size_t frame);
+
+  /* Appends samples of frame; safe to call from several threads */
+  void record(size_t frame, const std::vector<PathSample>& samples);
+
+  /* Number of frames with samples loaded from an earlier run */
+  [[nodiscard]] inline size_t loadedFrames() const noexcept {
+    return loaded_.size();
+  }
+
+  [[nodiscard]] inline const std::string& file() const noexcept {
+    return file_;
+  }
+
+ private:
+  std::string file_;
+  std::unordered_map<size_t, std::vector<PathSample>> loaded_;
+  std::mutex mutex_;
+  std::ofstream out_;
+
+  /* Reads the records of an existing file and returns the end of the last
+   * complete one */
+  size_t load_(const std::string& key);
+};
+}  // namespace cpet
+#endif  // TOPOLOGYCHECKPOINT_H
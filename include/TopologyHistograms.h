@@ -0,0 +1,71 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef TOPOLOGYHISTOGRAMS_H
+#define TOPOLOGYHISTOGRAMS_H
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <optional>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Histogram2D.h"
+#include "PathSample.h"
+#include "ThreadPool.h"
+
+namespace cpet {
+
+/* Distance and curvature limits of topology histograms */
+struct HistogramLimits {
+  std::array<double, 2> distance;
+  std::array<double, 2> curvature;
+};
+
+/* One distance-curvature histogram per frame, filled as frames are
+ * sampled. With fixed limits a frame is binned as soon as it is added and
+ * its samples are dropped. Without, the limits span every sample of every
+ * frame, so the samples are kept until finish() bins them, and only their
+ * running range is tracked meanwhile. */
+class TopologyHistograms {
+ public:
+  TopologyHistograms(const std::array<int, 2>& bins,
+                     std::optional<HistogramLimits> limits);
+
+  /* Adds the samples of the next frame, binning them on pool if the limits
+   * are fixed */
+  void add(std::vector<PathSample> samples, util::ThreadPool& pool);
+
+  [[nodiscard]] inline size_t size() const noexcept {
+    return binned_.size() + pending_.size();
+  }
+
+  /* Limits of the histograms: the fixed ones, or the running range of the
+   * samples added so far rounded to 1e-3 */
+  [[nodiscard]] HistogramLimits limits() const;
+
+  /* Bins every frame with limits instead of the running range, if that
+   * range, merged over the MPI ranks, lies within them; otherwise returns
+   * false and keeps the running range. With fixed limits, only returns
+   * whether they are limits. Every rank calls it. */
+  [[nodiscard]] bool adoptLimits(const HistogramLimits& limits);
+
+  /* The normalized histogram of every frame, one row per frame in order.
+   * In an MPI run every rank calls it, and the histograms of the samples
+   * of every rank are returned on the root only. */
+  [[nodiscard]] histo::HistogramMatrix finish(util::ThreadPool& pool);
+
+ private:
+  std::array<int, 2> bins_;
+  std::optional<HistogramLimits> limits_;
+  std::vector<histo::Histogram2D64> binned_;
+  std::vector<std::vector<PathSample>> pending_;
+  histo::Range distanceRange_;
+  histo::Range curvatureRange_;
+
+  [[nodiscard]] histo::Histogram2D64 bin_(
+      const std::vector<PathSample>& samples, const HistogramLimits& limits,
+      util::ThreadPool& pool) const;
+};
+}  // namespace cpet
+#endif  // TOPOLOGYHISTOGRAMS_H
@@ -5,19 +5,34 @@
 #define TOPOLOGYREGION_H
 
 /* C++ STL HEADER FILES */
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <utility>
 #include <vector>
 
 /* CPET HEADER FILES */
+#include "AsyncWriter.h"
+#include "DistanceMatrix.h"
+#include "FieldGrid.h"
+#include "FieldSolver.h"
+#include "Integrator.h"
+#include "OutputFormat.h"
 #include "Volume.h"
 #include "PathSample.h"
+#include "SampleConvergence.h"
+#include "ThreadPool.h"
+#include "TopologyCheckpoint.h"
+#include "TopologyHistograms.h"
 
 namespace cpet {
 
 constexpr double DEFAULT_STEP_SIZE = 0.001;
+constexpr int DEFAULT_CHECKPOINT_INTERVAL = 10000;
+/* Runs without a seed key draw the same samples every time */
+constexpr uint64_t DEFAULT_SEED = 0;
 
 class System;
 
@@ -35,8 +50,32 @@ class TopologyRegion {
            "; Volume: " + volume_->description();
   }
 
-  void computeTopologyWith(const std::vector<System>& systems,
-                           int numberOfThreads) const;
+  /* Samples a window of consecutive frames and queues their sample files
+   * on writer. firstFrame is the trajectory index of systems[0] and numbers
+   * the sample files. The samples are only returned if computeMatrix().
+   * With a checkpoint, samples it holds for a frame are reused and new
+   * ones are recorded in it every checkpointInterval() samples, or after
+   * every batch with a converge key. */
+  [[nodiscard]] std::vector<std::vector<PathSample>> sampleTopologyWith(
+      const std::vector<System>& systems, util::ThreadPool& pool,
+      util::AsyncWriter& writer, size_t firstFrame,
+      TopologyCheckpoint* checkpoint = nullptr) const;
+
+  /* The checkpoint named by the checkpoint key, holding what an earlier
+   * run recorded in it; nullptr if there is none. input describes the
+   * trajectory and frames sampled; a checkpoint written for other input or
+   * options is rejected. */
+  [[nodiscard]] std::unique_ptr<TopologyCheckpoint> openCheckpoint(
+      const std::string& input) const;
+
+  /* Empty per-frame histograms to add the samples of each window to */
+  [[nodiscard]] TopologyHistograms histograms() const;
+
+  /* Distance matrix over the histograms of every frame, or over the
+   * sampleInput files in analysis-only mode. With a histogram cache, only
+   * the files past the cached frames are loaded and compared. */
+  void analyzeTopology(TopologyHistograms histograms,
+                       util::ThreadPool& pool) const;
 
   [[nodiscard]] constexpr bool computeMatrix() const noexcept {
     return static_cast<bool>(bins_);
@@ -52,6 +91,19 @@ class TopologyRegion {
 
   [[nodiscard]] constexpr double stepSize() const noexcept { return stepSize_; }
 
+  [[nodiscard]] constexpr const FieldSolver& solver() const noexcept {
+    return solver_;
+  }
+
+  [[nodiscard]] constexpr const GridInterpolation& interpolation()
+      const noexcept {
+    return interpolation_;
+  }
+
+  [[nodiscard]] constexpr const Integrator& integrator() const noexcept {
+    return integrator_;
+  }
+
   inline void sampleOutput(const std::string& str) noexcept {
     if (!str.empty()) {
       sampleOutput_ = str;
@@ -63,6 +115,10 @@ class TopologyRegion {
     return sampleOutput_;
   }
 
+  [[nodiscard]] constexpr const OutputFormat& sampleFormat() const noexcept {
+    return sampleFormat_;
+  }
+
   inline void sampleInput(const std::string& str) noexcept {
     if (!str.empty()) {
       sampleInput_ = str;
@@ -80,6 +136,45 @@ class TopologyRegion {
     }
   }
 
+  [[nodiscard]] constexpr const std::optional<std::string>& matrixOutput()
+      const noexcept {
+    return matrixOutput_;
+  }
+
+  /* Write only the upper triangle of the symmetric distance matrix */
+  inline void packedMatrix(const bool packed) noexcept {
+    packedMatrix_ = packed;
+  }
+
+  [[nodiscard]] constexpr bool packedMatrix() const noexcept {
+    return packedMatrix_;
+  }
+
+  /* File caching the histograms and distances of the sampleInput frames */
+  [[nodiscard]] constexpr const std::optional<std::string>& histogramCache()
+      const noexcept {
+    return histogramCache_;
+  }
+
+  [[nodiscard]] constexpr const std::optional<std::string>& checkpoint()
+      const noexcept {
+    return checkpoint_;
+  }
+
+  [[nodiscard]] constexpr int checkpointInterval() const noexcept {
+    return checkpointInterval_;
+  }
+
+  /* Set if every frame draws samples until its histogram converges,
+   * numberOfSamples() at most */
+  [[nodiscard]] constexpr const std::optional<SampleConvergence>&
+  convergence() const noexcept {
+    return convergence_;
+  }
+
+  /* Seed of the random start points and path lengths of the samples */
+  [[nodiscard]] constexpr uint64_t seed() const noexcept { return seed_; }
+
   [[nodiscard]] constexpr const std::optional<std::array<int, 2>>& bins()
       const noexcept {
     return bins_;
@@ -95,22 +190,39 @@ class TopologyRegion {
   std::unique_ptr<Volume> volume_{nullptr};
   int numberOfSamples_;
   double stepSize_{DEFAULT_STEP_SIZE};
+  FieldSolver solver_{};
+  GridInterpolation interpolation_{};
+  Integrator integrator_{};
   std::optional<std::string> sampleOutput_{std::nullopt};
+  OutputFormat sampleFormat_{};
   std::optional<std::string> sampleInput_{std::nullopt};
   std::optional<std::string> matrixOutput_{std::nullopt};
+  std::optional<std::string> histogramCache_{std::nullopt};
+  bool packedMatrix_{false};
   std::optional<std::array<int, 2>> bins_{std::nullopt};
+  /* Fixed histogram limits; by default they span every sample */
+  std::optional<HistogramLimits> limits_{std::nullopt};
+  std::optional<std::string> checkpoint_{std::nullopt};
+  int checkpointInterval_{DEFAULT_CHECKPOINT_INTERVAL};
+  uint64_t seed_{DEFAULT_SEED};
+  std::optional<SampleConvergence> convergence_{std::nullopt};
+
+  /* Parses converge <tolerance> [minSamples [batchSize]] */
+  [[nodiscard]] static SampleConvergence convergenceFromOptions_(
+      const std::vector<std::string>& options);
 
   void writeSampleOutput_(const std::vector<PathSample>& data, int index) const;
 
-  void writeMatrixOutput_(const std::vector<std::vector<double>>& matrix) const;
-
-  [[nodiscard]] std::vector<std::vector<PathSample>> loadSampleData_() const;
+  void writeMatrixOutput_(const histo::DistanceMatrix& matrix) const;
 
-  [[nodiscard]] std::vector<std::vector<double>> constructHistograms_(
-      const std::vector<std::vector<PathSample>>& sampleData) const;
+  /* Adds the frames of the sampleInput files from index firstFile on to
+   * histograms */
+  void loadSampleData_(TopologyHistograms& histograms, util::ThreadPool& pool,
+                       size_t firstFile) const;
 
-  [[nodiscard]] static std::vector<std::vector<double>> constructMatrix_(
-      const std::vector<std::vector<double>>& histograms);
+  /* Reads a sample file written in the binary sample format */
+  [[nodiscard]] static std::vector<PathSample> loadBinarySamples_(
+      std::string_view data);
 };
 }  // namespace cpet
 #endif  // TOPOLOGYREGION_H
@@ -0,0 +1,109 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Constants.h"
+#include "Frame.h"
+#include "PointCharge.h"
+#include "Topology.h"
+#include "MappedFile.h"
+
+namespace cpet {
+
+/* Reads the frames of a trajectory one at a time, so only the frames being
+ * worked on are held in memory. Frames are selected the same way for every
+ * format: the start-th structure and every step-th one after it. */
+class TrajectoryReader {
+ public:
+  TrajectoryReader() = default;
+
+  TrajectoryReader(const TrajectoryReader&) = delete;
+
+  TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+  virtual ~TrajectoryReader() = default;
+
+  /* Next selected frame, or std::nullopt once the trajectory is exhausted */
+  [[nodiscard]] virtual std::optional<Frame> next() = 0;
+
+  /* Up to count of the next selected frames; empty at the end */
+  [[nodiscard]] std::vector<Frame> next(size_t count);
+
+  /* Gives every frame these charges instead of those in the trajectory */
+  void replaceCharges(std::vector<double> charges);
+
+  /* As above with several charge sets, the first used for topology */
+  void replaceChargeSets(std::vector<std::vector<double>> sets);
+
+  /* Shared by every frame read so far; nullptr before the first */
+  [[nodiscard]] inline const std::shared_ptr<const Topology>& topology()
+      const noexcept {
+    return topology_;
+  }
+
+  /* Picks the reader from the file extension. Binary trajectories (.dcd,
+   * .xtc) hold only coordinates and need topology, which for text
+   * trajectories only replaces the charges (every set of them). */
+  [[nodiscard]] static std::unique_ptr<TrajectoryReader> open(
+      const std::string& file, int start, int step,
+      std::shared_ptr<const Topology> topology = nullptr);
+
+ protected:
+  inline TrajectoryReader(const int start, const int step)
+      : start_(start), step_(step) {
+    if (step_ < 1) {
+      throw cpet::value_error("Invalid trajectory step size");
+    }
+  }
+
+  /* Whether the structure with this index (counted from 0) is selected */
+  [[nodiscard]] constexpr bool selected(int index) const noexcept {
+    return index >= start_ && (index - start_) % step_ == 0;
+  }
+
+  /* Topology of the frames read from now on, with any replaced charges */
+  void setTopology(std::shared_ptr<const Topology> topology);
+
+  /* Index of the first selected structure and the distance to the next */
+  [[nodiscard]] constexpr int start() const noexcept { return start_; }
+
+  [[nodiscard]] constexpr int step() const noexcept { return step_; }
+
+ private:
+  int start_{0};
+  int step_{1};
+  std::shared_ptr<const Topology> topology_{nullptr};
+  std::optional<std::vector<std::vector<double>>> chargeSets_{std::nullopt};
+};
+
+/* Multi-model PDB or PQR file; models are separated by ENDMDL. The file is
+ * memory mapped and lines are parsed in place. The topology comes from the
+ * first selected model: later models are taken to list the same atoms with
+ * the same charges, so only their coordinates are kept. */
+class PDBTrajectoryReader : public TrajectoryReader {
+ public:
+  PDBTrajectoryReader(const std::string& file, constants::FileType type,
+                      int start, int step);
+
+  [[nodiscard]] std::optional<Frame> next() override;
+
+ private:
+  util::MappedFile file_;
+  util::LineScanner lines_;
+  constants::FileType type_;
+  int structureIndex_{0};
+  [[nodiscard]] PointCharge parse_(std::string_view line) const;
+};
+}  // namespace cpet
+#endif  // TRAJECTORYREADER_H
@@ -7,26 +7,18 @@
 /* C++ STL HEADER FILES */
 #include <fstream>
 #include <functional>
-#include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <optional>
 #include <algorithm>
 
 /* CPET HEADER FILES */
 #include "Exceptions.h"
 namespace cpet::util {
 
-[[nodiscard]] inline std::unique_ptr<std::mt19937>&
-randomNumberGenerator() noexcept {
-  static thread_local std::unique_ptr<std::mt19937> generator = nullptr;
-  if (generator == nullptr) {
-    generator = std::make_unique<std::mt19937>(std::random_device()());
-  }
-  return generator;
-}
-
 [[nodiscard]] inline std::string lstrip(const std::string_view str,
                                         const std::string_view escape = " \t") {
   auto strBegin = str.find_first_not_of(escape);
@@ -64,6 +56,41 @@ randomNumberGenerator() noexcept {
   return str.find(str2, str.size() - str2.size()) != std::string::npos;
 }
 
+/* View of str without leading and trailing blanks; never allocates */
+[[nodiscard]] constexpr std::string_view trim(
+    std::string_view str, const std::string_view escape = " \t") noexcept {
+  const auto strBegin = str.find_first_not_of(escape);
+  if (strBegin == std::string_view::npos) {
+    return {};
+  }
+  str.remove_prefix(strBegin);
+  return str.substr(0, str.find_last_not_of(escape) + 1);
+}
+
+/* Removes the next blank separated token from the front of rest and returns
+ * it; empty once rest has no tokens left */
+[[nodiscard]] constexpr std::string_view nextToken(
+    std::string_view& rest, const std::string_view escape = " \t") noexcept {
+  const auto tokenBegin = rest.find_first_not_of(escape);
+  if (tokenBegin == std::string_view::npos) {
+    rest = {};
+    return {};
+  }
+  rest.remove_prefix(tokenBegin);
+  const auto tokenEnd = std::min(rest.find_first_of(escape), rest.size());
+  const auto token = rest.substr(0, tokenEnd);
+  rest.remove_prefix(tokenEnd);
+  return token;
+}
+
+/* Parses the whole of str, ignoring surrounding blanks and allowing one
+ * leading '+', as a double without allocating; std::nullopt if it is not a
+ * number */
+[[nodiscard]] std::optional<double> toDouble(std::string_view str) noexcept;
+
+/* As toDouble, but throws cpet::value_error if str is not a number */
+[[nodiscard]] double parseDouble(std::string_view str);
+
 void forEachLineIn(const std::string& file,
                    const std::function<void(const std::string&)>& func);
 
@@ -5,6 +5,7 @@
 #define VOLUME_H
 
 /* C++ STL HEADER FILES */
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
@@ -12,6 +13,10 @@
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <Eigen/Dense>
 
+/* CPET HEADER FILES */
+#include "Random.h"
+#include "StructuredGrid.h"
+
 namespace cpet {
 class Volume {
  public:
@@ -32,17 +37,38 @@ class Volume {
 
   [[nodiscard]] virtual const double &maxDim() const noexcept = 0;
 
-  [[nodiscard]] virtual Eigen::Vector3d randomPoint() const = 0;
+  /* Radius of the smallest sphere about center() containing the volume */
+  [[nodiscard]] virtual double boundingRadius() const noexcept = 0;
+
+  /* Half widths of the smallest axis-aligned box about center() containing
+   * the volume */
+  [[nodiscard]] virtual Eigen::Vector3d halfExtents() const noexcept = 0;
+
+  [[nodiscard]] inline const Eigen::Vector3d &center() const noexcept {
+    return center_;
+  }
+
+  [[nodiscard]] virtual Eigen::Vector3d randomPoint(
+      util::SampleRandom &random) const = 0;
 
   [[nodiscard]] virtual std::string description() const noexcept(true) = 0;
 
-  [[nodiscard]] virtual int randomDistance(double stepSize) const noexcept = 0;
+  [[nodiscard]] virtual int randomDistance(
+      double stepSize, util::SampleRandom &random) const noexcept = 0;
 
   [[nodiscard]] virtual std::string type() const noexcept = 0;
 
-  [[nodiscard]] virtual std::vector<Eigen::Vector3d> partition(
+  /* Regular grid with density[axis] steps per half width along each axis,
+   * described by its origin, spacing and dimensions */
+  [[nodiscard]] virtual StructuredGrid grid(
       const std::array<int, 3> &density) const noexcept = 0;
 
+  /* Every point of grid(density) */
+  [[nodiscard]] inline std::vector<Eigen::Vector3d> partition(
+      const std::array<int, 3> &density) const {
+    return grid(density).points();
+  }
+
   static std::unique_ptr<Volume> generateVolume(
       const std::vector<std::string> &options);
 
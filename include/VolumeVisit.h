@@ -0,0 +1,26 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef VOLUMEVISIT_H
+#define VOLUMEVISIT_H
+
+/* CPET HEADER FILES */
+#include "Box.h"
+#include "Volume.h"
+
+namespace cpet {
+
+/* Calls visitor with region as its concrete shape, looked up once from
+ * type(), so that visitor can be a template whose per-step isInside and
+ * per-sample draws inline instead of going through the vtable. A shape
+ * made by Volume::generateVolume gets the same fast path by being listed
+ * here; any other is visited as a plain Volume. */
+template <class Visitor>
+decltype(auto) visitVolume(const Volume& region, Visitor&& visitor) {
+  if (region.type() == "box") {
+    return visitor(static_cast<const Box&>(region));
+  }
+  return visitor(region);
+}
+}  // namespace cpet
+#endif  // VOLUMEVISIT_H
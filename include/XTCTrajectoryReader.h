@@ -0,0 +1,52 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef XTCTRAJECTORYREADER_H
+#define XTCTRAJECTORYREADER_H
+
+/* C++ STL HEADER FILES */
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <Eigen/Dense>
+
+/* CPET HEADER FILES */
+#include "BinaryCursor.h"
+#include "Frame.h"
+#include "MappedFile.h"
+#include "Topology.h"
+#include "TrajectoryReader.h"
+
+namespace cpet {
+
+/* GROMACS XTC trajectory. Coordinates are stored compressed in nm and
+ * returned in Angstrom. Frames differ in size, but every frame records the
+ * length of its compressed coordinates, so skipped frames are stepped over
+ * without decompressing them. */
+class XTCTrajectoryReader : public TrajectoryReader {
+ public:
+  XTCTrajectoryReader(const std::string& file,
+                      std::shared_ptr<const Topology> topology, int start,
+                      int step);
+
+  [[nodiscard]] std::optional<Frame> next() override;
+
+ private:
+  util::MappedFile file_;
+  util::BinaryCursor cursor_;
+  size_t numberOfAtoms_{0};
+  int structureIndex_{0};
+
+  /* Reads the frame header up to the compressed coordinates */
+  void readHeader_();
+
+  void skipCoordinates_();
+
+  [[nodiscard]] std::vector<Eigen::Vector3d> readCoordinates_();
+};
+}  // namespace cpet
+#endif  // XTCTRAJECTORYREADER_H
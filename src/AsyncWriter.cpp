@@ -0,0 +1,84 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "AsyncWriter.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <utility>
+
+/* CPET HEADER FILES */
+#include "Instrumentation.h"
+
+namespace cpet {
+namespace util {
+
+AsyncWriter::AsyncWriter(const size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      thread_([this]() { run_(); }) {}
+
+AsyncWriter::~AsyncWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  changed_.notify_all();
+  /* RAIIThread joins once the queued jobs have run */
+}
+
+void AsyncWriter::submit(Job job) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this] { return jobs_.size() < capacity_ || error_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  jobs_.emplace_back(std::move(job));
+  lock.unlock();
+  changed_.notify_all();
+}
+
+void AsyncWriter::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void AsyncWriter::run_() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [this] { return !jobs_.empty() || stop_; });
+    if (jobs_.empty()) {
+      return;
+    }
+    auto job = std::move(jobs_.front());
+    jobs_.pop_front();
+    busy_ = true;
+    lock.unlock();
+    /* A slot is free for the next window */
+    changed_.notify_all();
+
+    std::exception_ptr error{nullptr};
+    try {
+      const ProfileStage stage{"write"};
+      job();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    busy_ = false;
+    if (error && !error_) {
+      error_ = std::move(error);
+    }
+    /* Later jobs may append to a file the failed one left incomplete */
+    if (error_) {
+      jobs_.clear();
+    }
+    changed_.notify_all();
+  }
+}
+
+}  // namespace util
+}  // namespace cpet
@@ -2,7 +2,9 @@
 // Distributed under the MIT License (http://opensource.org/licenses/MIT)
 
 /* C++ STL HEADER FILES */
+#include <filesystem>
 #include <fstream>
+#include <optional>
 
 /* EXTERNAL LIBRARY HEADER FILES */
 #include "spdlog/fmt/ostr.h"
@@ -11,7 +13,9 @@
 
 /* CPET HEADER FILES */
 #include "Calculator.h"
+#include "Cluster.h"
 #include "Exceptions.h"
+#include "GpuField.h"
 #include "Instrumentation.h"
 #include "System.h"
 #include "Utilities.h"
@@ -20,86 +24,175 @@
 namespace cpet {
 
 Calculator::Calculator(std::string proteinFile, const std::string& optionFile,
-                       std::string chargesFile, int nThreads)
+                       std::vector<std::string> chargesFiles, int nThreads,
+                       Device device)
     : proteinFile_(std::move(proteinFile)),
       option_(optionFile),
-      chargeFile_(std::move(chargesFile)),
-      numberOfThreads_(nThreads) {
-  loadPointChargeTrajectory_();
+      chargeFiles_(std::move(chargesFiles)),
+      device_(device),
+      plan_(option_, device_),
+      pool_(nThreads) {
+  if (device_.gpu() && !gpu::available()) {
+    throw cpet::value_error(
+        "No GPU available: cpet was built without CUDA or no device is "
+        "visible");
+  }
 }
 
 void Calculator::compute() {
-  if (!chargeFile_.empty()) {
-    fixCharges_();
+  const util::ProfileStage total{"total"};
+  const auto& regions = option_.calculateEFieldTopology();
+  const auto& fieldLocations = option_.calculateFieldLocations();
+  const auto& volumes = option_.calculateEFieldVolumes();
+  /* Only topology sampling is split over MPI ranks; the root computes the
+   * cheap per-frame analyses alone */
+  const bool root = util::Cluster::instance().root();
+  SPDLOG_INFO("[Plan]   ==>> {}", plan_.description());
+  if (device_.gpu()) {
+    SPDLOG_INFO("[Device] ==>> gpu: fields are summed directly, so solver "
+                "and interpolate options do not apply");
   }
-
-  createSystems_();
-  transformSystems_();
-
-  if (!option_.calculateEFieldTopology().empty()) {
-    computeTopology_();
+  if (chargeFiles_.size() > 1) {
+    SPDLOG_INFO("[Charges] ==>> {} charge sets: field and plot3d outputs "
+                "hold one column group per set, summed directly on the cpu; "
+                "topology samples use the first set",
+                chargeFiles_.size());
   }
-  if (!option_.calculateFieldLocations().empty()) {
-    computeEField_();
+
+  /* Only what the end-of-trajectory analyses need outlives a window */
+  std::vector<std::optional<TopologyHistograms>> topologyHistograms(
+      regions.size());
+  for (size_t i = 0; i < regions.size(); i++) {
+    if (regions[i].computeMatrix()) {
+      topologyHistograms[i] = regions[i].histograms();
+    }
   }
-  if (!option_.calculateEFieldVolumes().empty()) {
-    computeVolume_();
+  std::vector<std::vector<std::vector<Eigen::Vector3d>>> fieldResults;
+  fieldResults.reserve(fieldLocations.size());
+  for (const auto& locations : fieldLocations) {
+    fieldResults.emplace_back(locations.locations().size());
   }
-}
 
-void Calculator::computeTopology_() const {
-  std::for_each(option_.calculateEFieldTopology().begin(),
-                option_.calculateEFieldTopology().end(),
-                [&](const auto& region) {
-                  region.computeTopologyWith(systems_, numberOfThreads_);
-                });
-}
-
-void Calculator::computeEField_() const {
-  for (const auto& fieldLocations : option_.calculateFieldLocations()) {
-    fieldLocations.computeEFieldsWith(systems_);
+  /* Samples a killed run recorded are reused instead of drawn again */
+  std::vector<std::unique_ptr<TopologyCheckpoint>> checkpoints;
+  checkpoints.reserve(regions.size());
+  for (const auto& region : regions) {
+    checkpoints.emplace_back(region.openCheckpoint(checkpointInput_()));
   }
-}
 
-void Calculator::computeVolume_() const {
-  std::for_each(
-      option_.calculateEFieldVolumes().begin(),
-      option_.calculateEFieldVolumes().end(),
-      [this](const auto& volume) { volume.computeVolumeWith(systems_); });
-}
+  /* One frame per thread, since every stage runs the frames of a window
+   * concurrently */
+  /* The charges file replaces the charges of text trajectories once, on the
+   * shared topology, and is the whole topology of binary ones */
+  auto reader = TrajectoryReader::open(
+      proteinFile_, option_.coordinatesStartIndex(),
+      option_.coordinatesStepSize(),
+      chargeFiles_.empty() ? nullptr : loadChargesFiles_());
+  size_t firstFrame = 0;
+  size_t chargeSets = 1;
+  while (true) {
+    std::vector<Frame> frames;
+    {
+      const util::ProfileStage stage{"read"};
+      frames = reader->next(pool_.size());
+    }
+    util::Profiler::instance().add(util::Profiler::Counter::framesRead,
+                                   frames.size());
+    std::vector<System> systems;
+    {
+      const util::ProfileStage stage{"systems"};
+      systems = plan_.prepare(std::move(frames), pool_);
+    }
+    if (systems.empty()) {
+      break;
+    }
+    chargeSets = systems.front().chargeSets();
 
-std::vector<double> Calculator::loadChargesFile_() const {
-  SPDLOG_DEBUG("Loading charges from external file {} ...", chargeFile_);
-  std::vector<double> realCharges;
-  if (util::endswith(chargeFile_, ".pqr")) {
-    util::forEachLineIn(chargeFile_, [&realCharges](const std::string& line) {
-      if (util::startswith(line, "ATOM") || util::startswith(line, "HETATM")) {
-        const auto tokens = util::split(line, ' ');
-        if (tokens.size() <= constants::PQR_CHARGE_INDEX) {
-          SPDLOG_ERROR("Error reading in charges file");
-          throw cpet::value_error("pqr line too short: " + line);
+    for (size_t i = 0; i < regions.size(); i++) {
+      std::vector<std::vector<PathSample>> samples;
+      {
+        const util::ProfileStage stage{"topology sampling"};
+        samples = regions[i].sampleTopologyWith(
+            systems, pool_, writer_, firstFrame, checkpoints[i].get());
+      }
+      if (topologyHistograms[i]) {
+        const util::ProfileStage stage{"histograms"};
+        for (auto& frameSamples : samples) {
+          topologyHistograms[i]->add(std::move(frameSamples), pool_);
         }
-        realCharges.emplace_back(
-            std::stod(tokens[constants::PQR_CHARGE_INDEX]));
       }
-    });
-  } else {
-    /* We assume we have a PDB file */
-    util::forEachLineIn(chargeFile_, [&realCharges](const std::string& line) {
-      if (util::startswith(line, "ATOM") || util::startswith(line, "HETATM")) {
-        realCharges.emplace_back(std::stod(line.substr(
-            constants::PDB_CHARGE_START, constants::PDB_CHARGE_WIDTH)));
+    }
+    for (size_t i = 0; root && i < fieldLocations.size(); i++) {
+      const util::ProfileStage stage{"field locations"};
+      const auto results = fieldLocations[i].computeEFieldsWith(systems, pool_);
+      for (size_t location = 0; location < results.size(); location++) {
+        auto& trajectory = fieldResults[i][location];
+        trajectory.insert(trajectory.end(), results[location].begin(),
+                          results[location].end());
       }
-    });
+      fieldLocations[i].decomposeWith(systems, pool_, writer_, firstFrame);
+    }
+    for (size_t i = 0; root && i < volumes.size(); i++) {
+      const util::ProfileStage stage{"volumes"};
+      volumes[i].computeVolumeWith(systems, pool_, writer_, firstFrame);
+    }
+    firstFrame += systems.size();
+  }
+  /* Per-frame output is complete, and its errors surface, before the
+   * analyses that need the whole trajectory */
+  {
+    /* Only the part of writing the compute stages did not hide */
+    const util::ProfileStage stage{"write wait"};
+    writer_.wait();
+  }
+  SPDLOG_DEBUG("Streamed {} frames", firstFrame);
+
+  for (size_t i = 0; i < regions.size(); i++) {
+    if (topologyHistograms[i]) {
+      regions[i].analyzeTopology(std::move(*topologyHistograms[i]), pool_);
+    }
+  }
+  for (size_t i = 0; root && i < fieldLocations.size(); i++) {
+    fieldLocations[i].report(fieldResults[i], chargeSets);
   }
-  return realCharges;
 }
 
-void Calculator::fixCharges_() {
-  SPDLOG_DEBUG("Fixing charges in structure file with real charges...");
-  auto realCharges = loadChargesFile_();
-  std::for_each(
-      frameTrajectory_.begin(), frameTrajectory_.end(),
-      [&realCharges](auto& frame) { frame.updateCharges(realCharges); });
+std::string Calculator::checkpointInput_() const {
+  /* A file rewritten in place gets another size or modification time */
+  const auto describe = [](const std::string& file) {
+    const auto modified = std::filesystem::last_write_time(file);
+    return std::filesystem::absolute(file).string() + " (" +
+           std::to_string(std::filesystem::file_size(file)) + " bytes, " +
+           std::to_string(modified.time_since_epoch().count()) + ')';
+  };
+  std::string result = "Trajectory: " + describe(proteinFile_);
+  for (const auto& file : chargeFiles_) {
+    result += "; Charges: " + describe(file);
+  }
+  return result + "; Frames: from " +
+         std::to_string(option_.coordinatesStartIndex()) + " every " +
+         std::to_string(option_.coordinatesStepSize());
+}
+
+std::shared_ptr<const Topology> Calculator::loadChargesFiles_() const {
+  std::shared_ptr<const Topology> topology{nullptr};
+  std::vector<std::vector<double>> sets;
+  for (const auto& file : chargeFiles_) {
+    SPDLOG_DEBUG("Loading charges from external file {} ...", file);
+    /* Same parser as the trajectory, so pdb and pqr are told apart alike */
+    auto reader = TrajectoryReader::open(file, 0, 1);
+    if (!reader->next()) {
+      throw cpet::value_error("No atoms in charges file " + file);
+    }
+    if (topology == nullptr) {
+      topology = reader->topology();
+    }
+    sets.push_back(reader->topology()->charges());
+  }
+  if (sets.size() == 1) {
+    return topology;
+  }
+  return std::make_shared<const Topology>(
+      topology->withChargeSets(std::move(sets)));
 }
 }  // namespace cpet
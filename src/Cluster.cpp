@@ -0,0 +1,178 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "Cluster.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#ifdef CPET_USE_MPI
+#include <mpi.h>
+#endif
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet::util {
+
+const Cluster& Cluster::instance() noexcept { return mutableInstance_(); }
+
+Cluster& Cluster::mutableInstance_() noexcept {
+  static Cluster cluster;
+  return cluster;
+}
+
+#ifdef CPET_USE_MPI
+
+namespace {
+/* MPI counts are ints, so large buffers go in pieces */
+constexpr size_t MAX_MPI_COUNT =
+    static_cast<size_t>(std::numeric_limits<int>::max());
+
+void check(const int status, const std::string& what) {
+  if (status != MPI_SUCCESS) {
+    throw cpet::io_error("MPI error: " + what);
+  }
+}
+}  // namespace
+
+Cluster::Session::Session(int& argc, char**& argv) {
+  /* Results are written on the background writer thread, never at the
+   * same time as the main thread communicates */
+  int provided = 0;
+  check(MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided),
+        "could not initialize");
+  if (provided < MPI_THREAD_SERIALIZED) {
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  auto& cluster = mutableInstance_();
+  MPI_Comm_rank(MPI_COMM_WORLD, &cluster.rank_);
+  MPI_Comm_size(MPI_COMM_WORLD, &cluster.size_);
+}
+
+Cluster::Session::~Session() {
+  auto& cluster = mutableInstance_();
+  cluster.rank_ = 0;
+  cluster.size_ = 1;
+  MPI_Finalize();
+}
+
+void Cluster::sumToRoot(std::vector<int64_t>& values) const {
+  if (size_ == 1) {
+    return;
+  }
+  for (size_t begin = 0; begin < values.size(); begin += MAX_MPI_COUNT) {
+    const auto count =
+        static_cast<int>(std::min(MAX_MPI_COUNT, values.size() - begin));
+    int64_t* data = values.data() + begin;
+    check(MPI_Reduce(root() ? MPI_IN_PLACE : data, data, count, MPI_INT64_T,
+                     MPI_SUM, 0, MPI_COMM_WORLD),
+          "could not reduce histograms");
+  }
+}
+
+uint64_t Cluster::sum(uint64_t value) const {
+  if (size_ > 1) {
+    check(MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_UINT64_T, MPI_SUM,
+                        MPI_COMM_WORLD),
+          "could not sum");
+  }
+  return value;
+}
+
+void Cluster::extremes(double& min, double& max) const {
+  if (size_ == 1) {
+    return;
+  }
+  check(MPI_Allreduce(MPI_IN_PLACE, &min, 1, MPI_DOUBLE, MPI_MIN,
+                      MPI_COMM_WORLD),
+        "could not reduce minimum");
+  check(MPI_Allreduce(MPI_IN_PLACE, &max, 1, MPI_DOUBLE, MPI_MAX,
+                      MPI_COMM_WORLD),
+        "could not reduce maximum");
+}
+
+void Cluster::abort(const int code) const { MPI_Abort(MPI_COMM_WORLD, code); }
+
+void Cluster::writeOrdered(const std::string& file,
+                           const std::string_view header,
+                           const std::string_view data) const {
+  std::string buffer;
+  if (root()) {
+    buffer.append(header);
+  }
+  buffer.append(data);
+
+  /* Each rank starts where the ranks before it end */
+  uint64_t size = buffer.size();
+  uint64_t offset = 0;
+  check(MPI_Exscan(&size, &offset, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD),
+        "could not place " + file);
+  if (root()) {
+    offset = 0;
+  }
+
+  MPI_File handle;
+  if (MPI_File_open(MPI_COMM_WORLD, file.c_str(),
+                    MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                    &handle) != MPI_SUCCESS) {
+    throw cpet::io_error("Could not open file " + file);
+  }
+  /* An older, longer file would otherwise keep its tail */
+  int status = MPI_File_set_size(handle, 0);
+
+  /* The writes are collective, so every rank makes as many as the rank
+   * with the most pieces, some of them empty */
+  uint64_t pieces = (buffer.size() + MAX_MPI_COUNT - 1) / MAX_MPI_COUNT;
+  MPI_Allreduce(MPI_IN_PLACE, &pieces, 1, MPI_UINT64_T, MPI_MAX,
+                MPI_COMM_WORLD);
+  for (uint64_t piece = 0; piece < pieces; piece++) {
+    const size_t begin = std::min(buffer.size(), piece * MAX_MPI_COUNT);
+    const auto count =
+        static_cast<int>(std::min(MAX_MPI_COUNT, buffer.size() - begin));
+    const int written = MPI_File_write_at_all(
+        handle, static_cast<MPI_Offset>(offset + begin),
+        buffer.data() + begin, count, MPI_CHAR, MPI_STATUS_IGNORE);
+    if (status == MPI_SUCCESS) {
+      status = written;
+    }
+  }
+  MPI_File_close(&handle);
+  check(status, "could not write " + file);
+}
+
+#else
+
+Cluster::Session::Session(int& /*argc*/, char**& /*argv*/) {}
+
+Cluster::Session::~Session() = default;
+
+void Cluster::sumToRoot(std::vector<int64_t>& /*values*/) const {}
+
+uint64_t Cluster::sum(const uint64_t value) const { return value; }
+
+void Cluster::extremes(double& /*min*/, double& /*max*/) const {}
+
+void Cluster::abort(const int /*code*/) const {}
+
+void Cluster::writeOrdered(const std::string& file,
+                           const std::string_view header,
+                           const std::string_view data) const {
+  std::ofstream out(file, std::ios::out | std::ios::binary);
+  if (!out.is_open()) {
+    throw cpet::io_error("Could not open file " + file);
+  }
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  out << std::flush;
+  if (!out.good()) {
+    throw cpet::io_error("Could not write file " + file);
+  }
+}
+
+#endif
+
+}  // namespace cpet::util
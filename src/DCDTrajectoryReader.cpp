@@ -0,0 +1,135 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "DCDTrajectoryReader.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet {
+
+namespace {
+/* Size of the control record at the start of the file */
+constexpr int32_t HEADER_RECORD_SIZE = 84;
+constexpr size_t NUMBER_OF_CONTROLS = 20;
+constexpr size_t FIXED_ATOMS_INDEX = 8;
+constexpr size_t UNIT_CELL_INDEX = 10;
+constexpr size_t FOUR_DIMS_INDEX = 11;
+constexpr size_t CHARMM_VERSION_INDEX = 19;
+/* Six doubles */
+constexpr size_t UNIT_CELL_SIZE = 48;
+constexpr size_t RECORD_MARKERS_SIZE = 8;
+}  // namespace
+
+DCDTrajectoryReader::DCDTrajectoryReader(
+    const std::string& file, std::shared_ptr<const Topology> topology,
+    const int start, const int step)
+    : TrajectoryReader(start, step), file_(file), cursor_(file_.view()) {
+  readHeader_(file);
+  if (numberOfAtoms_ != topology->size()) {
+    throw cpet::value_error("Number of atoms in " + file + " (" +
+                            std::to_string(numberOfAtoms_) +
+                            ") does not match the topology (" +
+                            std::to_string(topology->size()) + ")");
+  }
+  setTopology(std::move(topology));
+  nextFrame_ = static_cast<size_t>(std::max(this->start(), 0));
+}
+
+void DCDTrajectoryReader::readHeader_(const std::string& file) {
+  /* The first record marker tells the byte order */
+  if (cursor_.readInt32() != HEADER_RECORD_SIZE) {
+    cursor_.endian(util::BinaryCursor::Endian::little);
+    cursor_.seek(0);
+    if (cursor_.readInt32() != HEADER_RECORD_SIZE) {
+      throw cpet::io_error(file + " is not a DCD file");
+    }
+  }
+  if (cursor_.readBytes(4) != "CORD") {
+    throw cpet::io_error(file + " is not a DCD coordinate file");
+  }
+  std::array<int32_t, NUMBER_OF_CONTROLS> controls{};
+  for (auto& control : controls) {
+    control = cursor_.readInt32();
+  }
+  if (cursor_.readInt32() != HEADER_RECORD_SIZE) {
+    throw cpet::io_error("Corrupt header in " + file);
+  }
+
+  const bool charmm = controls[CHARMM_VERSION_INDEX] != 0;
+  hasUnitCell_ = charmm && controls[UNIT_CELL_INDEX] != 0;
+  if (controls[FIXED_ATOMS_INDEX] != 0) {
+    throw cpet::io_error("DCD files with fixed atoms are not supported");
+  }
+  if (charmm && controls[FOUR_DIMS_INDEX] != 0) {
+    throw cpet::io_error("DCD files with 4D coordinates are not supported");
+  }
+
+  /* Title lines */
+  const auto titleSize = cursor_.readInt32();
+  if (titleSize < 0) {
+    throw cpet::io_error("Corrupt title in " + file);
+  }
+  cursor_.skip(static_cast<size_t>(titleSize));
+  if (cursor_.readInt32() != titleSize) {
+    throw cpet::io_error("Corrupt title in " + file);
+  }
+
+  if (cursor_.readInt32() != 4) {
+    throw cpet::io_error("Corrupt atom count in " + file);
+  }
+  const auto atoms = cursor_.readInt32();
+  if (atoms <= 0 || cursor_.readInt32() != 4) {
+    throw cpet::io_error("Corrupt atom count in " + file);
+  }
+  numberOfAtoms_ = static_cast<size_t>(atoms);
+
+  firstFrameOffset_ = cursor_.offset();
+  frameSize_ = 3 * (RECORD_MARKERS_SIZE + sizeof(float) * numberOfAtoms_);
+  if (hasUnitCell_) {
+    frameSize_ += RECORD_MARKERS_SIZE + UNIT_CELL_SIZE;
+  }
+  /* A truncated last frame, e.g. from a run that was killed, is dropped */
+  numberOfFrames_ = cursor_.remaining() / frameSize_;
+}
+
+std::optional<Frame> DCDTrajectoryReader::next() {
+  if (nextFrame_ >= numberOfFrames_) {
+    return std::nullopt;
+  }
+  cursor_.seek(firstFrameOffset_ + nextFrame_ * frameSize_);
+  nextFrame_ += static_cast<size_t>(step());
+
+  if (hasUnitCell_) {
+    cursor_.skip(RECORD_MARKERS_SIZE + UNIT_CELL_SIZE);
+  }
+  std::vector<Eigen::Vector3d> coordinates(numberOfAtoms_);
+  for (size_t axis = 0; axis < 3; axis++) {
+    readAxis_(coordinates, axis);
+  }
+  return Frame{std::move(coordinates), topology()};
+}
+
+void DCDTrajectoryReader::readAxis_(std::vector<Eigen::Vector3d>& coordinates,
+                                    const size_t axis) {
+  const auto recordSize =
+      static_cast<int32_t>(sizeof(float) * numberOfAtoms_);
+  if (cursor_.readInt32() != recordSize) {
+    throw cpet::io_error("Corrupt coordinate record in DCD file");
+  }
+  const auto index = static_cast<Eigen::Index>(axis);
+  for (auto& coordinate : coordinates) {
+    coordinate[index] = static_cast<double>(cursor_.readFloat());
+  }
+  if (cursor_.readInt32() != recordSize) {
+    throw cpet::io_error("Corrupt coordinate record in DCD file");
+  }
+}
+}  // namespace cpet
@@ -0,0 +1,79 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "DistanceMatrix.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+
+namespace cpet::histo {
+
+namespace {
+/* Rows compared against each other per tile */
+constexpr size_t TILE_ROWS = 8;
+
+/* Bins of each row of a tile in cache at once: 2 * TILE_ROWS rows of
+ * 16 KiB fit in a typical L2 */
+constexpr size_t TILE_BINS = 2048;
+
+/* Adds the distances between the rows of tiles a <= b to result, for
+ * columns from firstColumn on */
+void computeTile(const HistogramMatrix& histograms, const size_t a,
+                 const size_t b, const size_t firstColumn,
+                 DistanceMatrix& result) {
+  const size_t rows = histograms.rows();
+  const size_t iBegin = a * TILE_ROWS;
+  const size_t iEnd = std::min(iBegin + TILE_ROWS, rows);
+  const size_t jTile = b * TILE_ROWS;
+  const size_t jBegin = std::max(jTile, firstColumn);
+  const size_t jEnd = std::min(jTile + TILE_ROWS, rows);
+
+  std::array<double, TILE_ROWS * TILE_ROWS> sums{};
+  for (size_t bin = 0; bin < histograms.bins(); bin += TILE_BINS) {
+    const size_t length = std::min(TILE_BINS, histograms.bins() - bin);
+    for (size_t i = iBegin; i < iEnd; i++) {
+      const double* f = histograms.row(i) + bin;
+      for (size_t j = std::max(jBegin, i + 1); j < jEnd; j++) {
+        sums[(i - iBegin) * TILE_ROWS + (j - jTile)] +=
+            chiDistanceSum(f, histograms.row(j) + bin, length);
+      }
+    }
+  }
+
+  for (size_t i = iBegin; i < iEnd; i++) {
+    for (size_t j = std::max(jBegin, i + 1); j < jEnd; j++) {
+      result.upper(i, j) = sums[(i - iBegin) * TILE_ROWS + (j - jTile)] / 2.0;
+    }
+  }
+}
+}  // namespace
+
+DistanceMatrix chiDistanceMatrix(const HistogramMatrix& histograms,
+                                 util::ThreadPool& pool) {
+  DistanceMatrix result{0};
+  extendChiDistanceMatrix(histograms, result, pool);
+  return result;
+}
+
+void extendChiDistanceMatrix(const HistogramMatrix& histograms,
+                             DistanceMatrix& matrix, util::ThreadPool& pool) {
+  const size_t firstColumn = matrix.size();
+  matrix.grow(histograms.rows());
+  const size_t tiles = (histograms.rows() + TILE_ROWS - 1) / TILE_ROWS;
+  /* Only tiles holding new columns have work */
+  const size_t firstTile = firstColumn / TILE_ROWS;
+  /* Each task keeps its tile of rows in cache against every later tile;
+   * tiles write disjoint entries, so no locking is needed */
+  pool.parallelFor(tiles, 1,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     for (size_t a = begin; a < end; a++) {
+                       for (size_t b = std::max(a, firstTile); b < tiles;
+                            b++) {
+                         computeTile(histograms, a, b, firstColumn, matrix);
+                       }
+                     }
+                   });
+}
+
+}  // namespace cpet::histo
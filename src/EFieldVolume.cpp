@@ -5,6 +5,7 @@
 /* C++ STL HEADER FILES */
 #include <utility>
 #include <fstream>
+#include <string_view>
 
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <matplot/matplot.h>
@@ -16,6 +17,7 @@
 namespace cpet {
 
 constexpr int DENSITY_PARAMETERS = 3;
+constexpr std::string_view VOLUME_MAGIC = "CPETVOL3";
 
 EFieldVolume EFieldVolume::fromSimple(const std::vector<std::string>& options) {
   constexpr bool plot = true;
@@ -56,11 +58,15 @@ EFieldVolume EFieldVolume::fromBlock(const std::vector<std::string>& options) {
   std::optional<std::array<int, DENSITY_PARAMETERS>> density;
   bool plot = false;
   std::optional<std::string> output;
+  FieldSolver solver{};
+  OutputFormat format{};
 
   constexpr const char* SHOW_PLOT_KEY = "show";
   constexpr const char* VOLUME_KEY = "volume";
   constexpr const char* DENSITY_KEY = "density";
   constexpr const char* OUTPUT_KEY = "output";
+  constexpr const char* SOLVER_KEY = "solver";
+  constexpr const char* FORMAT_KEY = "format";
 
   for (const auto& line : options) {
     const auto tokens = util::split(line, ' ');
@@ -96,6 +102,10 @@ EFieldVolume EFieldVolume::fromBlock(const std::vector<std::string>& options) {
                      to_int);
     } else if (key == OUTPUT_KEY) {
       output = *key_options.begin();
+    } else if (key == SOLVER_KEY) {
+      solver = FieldSolver::fromOptions(key_options);
+    } else if (key == FORMAT_KEY) {
+      format = OutputFormat::fromOptions(key_options);
     } else {
       SPDLOG_WARN("Unknown key specified in block plot3d: {}", key);
     }
@@ -110,30 +120,58 @@ EFieldVolume EFieldVolume::fromBlock(const std::vector<std::string>& options) {
         "Invalid Option: No volume specified for 3d plot");
   }
 
-  return {std::move(vol), *density, plot, output};
+  EFieldVolume result{std::move(vol), *density, plot, output};
+  result.solver(solver);
+  result.outputFormat(format);
+  return result;
 }
 
-void EFieldVolume::computeVolumeWith(const std::vector<System>& systems) const {
-  std::vector<std::vector<Eigen::Vector3d>> volumeResults;
-  volumeResults.reserve(systems.size());
-  const auto compute_volume_data = [this](const System& system) {
-    system.printCenterAndBasis();
-    auto tmpSystemResults = system.computeElectricFieldIn(*this);
+void EFieldVolume::computeVolumeWith(const std::vector<System>& systems,
+                                     util::ThreadPool& pool,
+                                     util::AsyncWriter& writer,
+                                     const size_t firstFrame) const {
+  /* Frames run concurrently and each splits its points over the same pool */
+  std::vector<std::vector<Eigen::Vector3d>> volumeResults(systems.size());
+  pool.parallelFor(systems.size(), 1,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     for (size_t frame = begin; frame < end; frame++) {
+                       volumeResults[frame] =
+                           systems[frame].computeElectricFieldIn(
+                               grid(), solver(), volume(), pool);
+                     }
+                   });
+
+  for (size_t frame = 0; frame < systems.size(); frame++) {
+    systems[frame].printCenterAndBasis();
     if (showPlot_) {
-      plot_(tmpSystemResults);
+      /* Plots show the first charge set */
+      const size_t sets = systems[frame].chargeSets();
+      std::vector<Eigen::Vector3d> first;
+      first.reserve(grid_.size());
+      for (size_t j = 0; j < volumeResults[frame].size(); j += sets) {
+        first.push_back(volumeResults[frame][j]);
+      }
+      plot_(first);
     }
-    return tmpSystemResults;
-  };
-  std::transform(systems.begin(), systems.end(),
-                 std::back_inserter(volumeResults), compute_volume_data);
+  }
   if (output_) {
-    writeOutput_(systems, volumeResults);
+    std::vector<FrameField> frames;
+    frames.reserve(systems.size());
+    for (size_t frame = 0; frame < systems.size(); frame++) {
+      frames.push_back({systems[frame].center(), systems[frame].basisMatrix(),
+                        std::move(volumeResults[frame])});
+    }
+    /* Formatted and written while the next window computes */
+    writer.submit([this, firstFrame, frames = std::move(frames)]() {
+      writeOutput_(frames, firstFrame);
+    });
   }
 }
 
 void EFieldVolume::plot_(
     const std::vector<Eigen::Vector3d>& electricField) const {
-  const auto numberOfPoints = points_.size();
+  const auto numberOfPoints = grid_.size();
+  const auto points = grid_.points();
   std::array<std::vector<double>, 3> rotatedPositions;
   std::for_each(rotatedPositions.begin(), rotatedPositions.end(),
                 [&numberOfPoints](auto& vec) { vec.reserve(numberOfPoints); });
@@ -146,7 +184,7 @@ void EFieldVolume::plot_(
         [&index](const Eigen::Vector3d& vector) -> double {
       return vector[static_cast<long>(index)];
     };
-    std::transform(points_.begin(), points_.end(),
+    std::transform(points.begin(), points.end(),
                    std::back_inserter(rotatedPositions.at(index)),
                    extract_index);
     std::transform(electricField.begin(), electricField.end(),
@@ -171,31 +209,53 @@ void EFieldVolume::plot_(
   matplot::show();
 }
 
-void EFieldVolume::writeOutput_(
-    const std::vector<System>& systems,
-    const std::vector<std::vector<Eigen::Vector3d>>& results) const {
+void EFieldVolume::writeOutput_(const std::vector<FrameField>& frames,
+                                const size_t firstFrame) const {
   if (!output_) {
     return;
   }
+  if (outputFormat_.binary()) {
+    writeBinaryOutput_(frames, firstFrame);
+    return;
+  }
 
+  /* Later windows of the trajectory append to the first */
   const auto file = *output_;
-  std::ofstream outFile(file, std::ios::out);
+  const auto mode =
+      (firstFrame == 0) ? std::ios::out : std::ios::out | std::ios::app;
+  std::ofstream outFile(file, mode);
 
   const Eigen::IOFormat fmt(6, Eigen::DontAlignCols, " ", " ", "", "", "", "");
   const Eigen::IOFormat commentFmt(6, 0, " ", "\n", "#", "");
 
   if (outFile.is_open()) {
-    outFile << '#' << this->details() << '\n';
+    /* Several charge sets add column groups after the first field */
+    const size_t sets =
+        frames.empty() ? 1 : frames.front().field.size() / grid_.size();
+    if (firstFrame == 0) {
+      outFile << '#' << this->details() << '\n';
+      outFile << "#Grid origin: " << grid_.origin.transpose().format(fmt)
+              << "; spacing: " << grid_.spacing.transpose().format(fmt)
+              << "; points: " << grid_.dims[0] << ' ' << grid_.dims[1] << ' '
+              << grid_.dims[2] << '\n';
+      if (sets > 1) {
+        outFile << "#Charge sets: " << sets << '\n';
+      }
+    }
 
-    for (size_t i = 0; i < systems.size(); i++) {
-      outFile << "#Frame " << i << '\n';
-      outFile << "#Center: " << systems[i].center().transpose() << '\n';
+    for (size_t i = 0; i < frames.size(); i++) {
+      outFile << "#Frame " << firstFrame + i << '\n';
+      outFile << "#Center: " << frames[i].center.transpose() << '\n';
       outFile << "#Basis Matrix:\n"
-              << systems[i].basisMatrix().format(commentFmt) << '\n';
-
-      for (size_t j = 0; j < results[i].size(); j++) {
-        outFile << points_[j].transpose().format(fmt) << ' '
-                << results[i][j].transpose().format(fmt) << '\n';
+              << frames[i].basis.format(commentFmt) << '\n';
+
+      for (size_t j = 0; j < grid_.size(); j++) {
+        outFile << grid_.point(j).transpose().format(fmt);
+        for (size_t set = 0; set < sets; set++) {
+          outFile << ' '
+                  << frames[i].field[j * sets + set].transpose().format(fmt);
+        }
+        outFile << '\n';
       }
     }
     outFile << std::flush;
@@ -205,4 +265,70 @@ void EFieldVolume::writeOutput_(
     throw cpet::io_error("Could not open file " + file);
   }
 }
+
+void EFieldVolume::writeBinaryOutput_(const std::vector<FrameField>& frames,
+                                      const size_t firstFrame) const {
+  const auto file = *output_;
+  const auto mode = (firstFrame == 0) ? std::ios::out | std::ios::binary
+                                      : std::ios::out | std::ios::binary |
+                                            std::ios::app;
+  std::ofstream outFile(file, mode);
+  if (!outFile.is_open()) {
+    SPDLOG_ERROR("Could not open file {}", file);
+    throw cpet::io_error("Could not open file " + file);
+  }
+
+  const auto flatten = [](const std::vector<Eigen::Vector3d>& vectors) {
+    std::vector<double> result;
+    result.reserve(3 * vectors.size());
+    for (const auto& vector : vectors) {
+      result.insert(result.end(), vector.data(), vector.data() + 3);
+    }
+    return result;
+  };
+
+  /* One frame at a time keeps the buffer the size of one field */
+  util::BinaryWriter writer;
+  const auto flush = [&outFile, &writer]() {
+    outFile.write(writer.buffer().data(),
+                  static_cast<std::streamsize>(writer.buffer().size()));
+    writer.clear();
+  };
+
+  if (firstFrame == 0) {
+    outputFormat_.writeHeader(writer, VOLUME_MAGIC);
+    writer.writeString(details());
+    for (const auto density : sampleDensity_) {
+      writer.writeInt32(density);
+    }
+    for (long axis = 0; axis < 3; axis++) {
+      writer.writeDouble(grid_.origin[axis]);
+    }
+    for (long axis = 0; axis < 3; axis++) {
+      writer.writeDouble(grid_.spacing[axis]);
+    }
+    for (const auto points : grid_.dims) {
+      writer.writeInt32(static_cast<int32_t>(points));
+    }
+    const size_t sets =
+        frames.empty() ? 1 : frames.front().field.size() / grid_.size();
+    writer.writeInt32(static_cast<int32_t>(sets));
+    flush();
+  }
+
+  for (size_t i = 0; i < frames.size(); i++) {
+    writer.writeInt32(static_cast<int32_t>(firstFrame + i));
+    for (long j = 0; j < 3; j++) {
+      writer.writeDouble(frames[i].center[j]);
+    }
+    for (long row = 0; row < 3; row++) {
+      for (long col = 0; col < 3; col++) {
+        writer.writeDouble(frames[i].basis(row, col));
+      }
+    }
+    outputFormat_.writeReals(writer, flatten(frames[i].field));
+    flush();
+  }
+  outFile << std::flush;
+}
 }  // namespace cpet
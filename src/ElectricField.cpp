@@ -0,0 +1,890 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "ElectricField.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  #define CPET_X86_KERNELS
+  #include <immintrin.h>
+#endif
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "Constants.h"
+
+namespace cpet::field {
+
+namespace {
+
+/* Accumulates sum_i q_i * (p - r_i) / |p - r_i|^3 over n charges into out[3],
+ * without the Coulomb prefactor. */
+using RawKernel = void (*)(const double* x, const double* y, const double* z,
+                           const double* q, size_t n, const double* p,
+                           double* out) noexcept;
+
+/* Accumulates the raw field into out[0..2] and its Jacobian into out[3..8]
+ * (xx, xy, xz, yy, yz, zz), using q_i / r^3 and 3 q_i / r^5 from a single
+ * division per charge. */
+using RawGradientKernel = void (*)(const double* x, const double* y,
+                                   const double* z, const double* q, size_t n,
+                                   const double* p, double* out) noexcept;
+
+/* Most charge sets one pass of the multi-set kernels keeps in registers */
+constexpr size_t SETS_PER_PASS = 4;
+
+/* Accumulates the raw fields of several charge sets, q[set][i], into
+ * out[3 * set + axis], computing (p - r_i) / |p - r_i|^3 once for every
+ * set */
+using SetsKernel = void (*)(const double* x, const double* y, const double* z,
+                            const double* const* q, size_t n, const double* p,
+                            double* out) noexcept;
+
+/* The points of a packet, or their fields, one aligned array per axis */
+struct PacketLanes {
+  alignas(64) std::array<double, PACKET_SIZE> x;
+  alignas(64) std::array<double, PACKET_SIZE> y;
+  alignas(64) std::array<double, PACKET_SIZE> z;
+};
+
+/* Accumulates the raw field of n charges at every point of p into out. Each
+ * lane sums the charges in order, so a point's field does not depend on the
+ * other points. */
+using PacketKernel = void (*)(const double* x, const double* y,
+                              const double* z, const double* q, size_t n,
+                              const PacketLanes& p, PacketLanes& out) noexcept;
+
+void scalarKernel(const double* x, const double* y, const double* z,
+                  const double* q, size_t n, const double* p,
+                  double* out) noexcept {
+  double ex = 0.0;
+  double ey = 0.0;
+  double ez = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const double dx = p[0] - x[i];
+    const double dy = p[1] - y[i];
+    const double dz = p[2] - z[i];
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    const double scale = q[i] / (r2 * std::sqrt(r2));
+    ex += scale * dx;
+    ey += scale * dy;
+    ez += scale * dz;
+  }
+  out[0] += ex;
+  out[1] += ey;
+  out[2] += ez;
+}
+
+void scalarGradientKernel(const double* x, const double* y, const double* z,
+                          const double* q, size_t n, const double* p,
+                          double* out) noexcept {
+  std::array<double, 9> sum{};
+  double diagonal = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const double dx = p[0] - x[i];
+    const double dy = p[1] - y[i];
+    const double dz = p[2] - z[i];
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    const double r = std::sqrt(r2);
+    const double inverseR3 = 1.0 / (r2 * r);
+    const double scale = q[i] * inverseR3;
+    const double scale5 = 3.0 * scale * r * inverseR3;
+    sum[0] += scale * dx;
+    sum[1] += scale * dy;
+    sum[2] += scale * dz;
+    diagonal += scale;
+    sum[3] -= scale5 * dx * dx;
+    sum[4] -= scale5 * dx * dy;
+    sum[5] -= scale5 * dx * dz;
+    sum[6] -= scale5 * dy * dy;
+    sum[7] -= scale5 * dy * dz;
+    sum[8] -= scale5 * dz * dz;
+  }
+  sum[3] += diagonal;
+  sum[6] += diagonal;
+  sum[8] += diagonal;
+  for (size_t i = 0; i < sum.size(); ++i) {
+    out[i] += sum[i];
+  }
+}
+
+template <size_t SETS>
+void scalarSetsKernel(const double* x, const double* y, const double* z,
+                      const double* const* q, size_t n, const double* p,
+                      double* out) noexcept {
+  std::array<double, 3 * SETS> sum{};
+  for (size_t i = 0; i < n; ++i) {
+    const double dx = p[0] - x[i];
+    const double dy = p[1] - y[i];
+    const double dz = p[2] - z[i];
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    const double inverseR3 = 1.0 / (r2 * std::sqrt(r2));
+    const double gx = inverseR3 * dx;
+    const double gy = inverseR3 * dy;
+    const double gz = inverseR3 * dz;
+    for (size_t set = 0; set < SETS; ++set) {
+      sum[3 * set] += q[set][i] * gx;
+      sum[3 * set + 1] += q[set][i] * gy;
+      sum[3 * set + 2] += q[set][i] * gz;
+    }
+  }
+  for (size_t component = 0; component < sum.size(); ++component) {
+    out[component] += sum[component];
+  }
+}
+
+/* The same charge sets, starting at charge offset */
+template <size_t SETS>
+std::array<const double*, SETS> offsetSets(const double* const* q,
+                                           size_t offset) noexcept {
+  std::array<const double*, SETS> result{};
+  for (size_t set = 0; set < SETS; ++set) {
+    result[set] = q[set] + offset;
+  }
+  return result;
+}
+
+void scalarPacketKernel(const double* x, const double* y, const double* z,
+                        const double* q, size_t n, const PacketLanes& p,
+                        PacketLanes& out) noexcept {
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t lane = 0; lane < PACKET_SIZE; ++lane) {
+      const double dx = p.x[lane] - x[i];
+      const double dy = p.y[lane] - y[i];
+      const double dz = p.z[lane] - z[i];
+      const double r2 = dx * dx + dy * dy + dz * dz;
+      const double scale = q[i] / (r2 * std::sqrt(r2));
+      out.x[lane] += scale * dx;
+      out.y[lane] += scale * dy;
+      out.z[lane] += scale * dz;
+    }
+  }
+}
+
+#ifdef CPET_X86_KERNELS
+__attribute__((target("avx2,fma"))) inline double horizontalSum(
+    __m256d v) noexcept {
+  const __m128d low = _mm256_castpd256_pd128(v);
+  const __m128d high = _mm256_extractf128_pd(v, 1);
+  const __m128d pair = _mm_add_pd(low, high);
+  return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2,fma"))) void avx2Kernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 4;
+  const __m256d px = _mm256_set1_pd(p[0]);
+  const __m256d py = _mm256_set1_pd(p[1]);
+  const __m256d pz = _mm256_set1_pd(p[2]);
+  __m256d ex = _mm256_setzero_pd();
+  __m256d ey = _mm256_setzero_pd();
+  __m256d ez = _mm256_setzero_pd();
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m256d dx = _mm256_sub_pd(px, _mm256_loadu_pd(x + i));
+    const __m256d dy = _mm256_sub_pd(py, _mm256_loadu_pd(y + i));
+    const __m256d dz = _mm256_sub_pd(pz, _mm256_loadu_pd(z + i));
+    __m256d r2 = _mm256_mul_pd(dx, dx);
+    r2 = _mm256_fmadd_pd(dy, dy, r2);
+    r2 = _mm256_fmadd_pd(dz, dz, r2);
+    const __m256d r3 = _mm256_mul_pd(r2, _mm256_sqrt_pd(r2));
+    const __m256d scale = _mm256_div_pd(_mm256_loadu_pd(q + i), r3);
+    ex = _mm256_fmadd_pd(scale, dx, ex);
+    ey = _mm256_fmadd_pd(scale, dy, ey);
+    ez = _mm256_fmadd_pd(scale, dz, ez);
+  }
+  out[0] += horizontalSum(ex);
+  out[1] += horizontalSum(ey);
+  out[2] += horizontalSum(ez);
+  scalarKernel(x + i, y + i, z + i, q + i, n - i, p, out);
+}
+
+__attribute__((target("avx2,fma"))) void avx2GradientKernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 4;
+  const __m256d px = _mm256_set1_pd(p[0]);
+  const __m256d py = _mm256_set1_pd(p[1]);
+  const __m256d pz = _mm256_set1_pd(p[2]);
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d three = _mm256_set1_pd(3.0);
+  __m256d ex = _mm256_setzero_pd();
+  __m256d ey = _mm256_setzero_pd();
+  __m256d ez = _mm256_setzero_pd();
+  __m256d xx = _mm256_setzero_pd();
+  __m256d xy = _mm256_setzero_pd();
+  __m256d xz = _mm256_setzero_pd();
+  __m256d yy = _mm256_setzero_pd();
+  __m256d yz = _mm256_setzero_pd();
+  __m256d zz = _mm256_setzero_pd();
+  __m256d diagonal = _mm256_setzero_pd();
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m256d dx = _mm256_sub_pd(px, _mm256_loadu_pd(x + i));
+    const __m256d dy = _mm256_sub_pd(py, _mm256_loadu_pd(y + i));
+    const __m256d dz = _mm256_sub_pd(pz, _mm256_loadu_pd(z + i));
+    __m256d r2 = _mm256_mul_pd(dx, dx);
+    r2 = _mm256_fmadd_pd(dy, dy, r2);
+    r2 = _mm256_fmadd_pd(dz, dz, r2);
+    const __m256d r = _mm256_sqrt_pd(r2);
+    const __m256d inverseR3 = _mm256_div_pd(one, _mm256_mul_pd(r2, r));
+    const __m256d scale = _mm256_mul_pd(_mm256_loadu_pd(q + i), inverseR3);
+    const __m256d scale5 =
+        _mm256_mul_pd(_mm256_mul_pd(three, scale), _mm256_mul_pd(r, inverseR3));
+    const __m256d sx = _mm256_mul_pd(scale5, dx);
+    const __m256d sy = _mm256_mul_pd(scale5, dy);
+    const __m256d sz = _mm256_mul_pd(scale5, dz);
+    ex = _mm256_fmadd_pd(scale, dx, ex);
+    ey = _mm256_fmadd_pd(scale, dy, ey);
+    ez = _mm256_fmadd_pd(scale, dz, ez);
+    diagonal = _mm256_add_pd(diagonal, scale);
+    xx = _mm256_fnmadd_pd(sx, dx, xx);
+    xy = _mm256_fnmadd_pd(sx, dy, xy);
+    xz = _mm256_fnmadd_pd(sx, dz, xz);
+    yy = _mm256_fnmadd_pd(sy, dy, yy);
+    yz = _mm256_fnmadd_pd(sy, dz, yz);
+    zz = _mm256_fnmadd_pd(sz, dz, zz);
+  }
+  out[0] += horizontalSum(ex);
+  out[1] += horizontalSum(ey);
+  out[2] += horizontalSum(ez);
+  out[3] += horizontalSum(xx);
+  out[4] += horizontalSum(xy);
+  out[5] += horizontalSum(xz);
+  out[6] += horizontalSum(yy);
+  out[7] += horizontalSum(yz);
+  out[8] += horizontalSum(zz);
+  const double diagonalSum = horizontalSum(diagonal);
+  out[3] += diagonalSum;
+  out[6] += diagonalSum;
+  out[8] += diagonalSum;
+  scalarGradientKernel(x + i, y + i, z + i, q + i, n - i, p, out);
+}
+
+/* The accumulators are a plain array: std::array would drop the vector
+ * type's alignment attributes */
+template <size_t SETS>
+__attribute__((target("avx2,fma"))) void avx2SetsKernel(
+    const double* x, const double* y, const double* z, const double* const* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 4;
+  const __m256d px = _mm256_set1_pd(p[0]);
+  const __m256d py = _mm256_set1_pd(p[1]);
+  const __m256d pz = _mm256_set1_pd(p[2]);
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d sum[3 * SETS];
+  for (auto& value : sum) {
+    value = _mm256_setzero_pd();
+  }
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m256d dx = _mm256_sub_pd(px, _mm256_loadu_pd(x + i));
+    const __m256d dy = _mm256_sub_pd(py, _mm256_loadu_pd(y + i));
+    const __m256d dz = _mm256_sub_pd(pz, _mm256_loadu_pd(z + i));
+    __m256d r2 = _mm256_mul_pd(dx, dx);
+    r2 = _mm256_fmadd_pd(dy, dy, r2);
+    r2 = _mm256_fmadd_pd(dz, dz, r2);
+    const __m256d r3 = _mm256_mul_pd(r2, _mm256_sqrt_pd(r2));
+    const __m256d inverseR3 = _mm256_div_pd(one, r3);
+    const __m256d gx = _mm256_mul_pd(inverseR3, dx);
+    const __m256d gy = _mm256_mul_pd(inverseR3, dy);
+    const __m256d gz = _mm256_mul_pd(inverseR3, dz);
+    for (size_t set = 0; set < SETS; ++set) {
+      const __m256d charge = _mm256_loadu_pd(q[set] + i);
+      sum[3 * set] = _mm256_fmadd_pd(charge, gx, sum[3 * set]);
+      sum[3 * set + 1] = _mm256_fmadd_pd(charge, gy, sum[3 * set + 1]);
+      sum[3 * set + 2] = _mm256_fmadd_pd(charge, gz, sum[3 * set + 2]);
+    }
+  }
+  for (size_t component = 0; component < 3 * SETS; ++component) {
+    out[component] += horizontalSum(sum[component]);
+  }
+  const auto tail = offsetSets<SETS>(q, i);
+  scalarSetsKernel<SETS>(x + i, y + i, z + i, tail.data(), n - i, p, out);
+}
+
+/* Adds one charge (broadcast in c*) to the fields e* at four points p* */
+__attribute__((target("avx2,fma"))) inline void addCharge(
+    const __m256d cx, const __m256d cy, const __m256d cz, const __m256d cq,
+    const __m256d px, const __m256d py, const __m256d pz, __m256d& ex,
+    __m256d& ey, __m256d& ez) noexcept {
+  const __m256d dx = _mm256_sub_pd(px, cx);
+  const __m256d dy = _mm256_sub_pd(py, cy);
+  const __m256d dz = _mm256_sub_pd(pz, cz);
+  __m256d r2 = _mm256_mul_pd(dx, dx);
+  r2 = _mm256_fmadd_pd(dy, dy, r2);
+  r2 = _mm256_fmadd_pd(dz, dz, r2);
+  const __m256d r3 = _mm256_mul_pd(r2, _mm256_sqrt_pd(r2));
+  const __m256d scale = _mm256_div_pd(cq, r3);
+  ex = _mm256_fmadd_pd(scale, dx, ex);
+  ey = _mm256_fmadd_pd(scale, dy, ey);
+  ez = _mm256_fmadd_pd(scale, dz, ez);
+}
+
+/* Eight points at a time fit the sixteen registers, so each block of
+ * charges is streamed from cache once per half packet */
+__attribute__((target("avx2,fma"))) void avx2PacketKernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const PacketLanes& p, PacketLanes& out) noexcept {
+  constexpr size_t WIDTH = 4;
+  for (size_t blockStart = 0; blockStart < n;
+       blockStart += CHARGE_BLOCK_SIZE) {
+    const size_t blockEnd = std::min(n, blockStart + CHARGE_BLOCK_SIZE);
+    for (size_t lane = 0; lane < PACKET_SIZE; lane += 2 * WIDTH) {
+      const size_t other = lane + WIDTH;
+      const __m256d px0 = _mm256_load_pd(&p.x[lane]);
+      const __m256d py0 = _mm256_load_pd(&p.y[lane]);
+      const __m256d pz0 = _mm256_load_pd(&p.z[lane]);
+      const __m256d px1 = _mm256_load_pd(&p.x[other]);
+      const __m256d py1 = _mm256_load_pd(&p.y[other]);
+      const __m256d pz1 = _mm256_load_pd(&p.z[other]);
+      __m256d ex0 = _mm256_load_pd(&out.x[lane]);
+      __m256d ey0 = _mm256_load_pd(&out.y[lane]);
+      __m256d ez0 = _mm256_load_pd(&out.z[lane]);
+      __m256d ex1 = _mm256_load_pd(&out.x[other]);
+      __m256d ey1 = _mm256_load_pd(&out.y[other]);
+      __m256d ez1 = _mm256_load_pd(&out.z[other]);
+      for (size_t i = blockStart; i < blockEnd; ++i) {
+        const __m256d cx = _mm256_broadcast_sd(x + i);
+        const __m256d cy = _mm256_broadcast_sd(y + i);
+        const __m256d cz = _mm256_broadcast_sd(z + i);
+        const __m256d cq = _mm256_broadcast_sd(q + i);
+        addCharge(cx, cy, cz, cq, px0, py0, pz0, ex0, ey0, ez0);
+        addCharge(cx, cy, cz, cq, px1, py1, pz1, ex1, ey1, ez1);
+      }
+      _mm256_store_pd(&out.x[lane], ex0);
+      _mm256_store_pd(&out.y[lane], ey0);
+      _mm256_store_pd(&out.z[lane], ez0);
+      _mm256_store_pd(&out.x[other], ex1);
+      _mm256_store_pd(&out.y[other], ey1);
+      _mm256_store_pd(&out.z[other], ez1);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline double horizontalSum(
+    __m512d v) noexcept {
+  alignas(64) std::array<double, 8> lanes{};
+  _mm512_store_pd(lanes.data(), v);
+  return std::accumulate(lanes.begin(), lanes.end(), 0.0);
+}
+
+__attribute__((target("avx512f"))) void avx512Kernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 8;
+  constexpr __mmask8 ALL_LANES = 0xFF;
+  const __m512d px = _mm512_set1_pd(p[0]);
+  const __m512d py = _mm512_set1_pd(p[1]);
+  const __m512d pz = _mm512_set1_pd(p[2]);
+  __m512d ex = _mm512_setzero_pd();
+  __m512d ey = _mm512_setzero_pd();
+  __m512d ez = _mm512_setzero_pd();
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m512d dx = _mm512_sub_pd(px, _mm512_loadu_pd(x + i));
+    const __m512d dy = _mm512_sub_pd(py, _mm512_loadu_pd(y + i));
+    const __m512d dz = _mm512_sub_pd(pz, _mm512_loadu_pd(z + i));
+    __m512d r2 = _mm512_mul_pd(dx, dx);
+    r2 = _mm512_fmadd_pd(dy, dy, r2);
+    r2 = _mm512_fmadd_pd(dz, dz, r2);
+    /* maskz form avoids gcc's _mm512_undefined_pd() -Wuninitialized noise */
+    const __m512d r3 = _mm512_mul_pd(r2, _mm512_maskz_sqrt_pd(ALL_LANES, r2));
+    const __m512d scale = _mm512_div_pd(_mm512_loadu_pd(q + i), r3);
+    ex = _mm512_fmadd_pd(scale, dx, ex);
+    ey = _mm512_fmadd_pd(scale, dy, ey);
+    ez = _mm512_fmadd_pd(scale, dz, ez);
+  }
+  out[0] += horizontalSum(ex);
+  out[1] += horizontalSum(ey);
+  out[2] += horizontalSum(ez);
+  scalarKernel(x + i, y + i, z + i, q + i, n - i, p, out);
+}
+
+__attribute__((target("avx512f"))) void avx512GradientKernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 8;
+  constexpr __mmask8 ALL_LANES = 0xFF;
+  const __m512d px = _mm512_set1_pd(p[0]);
+  const __m512d py = _mm512_set1_pd(p[1]);
+  const __m512d pz = _mm512_set1_pd(p[2]);
+  const __m512d one = _mm512_set1_pd(1.0);
+  const __m512d three = _mm512_set1_pd(3.0);
+  __m512d ex = _mm512_setzero_pd();
+  __m512d ey = _mm512_setzero_pd();
+  __m512d ez = _mm512_setzero_pd();
+  __m512d xx = _mm512_setzero_pd();
+  __m512d xy = _mm512_setzero_pd();
+  __m512d xz = _mm512_setzero_pd();
+  __m512d yy = _mm512_setzero_pd();
+  __m512d yz = _mm512_setzero_pd();
+  __m512d zz = _mm512_setzero_pd();
+  __m512d diagonal = _mm512_setzero_pd();
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m512d dx = _mm512_sub_pd(px, _mm512_loadu_pd(x + i));
+    const __m512d dy = _mm512_sub_pd(py, _mm512_loadu_pd(y + i));
+    const __m512d dz = _mm512_sub_pd(pz, _mm512_loadu_pd(z + i));
+    __m512d r2 = _mm512_mul_pd(dx, dx);
+    r2 = _mm512_fmadd_pd(dy, dy, r2);
+    r2 = _mm512_fmadd_pd(dz, dz, r2);
+    const __m512d r = _mm512_maskz_sqrt_pd(ALL_LANES, r2);
+    const __m512d inverseR3 = _mm512_div_pd(one, _mm512_mul_pd(r2, r));
+    const __m512d scale = _mm512_mul_pd(_mm512_loadu_pd(q + i), inverseR3);
+    const __m512d scale5 =
+        _mm512_mul_pd(_mm512_mul_pd(three, scale), _mm512_mul_pd(r, inverseR3));
+    const __m512d sx = _mm512_mul_pd(scale5, dx);
+    const __m512d sy = _mm512_mul_pd(scale5, dy);
+    const __m512d sz = _mm512_mul_pd(scale5, dz);
+    ex = _mm512_fmadd_pd(scale, dx, ex);
+    ey = _mm512_fmadd_pd(scale, dy, ey);
+    ez = _mm512_fmadd_pd(scale, dz, ez);
+    diagonal = _mm512_add_pd(diagonal, scale);
+    xx = _mm512_fnmadd_pd(sx, dx, xx);
+    xy = _mm512_fnmadd_pd(sx, dy, xy);
+    xz = _mm512_fnmadd_pd(sx, dz, xz);
+    yy = _mm512_fnmadd_pd(sy, dy, yy);
+    yz = _mm512_fnmadd_pd(sy, dz, yz);
+    zz = _mm512_fnmadd_pd(sz, dz, zz);
+  }
+  out[0] += horizontalSum(ex);
+  out[1] += horizontalSum(ey);
+  out[2] += horizontalSum(ez);
+  out[3] += horizontalSum(xx);
+  out[4] += horizontalSum(xy);
+  out[5] += horizontalSum(xz);
+  out[6] += horizontalSum(yy);
+  out[7] += horizontalSum(yz);
+  out[8] += horizontalSum(zz);
+  const double diagonalSum = horizontalSum(diagonal);
+  out[3] += diagonalSum;
+  out[6] += diagonalSum;
+  out[8] += diagonalSum;
+  scalarGradientKernel(x + i, y + i, z + i, q + i, n - i, p, out);
+}
+
+template <size_t SETS>
+__attribute__((target("avx512f"))) void avx512SetsKernel(
+    const double* x, const double* y, const double* z, const double* const* q,
+    size_t n, const double* p, double* out) noexcept {
+  constexpr size_t WIDTH = 8;
+  constexpr __mmask8 ALL_LANES = 0xFF;
+  const __m512d px = _mm512_set1_pd(p[0]);
+  const __m512d py = _mm512_set1_pd(p[1]);
+  const __m512d pz = _mm512_set1_pd(p[2]);
+  const __m512d one = _mm512_set1_pd(1.0);
+  __m512d sum[3 * SETS];
+  for (auto& value : sum) {
+    value = _mm512_setzero_pd();
+  }
+
+  size_t i = 0;
+  for (; i + WIDTH <= n; i += WIDTH) {
+    const __m512d dx = _mm512_sub_pd(px, _mm512_loadu_pd(x + i));
+    const __m512d dy = _mm512_sub_pd(py, _mm512_loadu_pd(y + i));
+    const __m512d dz = _mm512_sub_pd(pz, _mm512_loadu_pd(z + i));
+    __m512d r2 = _mm512_mul_pd(dx, dx);
+    r2 = _mm512_fmadd_pd(dy, dy, r2);
+    r2 = _mm512_fmadd_pd(dz, dz, r2);
+    const __m512d r3 = _mm512_mul_pd(r2, _mm512_maskz_sqrt_pd(ALL_LANES, r2));
+    const __m512d inverseR3 = _mm512_div_pd(one, r3);
+    const __m512d gx = _mm512_mul_pd(inverseR3, dx);
+    const __m512d gy = _mm512_mul_pd(inverseR3, dy);
+    const __m512d gz = _mm512_mul_pd(inverseR3, dz);
+    for (size_t set = 0; set < SETS; ++set) {
+      const __m512d charge = _mm512_loadu_pd(q[set] + i);
+      sum[3 * set] = _mm512_fmadd_pd(charge, gx, sum[3 * set]);
+      sum[3 * set + 1] = _mm512_fmadd_pd(charge, gy, sum[3 * set + 1]);
+      sum[3 * set + 2] = _mm512_fmadd_pd(charge, gz, sum[3 * set + 2]);
+    }
+  }
+  for (size_t component = 0; component < 3 * SETS; ++component) {
+    out[component] += horizontalSum(sum[component]);
+  }
+  const auto tail = offsetSets<SETS>(q, i);
+  scalarSetsKernel<SETS>(x + i, y + i, z + i, tail.data(), n - i, p, out);
+}
+
+/* Adds one charge (broadcast in c*) to the fields e* at eight points p* */
+__attribute__((target("avx512f"))) inline void addCharge(
+    const __m512d cx, const __m512d cy, const __m512d cz, const __m512d cq,
+    const __m512d px, const __m512d py, const __m512d pz, __m512d& ex,
+    __m512d& ey, __m512d& ez) noexcept {
+  constexpr __mmask8 ALL_LANES = 0xFF;
+  const __m512d dx = _mm512_sub_pd(px, cx);
+  const __m512d dy = _mm512_sub_pd(py, cy);
+  const __m512d dz = _mm512_sub_pd(pz, cz);
+  __m512d r2 = _mm512_mul_pd(dx, dx);
+  r2 = _mm512_fmadd_pd(dy, dy, r2);
+  r2 = _mm512_fmadd_pd(dz, dz, r2);
+  const __m512d r3 = _mm512_mul_pd(r2, _mm512_maskz_sqrt_pd(ALL_LANES, r2));
+  const __m512d scale = _mm512_div_pd(cq, r3);
+  ex = _mm512_fmadd_pd(scale, dx, ex);
+  ey = _mm512_fmadd_pd(scale, dy, ey);
+  ez = _mm512_fmadd_pd(scale, dz, ez);
+}
+
+/* The whole packet is two vectors, so every charge is loaded once */
+__attribute__((target("avx512f"))) void avx512PacketKernel(
+    const double* x, const double* y, const double* z, const double* q,
+    size_t n, const PacketLanes& p, PacketLanes& out) noexcept {
+  constexpr size_t WIDTH = 8;
+  static_assert(PACKET_SIZE == 2 * WIDTH);
+  const __m512d px0 = _mm512_load_pd(&p.x[0]);
+  const __m512d py0 = _mm512_load_pd(&p.y[0]);
+  const __m512d pz0 = _mm512_load_pd(&p.z[0]);
+  const __m512d px1 = _mm512_load_pd(&p.x[WIDTH]);
+  const __m512d py1 = _mm512_load_pd(&p.y[WIDTH]);
+  const __m512d pz1 = _mm512_load_pd(&p.z[WIDTH]);
+  __m512d ex0 = _mm512_load_pd(&out.x[0]);
+  __m512d ey0 = _mm512_load_pd(&out.y[0]);
+  __m512d ez0 = _mm512_load_pd(&out.z[0]);
+  __m512d ex1 = _mm512_load_pd(&out.x[WIDTH]);
+  __m512d ey1 = _mm512_load_pd(&out.y[WIDTH]);
+  __m512d ez1 = _mm512_load_pd(&out.z[WIDTH]);
+  for (size_t i = 0; i < n; ++i) {
+    const __m512d cx = _mm512_set1_pd(x[i]);
+    const __m512d cy = _mm512_set1_pd(y[i]);
+    const __m512d cz = _mm512_set1_pd(z[i]);
+    const __m512d cq = _mm512_set1_pd(q[i]);
+    addCharge(cx, cy, cz, cq, px0, py0, pz0, ex0, ey0, ez0);
+    addCharge(cx, cy, cz, cq, px1, py1, pz1, ex1, ey1, ez1);
+  }
+  _mm512_store_pd(&out.x[0], ex0);
+  _mm512_store_pd(&out.y[0], ey0);
+  _mm512_store_pd(&out.z[0], ez0);
+  _mm512_store_pd(&out.x[WIDTH], ex1);
+  _mm512_store_pd(&out.y[WIDTH], ey1);
+  _mm512_store_pd(&out.z[WIDTH], ez1);
+}
+#endif
+
+RawKernel kernelFor(const KernelISA isa) noexcept {
+  if (!isSupported(isa)) {
+    return &scalarKernel;
+  }
+  switch (isa) {
+#ifdef CPET_X86_KERNELS
+    case KernelISA::avx512:
+      return &avx512Kernel;
+    case KernelISA::avx2:
+      return &avx2Kernel;
+#endif
+    case KernelISA::scalar:
+    default:
+      return &scalarKernel;
+  }
+}
+
+RawGradientKernel gradientKernelFor(const KernelISA isa) noexcept {
+  if (!isSupported(isa)) {
+    return &scalarGradientKernel;
+  }
+  switch (isa) {
+#ifdef CPET_X86_KERNELS
+    case KernelISA::avx512:
+      return &avx512GradientKernel;
+    case KernelISA::avx2:
+      return &avx2GradientKernel;
+#endif
+    case KernelISA::scalar:
+    default:
+      return &scalarGradientKernel;
+  }
+}
+
+/* Kernel for a pass over 1 to SETS_PER_PASS charge sets */
+SetsKernel setsKernelFor(const KernelISA isa, const size_t sets) noexcept {
+  static constexpr std::array<SetsKernel, SETS_PER_PASS> SCALAR{
+      &scalarSetsKernel<1>, &scalarSetsKernel<2>, &scalarSetsKernel<3>,
+      &scalarSetsKernel<4>};
+#ifdef CPET_X86_KERNELS
+  static constexpr std::array<SetsKernel, SETS_PER_PASS> AVX2{
+      &avx2SetsKernel<1>, &avx2SetsKernel<2>, &avx2SetsKernel<3>,
+      &avx2SetsKernel<4>};
+  static constexpr std::array<SetsKernel, SETS_PER_PASS> AVX512{
+      &avx512SetsKernel<1>, &avx512SetsKernel<2>, &avx512SetsKernel<3>,
+      &avx512SetsKernel<4>};
+#endif
+  const size_t index = sets - 1;
+  if (!isSupported(isa)) {
+    return SCALAR[index];
+  }
+  switch (isa) {
+#ifdef CPET_X86_KERNELS
+    case KernelISA::avx512:
+      return AVX512[index];
+    case KernelISA::avx2:
+      return AVX2[index];
+#endif
+    case KernelISA::scalar:
+    default:
+      return SCALAR[index];
+  }
+}
+
+PacketKernel packetKernelFor(const KernelISA isa) noexcept {
+  if (!isSupported(isa)) {
+    return &scalarPacketKernel;
+  }
+  switch (isa) {
+#ifdef CPET_X86_KERNELS
+    case KernelISA::avx512:
+      return &avx512PacketKernel;
+    case KernelISA::avx2:
+      return &avx2PacketKernel;
+#endif
+    case KernelISA::scalar:
+    default:
+      return &scalarPacketKernel;
+  }
+}
+
+RawKernel selectedKernel() noexcept {
+  static const RawKernel kernel = [] {
+    const auto isa = detectKernelISA();
+    SPDLOG_DEBUG("Using {} electric field kernel", name(isa));
+    return kernelFor(isa);
+  }();
+  return kernel;
+}
+
+PacketKernel selectedPacketKernel() noexcept {
+  static const PacketKernel kernel = packetKernelFor(detectKernelISA());
+  return kernel;
+}
+
+RawGradientKernel selectedGradientKernel() noexcept {
+  static const RawGradientKernel kernel =
+      gradientKernelFor(detectKernelISA());
+  return kernel;
+}
+
+FieldGradient evaluateGradient(const RawGradientKernel kernel,
+                               const PointChargeStore& charges,
+                               const Eigen::Vector3d& position) noexcept {
+  std::array<double, 9> raw{};
+  kernel(charges.x(), charges.y(), charges.z(), charges.q(), charges.size(),
+         position.data(), raw.data());
+  FieldGradient result;
+  result.field = constants::TO_V_PER_ANG * Eigen::Vector3d{raw[0], raw[1],
+                                                           raw[2]};
+  result.gradient << raw[3], raw[4], raw[5],  //
+      raw[4], raw[6], raw[7],                 //
+      raw[5], raw[7], raw[8];
+  result.gradient *= constants::TO_V_PER_ANG;
+  return result;
+}
+
+void evaluateSets(const KernelISA isa, const ChargeSetStore& charges,
+                  const Eigen::Vector3d* positions, const size_t count,
+                  Eigen::Vector3d* results) noexcept {
+  const size_t sets = charges.sets();
+  for (size_t first = 0; first < sets; first += SETS_PER_PASS) {
+    const size_t group = std::min(SETS_PER_PASS, sets - first);
+    const SetsKernel kernel = setsKernelFor(isa, group);
+    std::array<const double*, SETS_PER_PASS> q{};
+    for (size_t set = 0; set < group; ++set) {
+      q[set] = charges.q(first + set);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      std::array<double, 3 * SETS_PER_PASS> raw{};
+      kernel(charges.x(), charges.y(), charges.z(), q.data(), charges.size(),
+             positions[i].data(), raw.data());
+      for (size_t set = 0; set < group; ++set) {
+        results[i * sets + first + set] =
+            constants::TO_V_PER_ANG *
+            Eigen::Vector3d{raw[3 * set], raw[3 * set + 1], raw[3 * set + 2]};
+      }
+    }
+  }
+}
+
+void evaluatePacket(const PacketKernel kernel, const PointChargeStore& charges,
+                    const PointPacket& positions,
+                    PointPacket& fields) noexcept {
+  PacketLanes points{};
+  for (size_t lane = 0; lane < PACKET_SIZE; ++lane) {
+    points.x[lane] = positions[lane][0];
+    points.y[lane] = positions[lane][1];
+    points.z[lane] = positions[lane][2];
+  }
+  PacketLanes raw{};
+  kernel(charges.x(), charges.y(), charges.z(), charges.q(), charges.size(),
+         points, raw);
+  for (size_t lane = 0; lane < PACKET_SIZE; ++lane) {
+    fields[lane] = constants::TO_V_PER_ANG *
+                   Eigen::Vector3d{raw.x[lane], raw.y[lane], raw.z[lane]};
+  }
+}
+
+Eigen::Vector3d evaluate(const RawKernel kernel,
+                         const PointChargeStore& charges,
+                         const Eigen::Vector3d& position) noexcept {
+  std::array<double, 3> result{0.0, 0.0, 0.0};
+  kernel(charges.x(), charges.y(), charges.z(), charges.q(), charges.size(),
+         position.data(), result.data());
+  return constants::TO_V_PER_ANG *
+         Eigen::Vector3d{result[0], result[1], result[2]};
+}
+}  // namespace
+
+bool isSupported(const KernelISA isa) noexcept {
+  switch (isa) {
+#ifdef CPET_X86_KERNELS
+    case KernelISA::avx512:
+      return __builtin_cpu_supports("avx512f") != 0;
+    case KernelISA::avx2:
+      return __builtin_cpu_supports("avx2") != 0 &&
+             __builtin_cpu_supports("fma") != 0;
+#endif
+    case KernelISA::scalar:
+      return true;
+    default:
+      return false;
+  }
+}
+
+KernelISA detectKernelISA() noexcept {
+  static const KernelISA isa = [] {
+    if (isSupported(KernelISA::avx512)) {
+      return KernelISA::avx512;
+    }
+    if (isSupported(KernelISA::avx2)) {
+      return KernelISA::avx2;
+    }
+    return KernelISA::scalar;
+  }();
+  return isa;
+}
+
+std::string name(const KernelISA isa) {
+  switch (isa) {
+    case KernelISA::avx512:
+      return "avx512";
+    case KernelISA::avx2:
+      return "avx2";
+    case KernelISA::scalar:
+    default:
+      return "scalar";
+  }
+}
+
+Eigen::Vector3d electricFieldAt(const PointChargeStore& charges,
+                                const Eigen::Vector3d& position) noexcept {
+  return evaluate(selectedKernel(), charges, position);
+}
+
+Eigen::Vector3d electricFieldAt(const PointChargeStore& charges,
+                                const Eigen::Vector3d& position,
+                                const KernelISA isa) noexcept {
+  return evaluate(kernelFor(isa), charges, position);
+}
+
+FieldGradient fieldGradientAt(const PointChargeStore& charges,
+                              const Eigen::Vector3d& position) noexcept {
+  return evaluateGradient(selectedGradientKernel(), charges, position);
+}
+
+FieldGradient fieldGradientAt(const PointChargeStore& charges,
+                              const Eigen::Vector3d& position,
+                              const KernelISA isa) noexcept {
+  return evaluateGradient(gradientKernelFor(isa), charges, position);
+}
+
+void accumulateRange(const PointChargeStore& charges, const size_t begin,
+                     const size_t end, const Eigen::Vector3d& position,
+                     Eigen::Vector3d& raw) noexcept {
+  selectedKernel()(charges.x() + begin, charges.y() + begin,
+                   charges.z() + begin, charges.q() + begin, end - begin,
+                   position.data(), raw.data());
+}
+
+void electricFieldAt(const PointChargeStore& charges,
+                     const Eigen::Vector3d* positions, const size_t count,
+                     Eigen::Vector3d* results) noexcept {
+  const RawKernel kernel = selectedKernel();
+  std::array<std::array<double, 3>, POINT_TILE_SIZE> accumulators{};
+
+  for (size_t tileStart = 0; tileStart < count; tileStart += POINT_TILE_SIZE) {
+    const size_t tileSize = std::min(POINT_TILE_SIZE, count - tileStart);
+    std::for_each(accumulators.begin(), accumulators.begin() + tileSize,
+                  [](auto& acc) { acc.fill(0.0); });
+
+    for (size_t blockStart = 0; blockStart < charges.size();
+         blockStart += CHARGE_BLOCK_SIZE) {
+      const size_t blockSize =
+          std::min(CHARGE_BLOCK_SIZE, charges.size() - blockStart);
+      for (size_t i = 0; i < tileSize; ++i) {
+        kernel(charges.x() + blockStart, charges.y() + blockStart,
+               charges.z() + blockStart, charges.q() + blockStart, blockSize,
+               positions[tileStart + i].data(), accumulators[i].data());
+      }
+    }
+
+    for (size_t i = 0; i < tileSize; ++i) {
+      results[tileStart + i] =
+          constants::TO_V_PER_ANG * Eigen::Vector3d{accumulators[i][0],
+                                                    accumulators[i][1],
+                                                    accumulators[i][2]};
+    }
+  }
+}
+
+void electricFieldAt(const PointChargeStore& charges,
+                     const PointPacket& positions,
+                     PointPacket& fields) noexcept {
+  evaluatePacket(selectedPacketKernel(), charges, positions, fields);
+}
+
+void electricFieldAt(const PointChargeStore& charges,
+                     const PointPacket& positions, PointPacket& fields,
+                     const KernelISA isa) noexcept {
+  evaluatePacket(packetKernelFor(isa), charges, positions, fields);
+}
+
+void groupFieldsAt(const PointChargeStore& charges,
+                   const std::vector<size_t>& offsets,
+                   const Eigen::Vector3d* positions, const size_t count,
+                   Eigen::Vector3d* results) noexcept {
+  const RawKernel kernel = selectedKernel();
+  const size_t groups = offsets.empty() ? 0 : offsets.size() - 1;
+  for (size_t group = 0; group < groups; group++) {
+    const size_t begin = offsets[group];
+    const size_t size = offsets[group + 1] - begin;
+    for (size_t i = 0; i < count; i++) {
+      std::array<double, 3> raw{};
+      kernel(charges.x() + begin, charges.y() + begin, charges.z() + begin,
+             charges.q() + begin, size, positions[i].data(), raw.data());
+      results[i * groups + group] =
+          constants::TO_V_PER_ANG * Eigen::Vector3d{raw[0], raw[1], raw[2]};
+    }
+  }
+}
+
+void electricFieldsAt(const ChargeSetStore& charges,
+                      const Eigen::Vector3d* positions, const size_t count,
+                      Eigen::Vector3d* results) noexcept {
+  evaluateSets(detectKernelISA(), charges, positions, count, results);
+}
+
+void electricFieldsAt(const ChargeSetStore& charges,
+                      const Eigen::Vector3d* positions, const size_t count,
+                      Eigen::Vector3d* results, const KernelISA isa) noexcept {
+  evaluateSets(isa, charges, positions, count, results);
+}
+}  // namespace cpet::field
@@ -0,0 +1,64 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "FarFieldExpansion.h"
+
+/* C++ STL HEADER FILES */
+#include <cmath>
+
+/* CPET HEADER FILES */
+#include "Constants.h"
+#include "ElectricField.h"
+
+namespace cpet {
+
+FarFieldExpansion::FarFieldExpansion(const PointChargeStore& charges,
+                                     const Eigen::Vector3d& center,
+                                     const double cutoff)
+    : center_(center) {
+  const double cutoffSquared = cutoff * cutoff;
+  const Eigen::Matrix3d identity = Eigen::Matrix3d::Identity();
+
+  for (size_t i = 0; i < charges.size(); i++) {
+    const double q = charges.q()[i];
+    const Eigen::Vector3d d = center_ - charges.coordinate(i);
+    const double r2 = d.squaredNorm();
+    if (r2 < cutoffSquared) {
+      near_.push_back(charges.coordinate(i), q);
+      continue;
+    }
+    ++numberOfFarCharges_;
+
+    const double invR2 = 1.0 / r2;
+    const double invR3 = invR2 / std::sqrt(r2);
+    const double invR5 = invR3 * invR2;
+    const double invR7 = invR5 * invR2;
+
+    field_ += q * invR3 * d;
+    gradient_ += q * (invR3 * identity - 3.0 * invR5 * d * d.transpose());
+    for (Eigen::Index a = 0; a < 3; a++) {
+      auto& h = hessian_[static_cast<size_t>(a)];
+      for (Eigen::Index b = 0; b < 3; b++) {
+        for (Eigen::Index c = 0; c < 3; c++) {
+          h(b, c) += q * (15.0 * invR7 * d[a] * d[b] * d[c] -
+                          3.0 * invR5 *
+                              (identity(a, b) * d[c] + identity(a, c) * d[b] +
+                               identity(b, c) * d[a]));
+        }
+      }
+    }
+  }
+}
+
+Eigen::Vector3d FarFieldExpansion::electricFieldAt(
+    const Eigen::Vector3d& position) const noexcept {
+  const Eigen::Vector3d delta = position - center_;
+  Eigen::Vector3d raw = field_ + gradient_ * delta;
+  for (size_t a = 0; a < hessian_.size(); a++) {
+    raw[static_cast<Eigen::Index>(a)] +=
+        0.5 * delta.dot(hessian_[a] * delta);
+  }
+  field::accumulateRange(near_, 0, near_.size(), position, raw);
+  return constants::TO_V_PER_ANG * raw;
+}
+}  // namespace cpet
@@ -0,0 +1,193 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "FieldGrid.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace cpet {
+
+namespace {
+/* Splits the lattice coordinate t, clamped to the nodes [0, last], into a
+ * cell index in [lo, hi] and the offset within that cell. Between the
+ * outer nodes and [lo, hi] the offset leaves [0, 1) and the cell's
+ * polynomial is extrapolated. A non-finite t, as from a diverging
+ * streamline, is outside the grid altogether. */
+inline std::optional<std::pair<int, double>> locate(double t, int lo, int hi,
+                                                    int last) noexcept {
+  if (!std::isfinite(t)) {
+    return std::nullopt;
+  }
+  /* Clamped before the conversion, which is undefined out of int range */
+  t = std::clamp(t, 0.0, static_cast<double>(last));
+  const int cell = std::clamp(static_cast<int>(std::floor(t)), lo, hi);
+  return std::pair{cell, t - cell};
+}
+
+/* Field at a position outside the grid */
+inline Eigen::Vector3d outsideGrid() noexcept {
+  return Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN());
+}
+
+/* Lagrange weights of the cubic through the nodes -1, 0, 1, 2 at u */
+inline std::array<double, 4> cubicWeights(double u) noexcept {
+  const double um1 = u - 1.0;
+  const double um2 = u - 2.0;
+  const double up1 = u + 1.0;
+  return {-u * um1 * um2 / 6.0, up1 * um1 * um2 / 2.0, -up1 * u * um2 / 2.0,
+          up1 * u * um1 / 6.0};
+}
+}  // namespace
+
+FieldGrid::FieldGrid(const Eigen::Vector3d& lower,
+                     const Eigen::Vector3d& upper, const double spacing,
+                     const GridInterpolation::Type type)
+    : lower_(lower), type_(type) {
+  if (spacing <= 0.0) {
+    throw cpet::value_error("Invalid value for grid spacing");
+  }
+  if ((upper.array() <= lower.array()).any()) {
+    throw cpet::value_error("Invalid bounds for field grid");
+  }
+  const Eigen::Array3d extent = (upper - lower).array();
+  for (Eigen::Index a = 0; a < 3; a++) {
+    dims_[a] = std::max(MIN_NODES,
+                        static_cast<int>(std::ceil(extent[a] / spacing)) + 1);
+    spacing_[a] = extent[a] / (dims_[a] - 1);
+  }
+}
+
+std::vector<Eigen::Vector3d> FieldGrid::nodes() const {
+  std::vector<Eigen::Vector3d> result;
+  result.reserve(size());
+  for (int i = 0; i < dims_[0]; i++) {
+    for (int j = 0; j < dims_[1]; j++) {
+      for (int k = 0; k < dims_[2]; k++) {
+        result.emplace_back(lower_ + (Eigen::Array3d{static_cast<double>(i),
+                                                     static_cast<double>(j),
+                                                     static_cast<double>(k)} *
+                                      spacing_)
+                                         .matrix());
+      }
+    }
+  }
+  return result;
+}
+
+void FieldGrid::values(std::vector<Eigen::Vector3d> fields) {
+  if (fields.size() != size()) {
+    throw cpet::value_error("Number of field values does not match grid");
+  }
+  values_ = std::move(fields);
+}
+
+std::vector<Eigen::Vector3d> FieldGrid::probes(const size_t maxProbes) const {
+  const Eigen::Array3i cells = dims_ - 1;
+  const auto totalCells = static_cast<double>(cells.prod());
+  const int stride = std::max(
+      1, static_cast<int>(std::ceil(
+             std::cbrt(totalCells / static_cast<double>(maxProbes)))));
+
+  std::vector<Eigen::Vector3d> result;
+  for (int i = 0; i < cells[0]; i += stride) {
+    for (int j = 0; j < cells[1]; j += stride) {
+      for (int k = 0; k < cells[2]; k += stride) {
+        const Eigen::Array3d t{i + 0.5, j + 0.5, k + 0.5};
+        result.emplace_back(lower_ + (t * spacing_).matrix());
+      }
+    }
+  }
+  if (result.size() > maxProbes) {
+    result.resize(maxProbes);
+  }
+  return result;
+}
+
+double FieldGrid::estimateError(const std::vector<Eigen::Vector3d>& probes,
+                                const std::vector<Eigen::Vector3d>& exact) {
+  errorEstimate_ = 0.0;
+  for (size_t i = 0; i < std::min(probes.size(), exact.size()); i++) {
+    const double norm = exact[i].norm();
+    if (norm > 0.0) {
+      const double error = (electricFieldAt(probes[i]) - exact[i]).norm();
+      errorEstimate_ = std::max(errorEstimate_, error / norm);
+    }
+  }
+  return errorEstimate_;
+}
+
+Eigen::Vector3d FieldGrid::electricFieldAt(
+    const Eigen::Vector3d& position) const noexcept {
+  if (values_.empty()) {
+    return Eigen::Vector3d::Zero();
+  }
+  return (type_ == GridInterpolation::Type::tricubic) ? tricubic_(position)
+                                                      : trilinear_(position);
+}
+
+Eigen::Vector3d FieldGrid::trilinear_(
+    const Eigen::Vector3d& position) const noexcept {
+  const Eigen::Array3d t = (position - lower_).array() / spacing_;
+  const auto x = locate(t[0], 0, dims_[0] - 2, dims_[0] - 1);
+  const auto y = locate(t[1], 0, dims_[1] - 2, dims_[1] - 1);
+  const auto z = locate(t[2], 0, dims_[2] - 2, dims_[2] - 1);
+  if (!x || !y || !z) {
+    return outsideGrid();
+  }
+  const auto [i, u] = *x;
+  const auto [j, v] = *y;
+  const auto [k, w] = *z;
+
+  const std::array<double, 2> wx{1.0 - u, u};
+  const std::array<double, 2> wy{1.0 - v, v};
+  const std::array<double, 2> wz{1.0 - w, w};
+
+  Eigen::Vector3d result{0, 0, 0};
+  for (size_t a = 0; a < wx.size(); a++) {
+    for (size_t b = 0; b < wy.size(); b++) {
+      const size_t base =
+          index_(i + static_cast<int>(a), j + static_cast<int>(b), k);
+      result += wx[a] * wy[b] *
+                (wz[0] * values_[base] + wz[1] * values_[base + 1]);
+    }
+  }
+  return result;
+}
+
+Eigen::Vector3d FieldGrid::tricubic_(
+    const Eigen::Vector3d& position) const noexcept {
+  const Eigen::Array3d t = (position - lower_).array() / spacing_;
+  const auto x = locate(t[0], 1, dims_[0] - 3, dims_[0] - 1);
+  const auto y = locate(t[1], 1, dims_[1] - 3, dims_[1] - 1);
+  const auto z = locate(t[2], 1, dims_[2] - 3, dims_[2] - 1);
+  if (!x || !y || !z) {
+    return outsideGrid();
+  }
+  const auto [i, u] = *x;
+  const auto [j, v] = *y;
+  const auto [k, w] = *z;
+
+  const auto wx = cubicWeights(u);
+  const auto wy = cubicWeights(v);
+  const auto wz = cubicWeights(w);
+
+  Eigen::Vector3d result{0, 0, 0};
+  for (size_t a = 0; a < wx.size(); a++) {
+    for (size_t b = 0; b < wy.size(); b++) {
+      const size_t base = index_(i + static_cast<int>(a) - 1,
+                                 j + static_cast<int>(b) - 1, k - 1);
+      Eigen::Vector3d line = wz[0] * values_[base];
+      for (size_t c = 1; c < wz.size(); c++) {
+        line += wz[c] * values_[base + c];
+      }
+      result += wx[a] * wy[b] * line;
+    }
+  }
+  return result;
+}
+}  // namespace cpet
@@ -3,6 +3,11 @@
 
 #include "FieldLocations.h"
 
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <fstream>
+#include <string>
+
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <Eigen/Dense>
 #include <matplot/matplot.h>
@@ -28,6 +33,7 @@ FieldLocations FieldLocations::fromBlock(
   constexpr const char* PLOT_KEY = "plot";
   constexpr const char* LOCATIONS_KEY = "locations";
   constexpr const char* OUTPUT_KEY = "output";
+  constexpr const char* DECOMPOSE_KEY = "decompose";
 
   FieldLocations fl;
   for (const auto& line : options) {
@@ -52,40 +58,103 @@ FieldLocations FieldLocations::fromBlock(
       fl.plotStyle_ = decodePlotStyle_(key_options);
     } else if (key == OUTPUT_KEY) {
       fl.output_ = *key_options.begin();
+    } else if (key == DECOMPOSE_KEY) {
+      if (key_options.size() < 2) {
+        throw cpet::invalid_option(
+            "Invalid Option: decompose needs residue or chain and a file");
+      }
+      fl.decompose_ = ChargeGroups::keyFromString(key_options[0]);
+      fl.decompositionOutput_ = key_options[1];
     }
   }
   return fl;
 }
-void FieldLocations::computeEFieldsWith(
-    const std::vector<System>& systems) const {
-  std::vector<std::vector<Eigen::Vector3d>> results;
-  for (const auto& point : locations_) {
-    SPDLOG_INFO("=~=~=~=~[Field at {}]=~=~=~=~", point.ID());
-    std::vector<Eigen::Vector3d> fieldTrajectoryAtPoint;
-
-    for (const auto& system : systems) {
-      Eigen::Vector3d location;
-      if (point.position()) {
-        location = *(point.position());
-      } else {
-        location = system.frame().find(point)->coordinate;
-      }
+std::vector<std::vector<Eigen::Vector3d>> FieldLocations::computeEFieldsWith(
+    const std::vector<System>& systems, util::ThreadPool& pool) const {
+  /* results[location][frame * sets + set] */
+  const size_t sets = systems.empty() ? 1 : systems.front().chargeSets();
+  std::vector<std::vector<Eigen::Vector3d>> results(
+      locations_.size(), std::vector<Eigen::Vector3d>(systems.size() * sets));
+
+  /* One batched evaluation per frame; frames write disjoint columns */
+  pool.parallelFor(
+      systems.size(), pool.chunkSizeFor(systems.size()),
+      [&](const size_t begin, const size_t end, size_t) {
+        for (size_t frame = begin; frame < end; frame++) {
+          const auto fields =
+              systems[frame].electricFieldsAt(positionsIn_(systems[frame]));
+          for (size_t i = 0; i < locations_.size(); i++) {
+            std::copy_n(fields.begin() + static_cast<long>(i * sets), sets,
+                        results[i].begin() + static_cast<long>(frame * sets));
+          }
+        }
+      });
+
+  return results;
+}
+
+void FieldLocations::decomposeWith(const std::vector<System>& systems,
+                                   util::ThreadPool& pool,
+                                   util::AsyncWriter& writer,
+                                   const size_t firstFrame) const {
+  if (!decompose_ || systems.empty()) {
+    return;
+  }
+  /* Every frame shares the topology, so the groups are found once */
+  const ChargeGroups groups{systems.front().frame().topology(), *decompose_};
 
-      Eigen::Vector3d field = system.electricFieldAt(location);
-      SPDLOG_INFO("{} [{}]", field.transpose(), field.norm());
-      fieldTrajectoryAtPoint.emplace_back(field);
+  /* fields[frame][location * groups + group] */
+  std::vector<std::vector<Eigen::Vector3d>> fields(systems.size());
+  pool.parallelFor(systems.size(), pool.chunkSizeFor(systems.size()),
+                   [&](const size_t begin, const size_t end, size_t) {
+                     for (size_t frame = begin; frame < end; frame++) {
+                       fields[frame] = systems[frame].groupFieldsAt(
+                           positionsIn_(systems[frame]), groups);
+                     }
+                   });
+
+  /* Formatted and written while the next window computes */
+  writer.submit([this, firstFrame, fields = std::move(fields),
+                 names = groups.names()]() {
+    writeDecomposition_(fields, names, firstFrame);
+  });
+}
+
+void FieldLocations::report(
+    const std::vector<std::vector<Eigen::Vector3d>>& results,
+    const size_t chargeSets) const {
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+  for (size_t i = 0; i < locations_.size(); i++) {
+    SPDLOG_INFO("=~=~=~=~[Field at {}]=~=~=~=~", locations_[i].ID());
+    for (size_t frame = 0; frame * chargeSets < results[i].size(); frame++) {
+      std::string line;
+      for (size_t set = 0; set < chargeSets; set++) {
+        const auto& field = results[i][frame * chargeSets + set];
+        line += fmt::format("{}{} [{}]", (set == 0) ? "" : " | ",
+                            field.transpose(), field.norm());
+      }
+      SPDLOG_INFO("{}", line);
     }
-    results.push_back(fieldTrajectoryAtPoint);
   }
+#endif
+
   if (output_) {
-    writeOutput_(results);
+    writeOutput_(results, chargeSets);
   }
   if (showPlots()) {
-    plot_(results);
+    /* Plots show the first charge set */
+    std::vector<std::vector<Eigen::Vector3d>> first(results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+      for (size_t j = 0; j < results[i].size(); j += chargeSets) {
+        first[i].push_back(results[i][j]);
+      }
+    }
+    plot_(first);
   }
 }
 void FieldLocations::writeOutput_(
-    const std::vector<std::vector<Eigen::Vector3d>>& results) const {
+    const std::vector<std::vector<Eigen::Vector3d>>& results,
+    const size_t chargeSets) const {
   if (!output_) {
     return;
   }
@@ -94,8 +163,10 @@ void FieldLocations::writeOutput_(
   if (outFile.is_open()) {
     for (size_t i = 0; i < results.size(); i++) {
       outFile << '#' << locations_[i].ID() << '\n';
-      for (const Eigen::Vector3d& field : results[i]) {
-        outFile << field.transpose() << '\n';
+      /* One line per frame, one column group per charge set */
+      for (size_t j = 0; j < results[i].size(); j++) {
+        outFile << results[i][j].transpose()
+                << (((j + 1) % chargeSets == 0) ? '\n' : ' ');
       }
     }
     outFile << std::flush;
@@ -104,6 +175,49 @@ void FieldLocations::writeOutput_(
     throw cpet::io_error("Could not open file " + *output_);
   }
 }
+std::vector<Eigen::Vector3d> FieldLocations::positionsIn_(
+    const System& system) const {
+  std::vector<Eigen::Vector3d> positions(locations_.size());
+  std::transform(locations_.begin(), locations_.end(), positions.begin(),
+                 [&system](const AtomID& point) -> Eigen::Vector3d {
+                   if (point.position()) {
+                     return *(point.position());
+                   }
+                   return system.frame().find(point);
+                 });
+  return positions;
+}
+
+void FieldLocations::writeDecomposition_(
+    const std::vector<std::vector<Eigen::Vector3d>>& fields,
+    const std::vector<std::string>& groups, const size_t firstFrame) const {
+  /* Later windows of the trajectory append to the first */
+  const auto mode =
+      (firstFrame == 0) ? std::ios::out : std::ios::out | std::ios::app;
+  std::ofstream outFile(decompositionOutput_, mode);
+  if (!outFile.is_open()) {
+    SPDLOG_ERROR("Could not open file {}", decompositionOutput_);
+    throw cpet::io_error("Could not open file " + decompositionOutput_);
+  }
+
+  if (firstFrame == 0) {
+    outFile << "#Field by " << ChargeGroups::name(*decompose_) << '\n'
+            << "#frame location " << ChargeGroups::name(*decompose_)
+            << " x y z\n";
+  }
+  for (size_t frame = 0; frame < fields.size(); frame++) {
+    for (size_t i = 0; i < locations_.size(); i++) {
+      for (size_t group = 0; group < groups.size(); group++) {
+        outFile << firstFrame + frame << ' ' << locations_[i].ID() << ' '
+                << groups[group] << ' '
+                << fields[frame][i * groups.size() + group].transpose()
+                << '\n';
+      }
+    }
+  }
+  outFile << std::flush;
+}
+
 void FieldLocations::plot_(
     const std::vector<std::vector<Eigen::Vector3d>>& results) const {
   const auto numberOfPlots =
@@ -0,0 +1,98 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "FramePlan.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/fmt/ostr.h>
+#include <spdlog/spdlog.h>
+
+namespace cpet {
+
+namespace {
+struct UserSpace {
+  Eigen::Vector3d center;
+  Eigen::Matrix3d basis;
+};
+
+/* Center and basis of the align line of option, found in frame */
+UserSpace userSpaceOf(const Frame& frame, const Option& option) {
+  UserSpace result;
+  if (option.centerID().position()) {
+    result.center = *(option.centerID().position());
+  } else {
+    result.center = frame.find(option.centerID());
+  }
+
+  const auto direction = [&](const AtomID& id) -> Eigen::Vector3d {
+    if (!id.position()) {
+      return frame.find(id) - result.center;
+    }
+    if (id.isConstant()) {
+      SPDLOG_DEBUG("Using constant direction {}", id.position()->transpose());
+      return *(id.position());
+    }
+    SPDLOG_DEBUG("Using user defined vector {}", id.position()->transpose());
+    return *(id.position()) - result.center;
+  };
+  result.basis = System::orthonormalBasis(direction(option.direction1ID()),
+                                          direction(option.direction2ID()));
+  return result;
+}
+
+/* The octree is only built when some block asks for it */
+bool usesOctree(const Option& option) {
+  const auto usesBarnesHut = [](const auto& block) {
+    return block.solver().type == FieldSolver::Type::barneshut;
+  };
+  return std::any_of(option.calculateEFieldTopology().begin(),
+                     option.calculateEFieldTopology().end(), usesBarnesHut) ||
+         std::any_of(option.calculateEFieldVolumes().begin(),
+                     option.calculateEFieldVolumes().end(), usesBarnesHut);
+}
+}  // namespace
+
+System systemFor(Frame frame, const Option& option) {
+  const auto space = userSpaceOf(frame, option);
+  return System{std::move(frame), space.center, space.basis,
+                usesOctree(option)};
+}
+
+std::vector<System> FramePlan::prepare(std::vector<Frame> frames,
+                                       util::ThreadPool& pool) const {
+  /* One frame per task: the octree and charge arrays of a frame are built
+   * by one thread */
+  const bool useOctree = usesOctree(option_);
+  std::vector<std::optional<System>> prepared(frames.size());
+  pool.parallelFor(frames.size(), 1,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     for (size_t i = begin; i < end; i++) {
+                       const auto space = userSpaceOf(frames[i], option_);
+                       prepared[i].emplace(System::inUserSpace(
+                           std::move(frames[i]), space.center, space.basis,
+                           useOctree, device_));
+                     }
+                   });
+
+  std::vector<System> systems;
+  systems.reserve(prepared.size());
+  for (auto& system : prepared) {
+    systems.push_back(std::move(*system));
+  }
+  return systems;
+}
+
+std::string FramePlan::description() const {
+  return std::to_string(option_.calculateEFieldTopology().size()) +
+         " topology, " +
+         std::to_string(option_.calculateFieldLocations().size()) +
+         " field and " +
+         std::to_string(option_.calculateEFieldVolumes().size()) +
+         " plot3d blocks per frame on the " + device_.description();
+}
+}  // namespace cpet
@@ -0,0 +1,71 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "FrameView.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+
+/* CPET HEADER FILES */
+#include "ElectricField.h"
+#include "Exceptions.h"
+#include "FieldEvaluator.h"
+
+namespace cpet {
+
+FrameView::FrameView(const CoordinateView& coordinates,
+                     const ChargeView& charges) {
+  if (coordinates.size > 0 &&
+      (coordinates.data == nullptr || charges.data == nullptr)) {
+    throw cpet::value_error("Frame view without coordinates or charges");
+  }
+  if (coordinates.stride < 3) {
+    throw cpet::value_error("Coordinate stride must be at least 3");
+  }
+
+  /* Only the charged atoms contribute to the field */
+  store_.reserve(coordinates.size);
+  for (size_t i = 0; i < coordinates.size; i++) {
+    const double charge = charges.data[i * charges.stride];
+    if (charge != 0.0) {
+      const double* coordinate = coordinates.data + i * coordinates.stride;
+      store_.push_back({coordinate[0], coordinate[1], coordinate[2]}, charge);
+    }
+  }
+}
+
+void FrameView::electricFieldAt(const Eigen::Vector3d* positions,
+                                const size_t count,
+                                Eigen::Vector3d* fields) const noexcept {
+  field::electricFieldAt(store_, positions, count, fields);
+}
+
+void FrameView::electricFieldAt(const Eigen::Vector3d* positions,
+                                const size_t count, Eigen::Vector3d* fields,
+                                util::ThreadPool& pool) const {
+  /* Chunks of at least one tile keep the batched kernel's blocking intact */
+  const size_t chunkSize =
+      std::max(pool.chunkSizeFor(count), field::POINT_TILE_SIZE);
+  pool.parallelFor(count, chunkSize,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     field::electricFieldAt(store_, positions + begin,
+                                            end - begin, fields + begin);
+                   });
+}
+
+void FrameView::electricFieldTopologyIn(
+    const Volume& volume, const double stepSize, const size_t count,
+    PathSample* out, util::ThreadPool& pool, const Integrator& integrator,
+    const util::SampleStream& stream) const {
+  const FieldEvaluator evaluator{store_};
+  /* Chunks of a few packets keep the lanes of each packet busy */
+  const size_t chunkSize =
+      std::max(pool.chunkSizeFor(count), 2 * field::PACKET_SIZE);
+  pool.parallelFor(count, chunkSize,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     streamline::sampleTopology(evaluator, volume, stepSize,
+                                                integrator, stream, begin,
+                                                end - begin, out + begin);
+                   });
+}
+}  // namespace cpet
@@ -0,0 +1,42 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "GpuField.h"
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+/* Builds with CUDA (ENABLE_CUDA) compile GpuField.cu instead */
+#ifndef CPET_USE_CUDA
+
+namespace cpet::gpu {
+
+namespace {
+[[noreturn]] void unavailable() {
+  throw cpet::value_error(
+      "cpet was built without GPU support; configure with -DENABLE_CUDA=ON");
+}
+}  // namespace
+
+bool available() noexcept { return false; }
+
+struct Charges::Buffers {};
+
+Charges::Charges(const PointChargeStore& /*store*/) { unavailable(); }
+
+Charges::~Charges() = default;
+
+void Charges::fieldAt(const Eigen::Vector3d* /*positions*/, size_t /*count*/,
+                      Eigen::Vector3d* /*results*/) const {
+  unavailable();
+}
+
+std::vector<TracedSample> Charges::trace(
+    const TraceSettings& /*settings*/, const util::SampleStream& /*stream*/,
+    size_t /*first*/, size_t /*count*/) const {
+  unavailable();
+}
+
+}  // namespace cpet::gpu
+
+#endif
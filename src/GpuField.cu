@@ -0,0 +1,470 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "GpuField.h"
+
+/* C++ STL HEADER FILES */
+#include <mutex>
+#include <string>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <cuda_runtime.h>
+
+/* CPET HEADER FILES */
+#include "Constants.h"
+#include "Exceptions.h"
+
+namespace cpet::gpu {
+
+namespace {
+constexpr int BLOCK_SIZE = 128;
+
+static_assert(sizeof(Eigen::Vector3d) == 3 * sizeof(double),
+              "positions are copied to the GPU as packed doubles");
+
+void check(const cudaError_t status, const std::string& what) {
+  if (status != cudaSuccess) {
+    throw cpet::value_error("CUDA error: " + what + ": " +
+                            cudaGetErrorString(status));
+  }
+}
+
+[[nodiscard]] unsigned int blocksFor(const size_t count) noexcept {
+  return static_cast<unsigned int>((count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+}
+
+/* Memory on the GPU for count values of T */
+template <typename T>
+class DeviceArray {
+ public:
+  explicit DeviceArray(const size_t count) {
+    if (count > 0) {
+      check(cudaMalloc(&data_, count * sizeof(T)),
+            "could not allocate GPU memory");
+    }
+  }
+
+  DeviceArray(const DeviceArray&) = delete;
+
+  DeviceArray& operator=(const DeviceArray&) = delete;
+
+  ~DeviceArray() { cudaFree(data_); }
+
+  [[nodiscard]] inline T* data() const noexcept { return data_; }
+
+ private:
+  T* data_{nullptr};
+};
+
+struct Vec3 {
+  double x;
+  double y;
+  double z;
+};
+
+__device__ inline Vec3 operator+(const Vec3 a, const Vec3 b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+__device__ inline Vec3 operator-(const Vec3 a, const Vec3 b) {
+  return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+__device__ inline Vec3 operator*(const double s, const Vec3 a) {
+  return {s * a.x, s * a.y, s * a.z};
+}
+
+__device__ inline double dot(const Vec3 a, const Vec3 b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+__device__ inline double norm(const Vec3 a) { return sqrt(dot(a, a)); }
+
+__device__ inline Vec3 cross(const Vec3 a, const Vec3 b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+
+/* Structure-of-arrays charges, as in PointChargeStore */
+struct DeviceCharges {
+  const double* x;
+  const double* y;
+  const double* z;
+  const double* q;
+  size_t count;
+};
+
+/* Same sum, in the same order, as the scalar CPU kernel. Threads of a warp
+ * read the same charge at once, so the loads are broadcast. */
+__device__ Vec3 fieldAt(const DeviceCharges& charges, const Vec3 p) {
+  double ex = 0.0;
+  double ey = 0.0;
+  double ez = 0.0;
+  for (size_t i = 0; i < charges.count; i++) {
+    const double dx = p.x - __ldg(charges.x + i);
+    const double dy = p.y - __ldg(charges.y + i);
+    const double dz = p.z - __ldg(charges.z + i);
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    const double scale = __ldg(charges.q + i) / (r2 * sqrt(r2));
+    ex += scale * dx;
+    ey += scale * dy;
+    ez += scale * dz;
+  }
+  return constants::TO_V_PER_ANG * Vec3{ex, ey, ez};
+}
+
+/* Unit tangent of the field line through position, as Eigen's
+ * normalized() */
+__device__ inline Vec3 tangent(const DeviceCharges& charges,
+                               const Vec3 position) {
+  const Vec3 field = fieldAt(charges, position);
+  const double squared = dot(field, field);
+  return squared > 0.0 ? (1.0 / sqrt(squared)) * field : field;
+}
+
+struct DeviceBox {
+  Vec3 center;
+  Vec3 halfWidths;
+
+  [[nodiscard]] __device__ inline bool isInside(const Vec3 p) const {
+    return fabs(p.x - center.x) < halfWidths.x &&
+           fabs(p.y - center.y) < halfWidths.y &&
+           fabs(p.z - center.z) < halfWidths.z;
+  }
+};
+
+struct DeviceSettings {
+  TraceSettings::Method method;
+  double tolerance;
+  double stepSize;
+  double maxStep;
+  int maxSteps;
+  DeviceBox box;
+};
+
+struct DeviceTrace {
+  Vec3 position;
+  double length;
+  uint32_t evaluations;
+  uint32_t steps;
+};
+
+__device__ Vec3 rk4Step(const DeviceCharges& charges, const Vec3 y,
+                        const double h) {
+  const Vec3 k1 = tangent(charges, y);
+  const Vec3 k2 = tangent(charges, y + (0.5 * h) * k1);
+  const Vec3 k3 = tangent(charges, y + (0.5 * h) * k2);
+  const Vec3 k4 = tangent(charges, y + h * k3);
+  return y + (h / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+}
+
+/* streamline::traceFixed */
+__device__ DeviceTrace traceFixed(const DeviceCharges& charges,
+                                  const DeviceSettings& settings,
+                                  const Vec3 start, const double maxLength) {
+  const bool rk4 = settings.method == TraceSettings::Method::rk4;
+  DeviceTrace result{start, 0.0, 0, 0};
+  while (settings.box.isInside(result.position) &&
+         result.length < maxLength) {
+    const double h = fmin(settings.stepSize, maxLength - result.length);
+    if (rk4) {
+      result.position = rk4Step(charges, result.position, h);
+    } else {
+      result.position =
+          result.position + h * tangent(charges, result.position);
+    }
+    result.length += h;
+    result.evaluations += rk4 ? 4 : 1;
+    ++result.steps;
+  }
+  return result;
+}
+
+/* streamline::traceAdaptive, with the same Dormand-Prince 5(4) tableau and
+ * step control */
+__device__ DeviceTrace traceAdaptive(const DeviceCharges& charges,
+                                     const DeviceSettings& settings,
+                                     const Vec3 start,
+                                     const double maxLength) {
+  constexpr double MIN_STEP_FRACTION = 1e-3;
+  constexpr double SAFETY = 0.9;
+  constexpr double MIN_SCALE = 0.2;
+  constexpr double MAX_SCALE = 5.0;
+  constexpr uint32_t STAGES = 6;
+
+  const double minStep = MIN_STEP_FRACTION * settings.stepSize;
+  DeviceTrace result{start, 0.0, 1, 0};
+  Vec3 k1 = tangent(charges, start);
+  double h = settings.stepSize;
+
+  while (settings.box.isInside(result.position) &&
+         result.length < maxLength) {
+    h = fmin(h, maxLength - result.length);
+    const Vec3 y = result.position;
+    const Vec3 k2 = tangent(charges, y + (h * (1.0 / 5.0)) * k1);
+    const Vec3 k3 =
+        tangent(charges, y + h * ((3.0 / 40.0) * k1 + (9.0 / 40.0) * k2));
+    const Vec3 k4 = tangent(
+        charges, y + h * ((44.0 / 45.0) * k1 - (56.0 / 15.0) * k2 +
+                          (32.0 / 9.0) * k3));
+    const Vec3 k5 = tangent(
+        charges,
+        y + h * ((19372.0 / 6561.0) * k1 - (25360.0 / 2187.0) * k2 +
+                 (64448.0 / 6561.0) * k3 - (212.0 / 729.0) * k4));
+    const Vec3 k6 = tangent(
+        charges, y + h * ((9017.0 / 3168.0) * k1 - (355.0 / 33.0) * k2 +
+                          (46732.0 / 5247.0) * k3 + (49.0 / 176.0) * k4 -
+                          (5103.0 / 18656.0) * k5));
+    const Vec3 next =
+        y + h * ((35.0 / 384.0) * k1 + (500.0 / 1113.0) * k3 +
+                 (125.0 / 192.0) * k4 - (2187.0 / 6784.0) * k5 +
+                 (11.0 / 84.0) * k6);
+    const Vec3 k7 = tangent(charges, next);
+    const double error =
+        norm(h * ((71.0 / 57600.0) * k1 - (71.0 / 16695.0) * k3 +
+                  (71.0 / 1920.0) * k4 - (17253.0 / 339200.0) * k5 +
+                  (22.0 / 525.0) * k6 - (1.0 / 40.0) * k7));
+    result.evaluations += STAGES;
+
+    const double scale =
+        (error > 0.0)
+            ? fmin(fmax(SAFETY * pow(settings.tolerance / error, 0.2),
+                        MIN_SCALE),
+                   MAX_SCALE)
+            : MAX_SCALE;
+
+    if (error > settings.tolerance && h > minStep) {
+      h = fmax(minStep, h * scale);
+      continue;
+    }
+    if (h > settings.stepSize && !settings.box.isInside(next)) {
+      h = fmax(settings.stepSize, 0.5 * h);
+      continue;
+    }
+
+    result.position = next;
+    result.length += h;
+    ++result.steps;
+    k1 = k7;
+    h = fmin(settings.maxStep, h * scale);
+  }
+  return result;
+}
+
+/* System::curvatureAt_: |E x (grad E . E)| / |E|^3, with the field and its
+ * Jacobian summed as by the scalar CPU kernel. The Coulomb prefactor
+ * cancels. */
+__device__ double curvatureAt(const DeviceCharges& charges,
+                              const Vec3 position) {
+  Vec3 field{0.0, 0.0, 0.0};
+  double diagonal = 0.0;
+  double xx = 0.0;
+  double xy = 0.0;
+  double xz = 0.0;
+  double yy = 0.0;
+  double yz = 0.0;
+  double zz = 0.0;
+  for (size_t i = 0; i < charges.count; i++) {
+    const double dx = position.x - __ldg(charges.x + i);
+    const double dy = position.y - __ldg(charges.y + i);
+    const double dz = position.z - __ldg(charges.z + i);
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    const double r = sqrt(r2);
+    const double inverseR3 = 1.0 / (r2 * r);
+    const double scale = __ldg(charges.q + i) * inverseR3;
+    const double scale5 = 3.0 * scale * r * inverseR3;
+    field = field + scale * Vec3{dx, dy, dz};
+    diagonal += scale;
+    xx -= scale5 * dx * dx;
+    xy -= scale5 * dx * dy;
+    xz -= scale5 * dx * dz;
+    yy -= scale5 * dy * dy;
+    yz -= scale5 * dy * dz;
+    zz -= scale5 * dz * dz;
+  }
+  xx += diagonal;
+  yy += diagonal;
+  zz += diagonal;
+  const Vec3 derivative{xx * field.x + xy * field.y + xz * field.z,
+                        xy * field.x + yy * field.y + yz * field.z,
+                        xz * field.x + yz * field.y + zz * field.z};
+  const double fieldNorm = norm(field);
+  return norm(cross(field, derivative)) /
+         (fieldNorm * fieldNorm * fieldNorm);
+}
+
+/* One streamline per thread, drawn as System::sampleElectricFieldTopologyIn_
+ * draws it */
+__global__ void traceKernel(const DeviceCharges charges,
+                            const DeviceSettings settings,
+                            const util::SampleStream stream,
+                            const size_t first, const size_t count,
+                            TracedSample* results) {
+  const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+  if (i >= count) {
+    return;
+  }
+  auto random = stream.at(first + i);
+  const DeviceBox& box = settings.box;
+  const double x = random.uniform(-box.halfWidths.x, box.halfWidths.x);
+  const double y = random.uniform(-box.halfWidths.y, box.halfWidths.y);
+  const double z = random.uniform(-box.halfWidths.z, box.halfWidths.z);
+  const Vec3 start = Vec3{x, y, z} + box.center;
+  const double maxLength =
+      settings.stepSize * random.uniformInt(1, settings.maxSteps);
+
+  const DeviceTrace trace =
+      (settings.method == TraceSettings::Method::dormandprince)
+          ? traceAdaptive(charges, settings, start, maxLength)
+          : traceFixed(charges, settings, start, maxLength);
+
+  results[i] = {{norm(trace.position - start),
+                 (curvatureAt(charges, trace.position) +
+                  curvatureAt(charges, start)) /
+                     2.0},
+                trace.steps,
+                trace.evaluations,
+                !(trace.length < maxLength)};
+}
+
+/* One point per thread. The block stages tiles of charges in shared
+ * memory, which every thread then sums over in the order of the CPU. */
+__global__ void fieldKernel(const DeviceCharges charges,
+                            const double* positions, const size_t count,
+                            double* results) {
+  __shared__ double tile[4][BLOCK_SIZE];
+  const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+  const bool active = i < count;
+  const Vec3 p = active ? Vec3{positions[3 * i], positions[3 * i + 1],
+                               positions[3 * i + 2]}
+                        : Vec3{0.0, 0.0, 0.0};
+
+  double ex = 0.0;
+  double ey = 0.0;
+  double ez = 0.0;
+  for (size_t begin = 0; begin < charges.count; begin += BLOCK_SIZE) {
+    const size_t load = begin + threadIdx.x;
+    if (load < charges.count) {
+      tile[0][threadIdx.x] = charges.x[load];
+      tile[1][threadIdx.x] = charges.y[load];
+      tile[2][threadIdx.x] = charges.z[load];
+      tile[3][threadIdx.x] = charges.q[load];
+    }
+    __syncthreads();
+    const size_t remaining = charges.count - begin;
+    const size_t size = remaining < BLOCK_SIZE ? remaining : BLOCK_SIZE;
+    for (size_t j = 0; active && j < size; j++) {
+      const double dx = p.x - tile[0][j];
+      const double dy = p.y - tile[1][j];
+      const double dz = p.z - tile[2][j];
+      const double r2 = dx * dx + dy * dy + dz * dz;
+      const double scale = tile[3][j] / (r2 * sqrt(r2));
+      ex += scale * dx;
+      ey += scale * dy;
+      ez += scale * dz;
+    }
+    __syncthreads();
+  }
+  if (active) {
+    results[3 * i] = constants::TO_V_PER_ANG * ex;
+    results[3 * i + 1] = constants::TO_V_PER_ANG * ey;
+    results[3 * i + 2] = constants::TO_V_PER_ANG * ez;
+  }
+}
+}  // namespace
+
+bool available() noexcept {
+  int devices = 0;
+  return cudaGetDeviceCount(&devices) == cudaSuccess && devices > 0;
+}
+
+struct Charges::Buffers {
+  explicit Buffers(const size_t count) : values(4 * count) {}
+
+  DeviceArray<double> values;
+  DeviceCharges charges{};
+  cudaStream_t stream{nullptr};
+  std::mutex mutex;
+};
+
+Charges::Charges(const PointChargeStore& store)
+    : buffers_(std::make_unique<Buffers>(store.size())) {
+  const size_t n = store.size();
+  double* values = buffers_->values.data();
+  buffers_->charges = {values, values + n, values + 2 * n, values + 3 * n, n};
+  check(cudaStreamCreateWithFlags(&buffers_->stream, cudaStreamNonBlocking),
+        "could not create a stream");
+  const std::array<const double*, 4> arrays{store.x(), store.y(), store.z(),
+                                            store.q()};
+  for (size_t array = 0; array < arrays.size(); array++) {
+    check(cudaMemcpyAsync(values + array * n, arrays[array],
+                          n * sizeof(double), cudaMemcpyHostToDevice,
+                          buffers_->stream),
+          "could not upload charges");
+  }
+  check(cudaStreamSynchronize(buffers_->stream), "could not upload charges");
+}
+
+Charges::~Charges() {
+  if (buffers_ != nullptr && buffers_->stream != nullptr) {
+    cudaStreamDestroy(buffers_->stream);
+  }
+}
+
+void Charges::fieldAt(const Eigen::Vector3d* positions, const size_t count,
+                      Eigen::Vector3d* results) const {
+  if (count == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(buffers_->mutex);
+  const auto stream = buffers_->stream;
+  const DeviceArray<double> devicePositions{3 * count};
+  const DeviceArray<double> deviceResults{3 * count};
+  check(cudaMemcpyAsync(devicePositions.data(), positions->data(),
+                        3 * count * sizeof(double), cudaMemcpyHostToDevice,
+                        stream),
+        "could not upload positions");
+  fieldKernel<<<blocksFor(count), BLOCK_SIZE, 0, stream>>>(
+      buffers_->charges, devicePositions.data(), count, deviceResults.data());
+  check(cudaGetLastError(), "could not launch the field kernel");
+  check(cudaMemcpyAsync(results->data(), deviceResults.data(),
+                        3 * count * sizeof(double), cudaMemcpyDeviceToHost,
+                        stream),
+        "could not download fields");
+  check(cudaStreamSynchronize(stream), "could not compute fields");
+}
+
+std::vector<TracedSample> Charges::trace(const TraceSettings& settings,
+                                         const util::SampleStream& stream,
+                                         const size_t first,
+                                         const size_t count) const {
+  std::vector<TracedSample> results(count);
+  if (count == 0) {
+    return results;
+  }
+  const DeviceSettings deviceSettings{
+      settings.method,
+      settings.tolerance,
+      settings.stepSize,
+      settings.maxStep,
+      settings.maxSteps,
+      {{settings.center[0], settings.center[1], settings.center[2]},
+       {settings.halfWidths[0], settings.halfWidths[1],
+        settings.halfWidths[2]}}};
+
+  std::lock_guard<std::mutex> lock(buffers_->mutex);
+  const auto cudaStream = buffers_->stream;
+  const DeviceArray<TracedSample> deviceResults{count};
+  traceKernel<<<blocksFor(count), BLOCK_SIZE, 0, cudaStream>>>(
+      buffers_->charges, deviceSettings, stream, first, count,
+      deviceResults.data());
+  check(cudaGetLastError(), "could not launch the trace kernel");
+  check(cudaMemcpyAsync(results.data(), deviceResults.data(),
+                        count * sizeof(TracedSample), cudaMemcpyDeviceToHost,
+                        cudaStream),
+        "could not download samples");
+  check(cudaStreamSynchronize(cudaStream), "could not trace samples");
+  return results;
+}
+
+}  // namespace cpet::gpu
@@ -3,6 +3,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include "Exceptions.h"
 #include "Histogram2D.h"
 
 namespace cpet::histo {
@@ -10,45 +11,53 @@ std::vector<std::vector<int>> construct2DHistogram(
     const std::vector<double>& x, const std::vector<double>& y,
     const std::array<int, 2>& bins, const std::array<double, 2>& xlim,
     const std::array<double, 2>& ylim) noexcept {
-  std::vector<std::vector<int>> result(
-      static_cast<size_t>(bins[1]),
-      std::vector<int>(static_cast<size_t>(bins[0]), 0));
-
-  auto xEdges = constructEdges(xlim[0], xlim[1], bins[0]);
-  auto yEdges = constructEdges(ylim[0], ylim[1], bins[1]);
-
+  Histogram2D histogram{bins, xlim, ylim};
   const auto numberOfElements = std::min(x.size(), y.size());
-
-  const auto notInXLimit = [&](const double& value) {
-    return value < xlim[0] || value > xlim[1];
-  };
-  const auto notInYLimit = [&](const double& value) {
-    return value < ylim[0] || value > ylim[1];
-  };
-
   for (size_t i = 0; i < numberOfElements; i++) {
-    const double x_value = x[i];
-    const double y_value = y[i];
+    histogram.add(x[i], y[i]);
+  }
 
-    if (notInXLimit(x_value) || notInYLimit(y_value)) {
-      continue;
-    }
+  const auto columns = histogram.x().size();
+  std::vector<std::vector<int>> result;
+  result.reserve(histogram.y().size());
+  for (auto row = histogram.counts().begin(); row != histogram.counts().end();
+       row += static_cast<long>(columns)) {
+    result.emplace_back(row, row + static_cast<long>(columns));
+  }
+  return result;
+}
+
+Axis::Axis(const double min, const double max, const int bins)
+    : Axis(min, constructEdges(min, max, bins)) {}
 
-    const auto xEdge =
-        std::find_if(xEdges.begin(), xEdges.end(),
-                     [&](const auto& edge) { return x_value <= edge; });
-    assert(xEdge != xEdges.end());
-    const auto yEdge =
-        std::find_if(yEdges.begin(), yEdges.end(),
-                     [&](const auto& edge) { return y_value <= edge; });
-    assert(yEdge != yEdges.end());
-
-    const auto xIndex = static_cast<size_t>(xEdge - xEdges.begin());
-    const auto yIndex = static_cast<size_t>(yEdge - yEdges.begin());
-    ++result[yIndex][xIndex];
+Axis::Axis(const double min, std::vector<double> edges)
+    : min_(min), edges_(std::move(edges)) {
+  if (!std::is_sorted(edges_.begin(), edges_.end()) ||
+      (!edges_.empty() && edges_.front() < min_)) {
+    throw cpet::value_error("Histogram edges should increase from the minimum");
   }
+  detectUniform_();
+}
 
-  return result;
+void Axis::detectUniform_() {
+  if (edges_.empty()) {
+    return;
+  }
+  const double width =
+      (edges_.back() - min_) / static_cast<double>(edges_.size());
+  if (width <= 0.0) {
+    return;
+  }
+  /* Edges a bin is off would make the correction in index() linear */
+  constexpr double TOLERANCE = 1e-6;
+  for (size_t i = 0; i < edges_.size(); i++) {
+    const double expected = min_ + static_cast<double>(i + 1) * width;
+    if (std::abs(edges_[i] - expected) > TOLERANCE * width) {
+      return;
+    }
+  }
+  uniform_ = true;
+  inverseWidth_ = 1.0 / width;
 }
 
 }  // namespace cpet::histo
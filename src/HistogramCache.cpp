@@ -0,0 +1,169 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "HistogramCache.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "MappedFile.h"
+#include "OutputFormat.h"
+
+namespace cpet {
+
+constexpr std::string_view HISTOGRAM_CACHE_MAGIC = "CPETHST1";
+
+namespace {
+/* Cached distances are reused exactly as they were computed */
+OutputFormat cacheFormat() {
+  OutputFormat result;
+  result.encoding = OutputFormat::Encoding::binary;
+  result.precision = OutputFormat::Precision::float64;
+  return result;
+}
+
+std::string binsKey(const std::array<int, 2>& bins) {
+  return "Bins: " + std::to_string(bins[0]) + 'x' + std::to_string(bins[1]);
+}
+
+[[nodiscard]] bool sameLimits(const HistogramLimits& a,
+                              const HistogramLimits& b) noexcept {
+  return a.distance == b.distance && a.curvature == b.curvature;
+}
+}  // namespace
+
+HistogramCache::HistogramCache(std::string file,
+                               const std::array<int, 2>& bins,
+                               const std::optional<HistogramLimits>& limits)
+    : file_(std::move(file)), bins_(bins) {
+  if (std::filesystem::exists(file_) && std::filesystem::file_size(file_) > 0 &&
+      !load_(limits)) {
+    SPDLOG_WARN("Histogram cache {} was written for other bins or limits; "
+                "recomputing every frame",
+                file_);
+    clear();
+  }
+}
+
+void HistogramCache::clear() {
+  limits_.reset();
+  histograms_ = histo::HistogramMatrix{};
+  matrix_ = histo::DistanceMatrix{0};
+  end_ = 0;
+}
+
+void HistogramCache::append(const histo::HistogramMatrix& histograms,
+                            const HistogramLimits& limits,
+                            util::ThreadPool& pool) {
+  assert(frames() == 0 || sameLimits(*limits_, limits));
+  const size_t bins = binCount_();
+  if (histograms.rows() > 0 && histograms.bins() != bins) {
+    throw cpet::value_error("Histograms do not have the bins of cache " +
+                            file_);
+  }
+  const size_t cached = this->frames();
+  histo::HistogramMatrix all{cached + histograms.rows(), bins};
+  std::copy(histograms_.row(0), histograms_.row(cached), all.row(0));
+  std::copy(histograms.row(0), histograms.row(histograms.rows()),
+            all.row(cached));
+  histo::extendChiDistanceMatrix(all, matrix_, pool);
+  histograms_ = std::move(all);
+
+  util::BinaryWriter writer;
+  if (cached == 0) {
+    limits_ = limits;
+    cacheFormat().writeHeader(writer, HISTOGRAM_CACHE_MAGIC);
+    writer.writeString(binsKey(bins_));
+    for (const auto value : {limits.distance[0], limits.distance[1],
+                             limits.curvature[0], limits.curvature[1]}) {
+      writer.writeDouble(value);
+    }
+  }
+  std::vector<double> record;
+  for (size_t frame = cached; frame < histograms_.rows(); frame++) {
+    record.assign(histograms_.row(frame), histograms_.row(frame + 1));
+    for (size_t other = 0; other < frame; other++) {
+      record.push_back(matrix_(other, frame));
+    }
+    cacheFormat().writeReals(writer, record);
+  }
+
+  /* Records after the last complete one are overwritten */
+  if (cached > 0) {
+    std::filesystem::resize_file(file_, end_);
+  }
+  std::ofstream out{file_, std::ios::out | std::ios::binary |
+                               (cached == 0 ? std::ios::trunc : std::ios::app)};
+  out.write(writer.buffer().data(),
+            static_cast<std::streamsize>(writer.buffer().size()));
+  out.flush();
+  if (!out.good()) {
+    SPDLOG_ERROR("Could not write histogram cache {}", file_);
+    throw cpet::io_error("Could not write histogram cache " + file_);
+  }
+  end_ += writer.buffer().size();
+}
+
+bool HistogramCache::load_(const std::optional<HistogramLimits>& fixed) {
+  const util::MappedFile mapped{file_};
+  util::BinaryCursor cursor{mapped.view(), util::BinaryCursor::Endian::little};
+  const auto format = OutputFormat::readHeader(cursor, HISTOGRAM_CACHE_MAGIC);
+  if (cursor.readString() != binsKey(bins_)) {
+    return false;
+  }
+  HistogramLimits limits{};
+  limits.distance = {cursor.readDouble(), cursor.readDouble()};
+  limits.curvature = {cursor.readDouble(), cursor.readDouble()};
+  if (fixed && !sameLimits(*fixed, limits)) {
+    return false;
+  }
+
+  const size_t bins = binCount_();
+  std::vector<std::vector<double>> records;
+  size_t end = cursor.offset();
+  while (!cursor.atEnd()) {
+    try {
+      auto record = format.readReals(cursor);
+      if (record.size() != bins + records.size()) {
+        throw cpet::io_error("Malformed record in histogram cache " + file_);
+      }
+      records.push_back(std::move(record));
+      end = cursor.offset();
+    } catch (const cpet::io_error&) {
+      SPDLOG_WARN("Dropping the incomplete last record of histogram cache {}",
+                  file_);
+      break;
+    }
+  }
+
+  if (!records.empty()) {
+    limits_ = limits;
+  }
+  histograms_ = histo::HistogramMatrix{records.size(), bins};
+  matrix_ = histo::DistanceMatrix{records.size()};
+  for (size_t frame = 0; frame < records.size(); frame++) {
+    const auto& record = records[frame];
+    std::copy(record.begin(), record.begin() + static_cast<long>(bins),
+              histograms_.row(frame));
+    for (size_t other = 0; other < frame; other++) {
+      matrix_.upper(other, frame) = record[bins + other];
+    }
+  }
+  end_ = end;
+  SPDLOG_INFO("Loaded {} frames from histogram cache {}", records.size(),
+              file_);
+  return true;
+}
+
+}  // namespace cpet
@@ -0,0 +1,98 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "Instrumentation.h"
+
+/* C++ STL HEADER FILES */
+#include <fstream>
+#include <string_view>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet::util {
+
+namespace {
+constexpr std::array<const char*, static_cast<size_t>(Profiler::Counter::count)>
+    COUNTER_NAMES{"frames_read",           "samples",
+                  "samples_left_volume",   "samples_reached_length",
+                  "integration_steps",     "field_evaluations"};
+
+bool endsWith(const std::string_view str, const std::string_view suffix) {
+  return str.size() >= suffix.size() &&
+         str.substr(str.size() - suffix.size()) == suffix;
+}
+}  // namespace
+
+Profiler& Profiler::instance() noexcept {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::addTime(const std::string& stage, const double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = stages_[stage];
+  entry.seconds += seconds;
+  ++entry.calls;
+}
+
+std::map<std::string, Profiler::Stage> Profiler::stages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stages_;
+}
+
+void Profiler::writeReport(const std::string& file) const {
+  std::ofstream out(file, std::ios::out);
+  if (!out.is_open()) {
+    throw cpet::io_error("Could not open file " + file);
+  }
+
+  const auto allStages = stages();
+  const auto samples = count(Counter::samples);
+  const double stepsPerSample =
+      (samples == 0) ? 0.0
+                     : static_cast<double>(count(Counter::integrationSteps)) /
+                           static_cast<double>(samples);
+
+  if (endsWith(file, ".csv")) {
+    out << "kind,name,value,calls\n";
+    for (const auto& [name, stage] : allStages) {
+      out << "stage," << name << ',' << stage.seconds << ',' << stage.calls
+          << '\n';
+    }
+    for (size_t i = 0; i < COUNTER_NAMES.size(); i++) {
+      out << "counter," << COUNTER_NAMES[i] << ','
+          << counters_[i].load(std::memory_order_relaxed) << ",\n";
+    }
+    out << "derived,steps_per_sample," << stepsPerSample << ",\n";
+  } else {
+    out << "{\n  \"stages\": {";
+    const char* separator = "\n";
+    for (const auto& [name, stage] : allStages) {
+      out << separator << "    \"" << name << "\": {\"seconds\": "
+          << stage.seconds << ", \"calls\": " << stage.calls << '}';
+      separator = ",\n";
+    }
+    out << "\n  },\n  \"counters\": {";
+    separator = "\n";
+    for (size_t i = 0; i < COUNTER_NAMES.size(); i++) {
+      out << separator << "    \"" << COUNTER_NAMES[i]
+          << "\": " << counters_[i].load(std::memory_order_relaxed);
+      separator = ",\n";
+    }
+    out << "\n  },\n  \"steps_per_sample\": " << stepsPerSample << "\n}\n";
+  }
+  if (!out.good()) {
+    throw cpet::io_error("Could not write profile " + file);
+  }
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stages_.clear();
+  for (auto& counter : counters_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace cpet::util
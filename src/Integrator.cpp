@@ -0,0 +1,419 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "Integrator.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/fmt/ostr.h>
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "ElectricField.h"
+#include "Instrumentation.h"
+#include "VolumeVisit.h"
+
+namespace cpet::streamline {
+
+namespace {
+/* Curvature of the field line through position, from the field and its
+ * gradient */
+[[nodiscard]] double curvatureAt(const Eigen::Vector3d& position,
+                                 const FieldEvaluator& field) noexcept {
+  SPDLOG_DEBUG("Calculating curvature of field at {}", position.transpose());
+  return field::curvature(field.gradientAt(position));
+}
+
+/* Unit tangent of the field line through position */
+inline Eigen::Vector3d tangent(const FieldEvaluator& field,
+                               const Eigen::Vector3d& position) noexcept {
+  return field(position).normalized();
+}
+
+inline Eigen::Vector3d rk4Step(const FieldEvaluator& field,
+                               const Eigen::Vector3d& y, const double h) {
+  const Eigen::Vector3d k1 = tangent(field, y);
+  const Eigen::Vector3d k2 = tangent(field, y + 0.5 * h * k1);
+  const Eigen::Vector3d k3 = tangent(field, y + 0.5 * h * k2);
+  const Eigen::Vector3d k4 = tangent(field, y + h * k3);
+  return y + h / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+}
+
+struct AdaptiveStep {
+  Eigen::Vector3d position;
+  /* Tangent at position; first stage of the next step */
+  Eigen::Vector3d tangent;
+  double error;
+};
+
+/* Dormand-Prince 5(4) step from y with y' = k1. The last stage is evaluated
+ * at the new position, so accepted steps cost six evaluations. */
+AdaptiveStep dormandPrinceStep(const FieldEvaluator& field,
+                               const Eigen::Vector3d& y,
+                               const Eigen::Vector3d& k1, const double h) {
+  const Eigen::Vector3d k2 = tangent(field, y + h * (1.0 / 5.0) * k1);
+  const Eigen::Vector3d k3 =
+      tangent(field, y + h * (3.0 / 40.0 * k1 + 9.0 / 40.0 * k2));
+  const Eigen::Vector3d k4 = tangent(
+      field, y + h * (44.0 / 45.0 * k1 - 56.0 / 15.0 * k2 + 32.0 / 9.0 * k3));
+  const Eigen::Vector3d k5 = tangent(
+      field, y + h * (19372.0 / 6561.0 * k1 - 25360.0 / 2187.0 * k2 +
+                      64448.0 / 6561.0 * k3 - 212.0 / 729.0 * k4));
+  const Eigen::Vector3d k6 = tangent(
+      field, y + h * (9017.0 / 3168.0 * k1 - 355.0 / 33.0 * k2 +
+                      46732.0 / 5247.0 * k3 + 49.0 / 176.0 * k4 -
+                      5103.0 / 18656.0 * k5));
+  const Eigen::Vector3d next =
+      y + h * (35.0 / 384.0 * k1 + 500.0 / 1113.0 * k3 + 125.0 / 192.0 * k4 -
+               2187.0 / 6784.0 * k5 + 11.0 / 84.0 * k6);
+  const Eigen::Vector3d k7 = tangent(field, next);
+
+  /* Difference between the fifth and embedded fourth order solutions */
+  const Eigen::Vector3d error =
+      h * (71.0 / 57600.0 * k1 - 71.0 / 16695.0 * k3 + 71.0 / 1920.0 * k4 -
+           17253.0 / 339200.0 * k5 + 22.0 / 525.0 * k6 - 1.0 / 40.0 * k7);
+  return {next, k7, error.norm()};
+}
+
+template <class Region>
+Trace traceFixed(const FieldEvaluator& field, const Region& region,
+                 const Eigen::Vector3d& start, const double maxLength,
+                 const double stepSize, const Integrator::Type type) {
+  const size_t evaluationsPerStep = (type == Integrator::Type::rk4) ? 4 : 1;
+  Trace result{start, 0.0, 0};
+  while (region.isInside(result.position) && result.length < maxLength) {
+    const double h = std::min(stepSize, maxLength - result.length);
+    if (type == Integrator::Type::rk4) {
+      result.position = rk4Step(field, result.position, h);
+    } else {
+      result.position += h * tangent(field, result.position);
+    }
+    result.length += h;
+    result.evaluations += evaluationsPerStep;
+    ++result.steps;
+  }
+  return result;
+}
+
+template <class Region>
+Trace traceAdaptive(const FieldEvaluator& field, const Region& region,
+                    const Eigen::Vector3d& start, const double maxLength,
+                    const double stepSize, const double tolerance) {
+  /* Steps never shrink below this fraction of stepSize, so singular points
+   * of the field cannot stall the trace */
+  constexpr double MIN_STEP_FRACTION = 1e-3;
+  constexpr double SAFETY = 0.9;
+  constexpr double MIN_SCALE = 0.2;
+  constexpr double MAX_SCALE = 5.0;
+  constexpr int STAGES = 6;
+
+  const double minStep = MIN_STEP_FRACTION * stepSize;
+  /* Keeps a single step from skipping over a corner of the region */
+  const double maxStep = std::max(stepSize, 0.1 * region.maxDim());
+
+  Trace result{start, 0.0, 1};
+  Eigen::Vector3d k1 = tangent(field, start);
+  double h = stepSize;
+
+  while (region.isInside(result.position) && result.length < maxLength) {
+    h = std::min(h, maxLength - result.length);
+    const auto step = dormandPrinceStep(field, result.position, k1, h);
+    result.evaluations += STAGES;
+
+    const double scale =
+        (step.error > 0.0)
+            ? std::clamp(SAFETY * std::pow(tolerance / step.error, 0.2),
+                         MIN_SCALE, MAX_SCALE)
+            : MAX_SCALE;
+
+    if (step.error > tolerance && h > minStep) {
+      h = std::max(minStep, h * scale);
+      continue;
+    }
+    /* Resolve the exit to the fixed step size, as Euler would */
+    if (h > stepSize && !region.isInside(step.position)) {
+      h = std::max(stepSize, 0.5 * h);
+      continue;
+    }
+
+    result.position = step.position;
+    result.length += h;
+    ++result.steps;
+    k1 = step.tangent;
+    h = std::min(maxStep, h * scale);
+  }
+  return result;
+}
+
+/* Unit tangents at every point of a packet */
+inline void tangents(const FieldEvaluator& field,
+                     const field::PointPacket& positions,
+                     field::PointPacket& result) noexcept {
+  field(positions, result);
+  for (auto& direction : result) {
+    direction = direction.normalized();
+  }
+}
+
+/* The lanes of a packet of fixed-step traces */
+template <class Region>
+class FixedPacket {
+ public:
+  FixedPacket(const Region& region, const Start* starts, size_t count,
+              Trace* traces) noexcept
+      : region_(region), starts_(starts), count_(count), traces_(traces) {
+    for (size_t lane = 0; lane < field::PACKET_SIZE; ++lane) {
+      refill_(lane);
+    }
+  }
+
+  [[nodiscard]] inline bool empty() const noexcept { return active_ == 0; }
+
+  /* Gives idle lanes the position of a busy one, so the packet kernel only
+   * sees points a real trace could have asked for; their fields are
+   * discarded */
+  inline void padIdle(field::PointPacket& positions) const noexcept {
+    size_t busy = 0;
+    while (!lanes_[busy].active) {
+      ++busy;
+    }
+    for (size_t lane = 0; lane < field::PACKET_SIZE; ++lane) {
+      if (!lanes_[lane].active) {
+        positions[lane] = positions[busy];
+      }
+    }
+  }
+
+  [[nodiscard]] inline const Eigen::Vector3d& position(
+      size_t lane) const noexcept {
+    return lanes_[lane].trace.position;
+  }
+
+  /* The step traceFixed would take next */
+  [[nodiscard]] inline double stepFor(size_t lane,
+                                      double stepSize) const noexcept {
+    const auto& current = lanes_[lane];
+    return std::min(stepSize, current.maxLength - current.trace.length);
+  }
+
+  /* Moves an active lane to next after a step of length h, finishing its
+   * trace and refilling the lane once it left the region or is long enough */
+  inline void advance(size_t lane, const Eigen::Vector3d& next, double h,
+                      size_t evaluations) noexcept {
+    auto& current = lanes_[lane];
+    if (!current.active) {
+      return;
+    }
+    current.trace.position = next;
+    current.trace.length += h;
+    current.trace.evaluations += evaluations;
+    ++current.trace.steps;
+    if (!continues_(current)) {
+      traces_[current.line] = current.trace;
+      current.active = false;
+      --active_;
+      refill_(lane);
+    }
+  }
+
+ private:
+  struct Lane {
+    size_t line{0};
+    double maxLength{0.0};
+    Trace trace{Eigen::Vector3d::Zero(), 0.0, 0};
+    bool active{false};
+  };
+
+  [[nodiscard]] inline bool continues_(const Lane& lane) const noexcept {
+    return region_.isInside(lane.trace.position) &&
+           lane.trace.length < lane.maxLength;
+  }
+
+  /* Starts the next line that takes at least one step in lane; lines that
+   * start outside the region are finished right away */
+  inline void refill_(size_t lane) noexcept {
+    auto& current = lanes_[lane];
+    while (next_ < count_) {
+      current.line = next_++;
+      current.maxLength = starts_[current.line].maxLength;
+      current.trace = Trace{starts_[current.line].position, 0.0, 0};
+      if (continues_(current)) {
+        current.active = true;
+        ++active_;
+        return;
+      }
+      traces_[current.line] = current.trace;
+    }
+  }
+
+  const Region& region_;
+  const Start* starts_;
+  size_t count_;
+  Trace* traces_;
+  size_t next_{0};
+  size_t active_{0};
+  std::array<Lane, field::PACKET_SIZE> lanes_{};
+};
+
+/* traceFixed for a whole packet; the per-lane arithmetic is the same */
+template <class Region>
+void tracePacketsFixed(const FieldEvaluator& field, const Region& region,
+                       const Start* starts, const size_t count,
+                       const double stepSize, const Integrator::Type type,
+                       Trace* traces) {
+  constexpr size_t LANES = field::PACKET_SIZE;
+  const bool rk4 = (type == Integrator::Type::rk4);
+  const size_t evaluationsPerStep = rk4 ? 4 : 1;
+
+  FixedPacket<Region> packet{region, starts, count, traces};
+  std::array<double, LANES> h{};
+  field::PointPacket y;
+  field::PointPacket stage;
+  field::PointPacket k1;
+  field::PointPacket k2;
+  field::PointPacket k3;
+  field::PointPacket k4;
+
+  while (!packet.empty()) {
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      y[lane] = packet.position(lane);
+      h[lane] = packet.stepFor(lane, stepSize);
+    }
+    packet.padIdle(y);
+    tangents(field, y, k1);
+
+    if (rk4) {
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        stage[lane] = y[lane] + 0.5 * h[lane] * k1[lane];
+      }
+      tangents(field, stage, k2);
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        stage[lane] = y[lane] + 0.5 * h[lane] * k2[lane];
+      }
+      tangents(field, stage, k3);
+      for (size_t lane = 0; lane < LANES; ++lane) {
+        stage[lane] = y[lane] + h[lane] * k3[lane];
+      }
+      tangents(field, stage, k4);
+    }
+
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      Eigen::Vector3d next = y[lane];
+      if (rk4) {
+        next = y[lane] + h[lane] / 6.0 *
+                             (k1[lane] + 2.0 * k2[lane] + 2.0 * k3[lane] +
+                              k4[lane]);
+      } else {
+        next += h[lane] * k1[lane];
+      }
+      packet.advance(lane, next, h[lane], evaluationsPerStep);
+    }
+  }
+}
+
+template <class Region>
+Trace traceIn(const FieldEvaluator& field, const Region& region,
+              const Eigen::Vector3d& start, const double maxLength,
+              const double stepSize, const Integrator& integrator) {
+  if (integrator.type == Integrator::Type::dormandprince) {
+    return traceAdaptive(field, region, start, maxLength, stepSize,
+                         integrator.tolerance);
+  }
+  return traceFixed(field, region, start, maxLength, stepSize,
+                    integrator.type);
+}
+
+template <class Region>
+void tracePacketsIn(const FieldEvaluator& field, const Region& region,
+                    const Start* starts, const size_t count,
+                    const double stepSize, const Integrator& integrator,
+                    Trace* traces) {
+  if (integrator.type == Integrator::Type::dormandprince) {
+    for (size_t i = 0; i < count; ++i) {
+      traces[i] = traceAdaptive(field, region, starts[i].position,
+                                starts[i].maxLength, stepSize,
+                                integrator.tolerance);
+    }
+    return;
+  }
+  tracePacketsFixed(field, region, starts, count, stepSize, integrator.type,
+                    traces);
+}
+
+template <class Region>
+void sampleTopologyIn(const FieldEvaluator& field, const Region& region,
+                      const double stepSize, const Integrator& integrator,
+                      const util::SampleStream& stream, const size_t first,
+                      const size_t count, PathSample* out) {
+  std::vector<Start> starts(count);
+  for (size_t i = 0; i < count; i++) {
+    auto random = stream.at(first + i);
+    starts[i].position = region.randomPoint(random);
+    starts[i].maxLength = stepSize * region.randomDistance(stepSize, random);
+  }
+
+  std::vector<Trace> traces(count);
+  tracePacketsIn(field, region, starts.data(), count, stepSize, integrator,
+                 traces.data());
+
+  auto& profiler = util::Profiler::instance();
+  for (size_t i = 0; i < count; i++) {
+    const Eigen::Vector3d& initialPosition = starts[i].position;
+    const auto& trace = traces[i];
+    const Eigen::Vector3d& finalPosition = trace.position;
+
+    profiler.add(util::Profiler::Counter::samples);
+    profiler.add(trace.length < starts[i].maxLength
+                     ? util::Profiler::Counter::samplesLeftVolume
+                     : util::Profiler::Counter::samplesReachedLength);
+    profiler.add(util::Profiler::Counter::integrationSteps, trace.steps);
+    profiler.add(util::Profiler::Counter::fieldEvaluations,
+                 trace.evaluations);
+
+    SPDLOG_DEBUG("Initial position {}", initialPosition.transpose());
+    SPDLOG_DEBUG("Final position: {}", finalPosition.transpose());
+    SPDLOG_DEBUG("Arc length: {}", trace.length);
+    SPDLOG_DEBUG("Field evaluations: {}", trace.evaluations);
+    SPDLOG_DEBUG("Distance between end and start: {}",
+                 (finalPosition - initialPosition).norm());
+
+    out[i] = {(finalPosition - initialPosition).norm(),
+              (curvatureAt(finalPosition, field) +
+               curvatureAt(initialPosition, field)) /
+                  2.0};
+  }
+}
+}  // namespace
+
+Trace trace(const FieldEvaluator& field, const Volume& region,
+            const Eigen::Vector3d& start, const double maxLength,
+            const double stepSize, const Integrator& integrator) {
+  return visitVolume(region, [&](const auto& concrete) {
+    return traceIn(field, concrete, start, maxLength, stepSize, integrator);
+  });
+}
+
+void tracePackets(const FieldEvaluator& field, const Volume& region,
+                  const Start* starts, const size_t count,
+                  const double stepSize, const Integrator& integrator,
+                  Trace* traces) {
+  visitVolume(region, [&](const auto& concrete) {
+    tracePacketsIn(field, concrete, starts, count, stepSize, integrator,
+                   traces);
+  });
+}
+
+void sampleTopology(const FieldEvaluator& field, const Volume& region,
+                    const double stepSize, const Integrator& integrator,
+                    const util::SampleStream& stream, const size_t first,
+                    const size_t count, PathSample* out) {
+  visitVolume(region, [&](const auto& concrete) {
+    sampleTopologyIn(field, concrete, stepSize, integrator, stream, first,
+                     count, out);
+  });
+}
+}  // namespace cpet::streamline
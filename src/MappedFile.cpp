@@ -0,0 +1,54 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "MappedFile.h"
+
+/* POSIX HEADER FILES */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet {
+namespace util {
+
+MappedFile::MappedFile(const std::string& file) {
+  const int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw cpet::io_error("Could not open file " + file);
+  }
+
+  struct stat status {};
+  if (::fstat(fd, &status) != 0) {
+    ::close(fd);
+    throw cpet::io_error("Could not stat file " + file);
+  }
+  size_ = static_cast<size_t>(status.st_size);
+
+  /* Mapping zero bytes is an error, but an empty file is just empty */
+  if (size_ > 0) {
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      ::close(fd);
+      throw cpet::io_error("Could not map file " + file);
+    }
+    /* Trajectories are read front to back once */
+    ::madvise(mapped, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapped);
+  }
+  /* The mapping stays valid after the descriptor is closed */
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+}  // namespace util
+}  // namespace cpet
@@ -0,0 +1,152 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "Octree.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+/* CPET HEADER FILES */
+#include "Constants.h"
+#include "ElectricField.h"
+
+namespace cpet {
+
+Octree::Octree(const PointChargeStore& charges, const size_t leafSize) {
+  if (charges.empty()) {
+    return;
+  }
+
+  Eigen::Vector3d lower = charges.coordinate(0);
+  Eigen::Vector3d upper = lower;
+  for (size_t i = 1; i < charges.size(); i++) {
+    lower = lower.cwiseMin(charges.coordinate(i));
+    upper = upper.cwiseMax(charges.coordinate(i));
+  }
+  const Eigen::Vector3d center = (lower + upper) / 2.0;
+  /* Slightly enlarged so that charges on the boundary fall inside */
+  const double halfWidth = 0.5 * (upper - lower).maxCoeff() * (1.0 + 1e-9) +
+                           std::numeric_limits<double>::epsilon();
+
+  std::vector<size_t> order(charges.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  nodes_.reserve(2 * charges.size() / std::max<size_t>(leafSize, 1) + 1);
+  build_(charges, order, 0, order.size(), center, halfWidth,
+         std::max<size_t>(leafSize, 1), 0);
+
+  for (const auto index : order) {
+    charges_.push_back(charges.coordinate(index), charges.q()[index]);
+  }
+}
+
+int32_t Octree::build_(const PointChargeStore& charges,
+                       std::vector<size_t>& order, const size_t begin,
+                       const size_t end, const Eigen::Vector3d& center,
+                       const double halfWidth, const size_t leafSize,
+                       const int depth) {
+  Node node{};
+  node.center = center;
+  node.halfWidth = halfWidth;
+  node.charge = 0.0;
+  node.dipole = Eigen::Vector3d::Zero();
+  node.quadrupole = Eigen::Matrix3d::Zero();
+  node.begin = begin;
+  node.end = end;
+  node.children.fill(-1);
+  node.leaf = (end - begin) <= leafSize || depth >= MAX_DEPTH;
+
+  for (size_t i = begin; i < end; i++) {
+    const auto q = charges.q()[order[i]];
+    const Eigen::Vector3d r = charges.coordinate(order[i]) - center;
+    node.charge += q;
+    node.dipole += q * r;
+    node.quadrupole += q * (3.0 * r * r.transpose() -
+                            r.squaredNorm() * Eigen::Matrix3d::Identity());
+  }
+
+  const auto index = static_cast<int32_t>(nodes_.size());
+  nodes_.push_back(node);
+  if (node.leaf) {
+    return index;
+  }
+
+  const auto octantOf = [&](const size_t chargeIndex) -> size_t {
+    const Eigen::Vector3d r = charges.coordinate(chargeIndex);
+    return static_cast<size_t>(r[0] >= center[0]) |
+           (static_cast<size_t>(r[1] >= center[1]) << 1U) |
+           (static_cast<size_t>(r[2] >= center[2]) << 2U);
+  };
+
+  /* Counting sort of this node's range by octant */
+  std::array<size_t, 9> offsets{};
+  for (size_t i = begin; i < end; i++) {
+    ++offsets[octantOf(order[i]) + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<size_t> sorted(end - begin);
+  auto cursor = offsets;
+  for (size_t i = begin; i < end; i++) {
+    sorted[cursor[octantOf(order[i])]++] = order[i];
+  }
+  std::copy(sorted.begin(), sorted.end(),
+            order.begin() + static_cast<std::ptrdiff_t>(begin));
+
+  const double childHalfWidth = halfWidth / 2.0;
+  for (size_t octant = 0; octant < 8; octant++) {
+    if (offsets[octant] == offsets[octant + 1]) {
+      continue;
+    }
+    const Eigen::Vector3d childCenter =
+        center + childHalfWidth * Eigen::Vector3d{(octant & 1U) ? 1.0 : -1.0,
+                                                  (octant & 2U) ? 1.0 : -1.0,
+                                                  (octant & 4U) ? 1.0 : -1.0};
+    const auto child = build_(charges, order, begin + offsets[octant],
+                              begin + offsets[octant + 1], childCenter,
+                              childHalfWidth, leafSize, depth + 1);
+    nodes_[static_cast<size_t>(index)].children[octant] = child;
+  }
+  return index;
+}
+
+Eigen::Vector3d Octree::electricFieldAt(const Eigen::Vector3d& position,
+                                        const double theta) const noexcept {
+  Eigen::Vector3d raw = Eigen::Vector3d::Zero();
+  if (nodes_.empty()) {
+    return raw;
+  }
+
+  /* Depth-first traversal; each level pushes at most 8 children */
+  std::array<int32_t, 8 * MAX_DEPTH + 1> stack{};
+  size_t top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const Node& node = nodes_[static_cast<size_t>(stack[--top])];
+    const Eigen::Vector3d r = position - node.center;
+    const double distance = r.norm();
+
+    if (2.0 * node.halfWidth < theta * distance) {
+      /* Far enough away: multipole expansion about the node center */
+      const double invR2 = 1.0 / (distance * distance);
+      const double invR3 = invR2 / distance;
+      const double invR5 = invR3 * invR2;
+      const Eigen::Vector3d Qr = node.quadrupole * r;
+      raw += node.charge * invR3 * r +
+             (3.0 * node.dipole.dot(r) * invR5 * r - invR3 * node.dipole) +
+             (2.5 * r.dot(Qr) * invR5 * invR2 * r - invR5 * Qr);
+    } else if (node.leaf) {
+      field::accumulateRange(charges_, node.begin, node.end, position, raw);
+    } else {
+      for (const auto child : node.children) {
+        if (child >= 0) {
+          stack[top++] = child;
+        }
+      }
+    }
+  }
+  return constants::TO_V_PER_ANG * raw;
+}
+}  // namespace cpet
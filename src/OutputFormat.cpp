@@ -0,0 +1,185 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "OutputFormat.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <limits>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <zlib.h>
+
+namespace cpet {
+
+namespace {
+/* Groups byte b of every element together. The high bytes of nearby
+ * reals are alike, which is what makes field arrays compress. */
+std::string shuffle(std::string_view raw, size_t width) {
+  const size_t count = raw.size() / width;
+  std::string result(raw.size(), '\0');
+  for (size_t i = 0; i < count; i++) {
+    for (size_t b = 0; b < width; b++) {
+      result[b * count + i] = raw[i * width + b];
+    }
+  }
+  return result;
+}
+
+std::string unshuffle(std::string_view shuffled, size_t width) {
+  const size_t count = shuffled.size() / width;
+  std::string result(shuffled.size(), '\0');
+  for (size_t i = 0; i < count; i++) {
+    for (size_t b = 0; b < width; b++) {
+      result[i * width + b] = shuffled[b * count + i];
+    }
+  }
+  return result;
+}
+
+/* uLong is narrower than size_t where long is 32 bits (LLP64); a template
+ * so that the narrowing branch is only compiled there */
+template <typename Size>
+uLong toZlibSize(Size size) {
+  if constexpr (sizeof(uLong) < sizeof(Size)) {
+    if (size > std::numeric_limits<uLong>::max()) {
+      throw cpet::io_error("Output chunk is too large for zlib");
+    }
+    return static_cast<uLong>(size);
+  } else {
+    return size;
+  }
+}
+
+std::string compressChunk(std::string_view raw, size_t width) {
+  const auto shuffled = shuffle(raw, width);
+  auto storedSize = ::compressBound(toZlibSize(shuffled.size()));
+  std::string result(storedSize, '\0');
+  /* Output is written as fast as it is computed */
+  if (::compress2(reinterpret_cast<Bytef*>(result.data()), &storedSize,
+                  reinterpret_cast<const Bytef*>(shuffled.data()),
+                  toZlibSize(shuffled.size()), Z_BEST_SPEED) != Z_OK) {
+    throw cpet::io_error("Could not compress output chunk");
+  }
+  result.resize(storedSize);
+  return result;
+}
+
+std::string uncompressChunk(std::string_view stored, size_t rawSize,
+                            size_t width) {
+  std::string shuffled(rawSize, '\0');
+  uLongf size = toZlibSize(rawSize);
+  if (::uncompress(reinterpret_cast<Bytef*>(shuffled.data()), &size,
+                   reinterpret_cast<const Bytef*>(stored.data()),
+                   toZlibSize(stored.size())) != Z_OK ||
+      size != rawSize) {
+    throw cpet::io_error("Corrupt compressed chunk in binary data");
+  }
+  return unshuffle(shuffled, width);
+}
+}  // namespace
+
+void OutputFormat::writeHeader(util::BinaryWriter& writer,
+                               std::string_view magic) const {
+  writer.writeBytes(magic);
+  writer.writeInt32(static_cast<int32_t>(bytesPerReal()));
+  writer.writeInt32(compressed ? 1 : 0);
+}
+
+void OutputFormat::writeReals(util::BinaryWriter& writer,
+                              const std::vector<double>& values) const {
+  writer.writeUInt64(values.size());
+  writeChunks(writer, values);
+}
+
+void OutputFormat::writeChunks(util::BinaryWriter& writer,
+                               const std::vector<double>& values) const {
+  const size_t width = bytesPerReal();
+  const size_t perChunk = OUTPUT_CHUNK_BYTES / width;
+  util::BinaryWriter chunk;
+  for (size_t begin = 0; begin < values.size(); begin += perChunk) {
+    const size_t end = std::min(begin + perChunk, values.size());
+    chunk.clear();
+    for (size_t i = begin; i < end; i++) {
+      if (precision == Precision::float32) {
+        chunk.writeFloat(static_cast<float>(values[i]));
+      } else {
+        chunk.writeDouble(values[i]);
+      }
+    }
+
+    const std::string_view raw = chunk.buffer();
+    std::string packed;
+    if (compressed) {
+      packed = compressChunk(raw, width);
+    }
+    /* Equal sizes mark a chunk that is stored as is */
+    const bool useCompressed = compressed && packed.size() < raw.size();
+    const std::string_view stored = useCompressed ? packed : raw;
+    writer.writeInt32(static_cast<int32_t>(raw.size()));
+    writer.writeInt32(static_cast<int32_t>(stored.size()));
+    writer.writeBytes(stored);
+  }
+}
+
+OutputFormat OutputFormat::readHeader(util::BinaryCursor& cursor,
+                                      std::string_view magic) {
+  if (cursor.readBytes(magic.size()) != magic) {
+    throw cpet::io_error("Binary data does not start with " +
+                         std::string{magic});
+  }
+  OutputFormat result;
+  result.encoding = Encoding::binary;
+  switch (cursor.readInt32()) {
+    case sizeof(float):
+      result.precision = Precision::float32;
+      break;
+    case sizeof(double):
+      result.precision = Precision::float64;
+      break;
+    default:
+      throw cpet::io_error("Unsupported precision in binary data");
+  }
+  result.compressed = (cursor.readInt32() != 0);
+  return result;
+}
+
+std::vector<double> OutputFormat::readReals(util::BinaryCursor& cursor) const {
+  const auto count = cursor.readUInt64();
+  const size_t width = bytesPerReal();
+
+  std::vector<double> result;
+  /* A corrupt count must not become a huge allocation */
+  result.reserve(static_cast<size_t>(
+      std::min<uint64_t>(count, cursor.remaining())));
+  while (result.size() < count) {
+    const auto rawSize = cursor.readInt32();
+    const auto storedSize = cursor.readInt32();
+    if (rawSize <= 0 || storedSize <= 0 || storedSize > rawSize ||
+        static_cast<size_t>(rawSize) % width != 0) {
+      throw cpet::io_error("Invalid chunk in binary data");
+    }
+    const auto stored = cursor.readBytes(static_cast<size_t>(storedSize));
+
+    std::string uncompressed;
+    std::string_view raw = stored;
+    if (storedSize < rawSize) {
+      uncompressed =
+          uncompressChunk(stored, static_cast<size_t>(rawSize), width);
+      raw = uncompressed;
+    }
+
+    util::BinaryCursor values{raw, util::BinaryCursor::Endian::little};
+    while (!values.atEnd()) {
+      result.push_back((precision == Precision::float32)
+                           ? static_cast<double>(values.readFloat())
+                           : values.readDouble());
+    }
+  }
+  if (result.size() != count) {
+    throw cpet::io_error("Chunk sizes do not match array length");
+  }
+  return result;
+}
+
+}  // namespace cpet
@@ -2,62 +2,118 @@
 // Distributed under the MIT License (http://opensource.org/licenses/MIT)
 
 /* C++ STL HEADER FILES */
+#include <algorithm>
 #include <array>
-#include <cmath>
+#include <optional>
 
 /* EXTERNAL LIBRARY HEADER FILES */
-#include <cs_plain_guarded.h>
 #include <spdlog/fmt/ostr.h>
-#include <spdlog/sinks/stdout_sinks.h>
 
 /* CPET HEADER FILES */
+#include "Box.h"
+#include "ElectricField.h"
 #include "Instrumentation.h"
-#include "RAIIThread.h"
 #include "System.h"
 
 namespace cpet {
 
-System::System(Frame frame, const Option& options)
-    : frame_(std::move(frame)), pointCharges_(frame_.begin(), frame_.end()) {
-  if (options.centerID().position()) {
-    center_ = *(options.centerID().position());
-  } else {
-    center_ = frame_.find(options.centerID())->coordinate;
+namespace {
+/* The GPU kernels trace the box of a topology block with the step rules of
+ * streamline::trace */
+gpu::TraceSettings gpuTraceSettings(const Volume& volume, const double stepSize,
+                                    const Integrator& integrator) {
+  const auto* box = dynamic_cast<const Box*>(&volume);
+  if (box == nullptr) {
+    throw cpet::value_error("GPU topology sampling supports box volumes only");
   }
+  gpu::TraceSettings settings;
+  switch (integrator.type) {
+    case Integrator::Type::rk4:
+      settings.method = gpu::TraceSettings::Method::rk4;
+      break;
+    case Integrator::Type::dormandprince:
+      settings.method = gpu::TraceSettings::Method::dormandprince;
+      break;
+    case Integrator::Type::euler:
+    default:
+      settings.method = gpu::TraceSettings::Method::euler;
+  }
+  settings.tolerance = integrator.tolerance;
+  settings.stepSize = stepSize;
+  settings.maxStep = std::max(stepSize, 0.1 * box->maxDim());
+  /* The range Box::randomDistance draws from */
+  settings.maxSteps = static_cast<int>(box->diagonal() / stepSize);
+  for (Eigen::Index i = 0; i < 3; i++) {
+    settings.center[static_cast<size_t>(i)] = box->center()[i];
+    settings.halfWidths[static_cast<size_t>(i)] = box->halfExtents()[i];
+  }
+  return settings;
+}
 
-  std::array<Eigen::Vector3d, 3> basis;
-
-  if (options.direction1ID().position()) {
-    if (options.direction1ID().isConstant()) {
-      SPDLOG_DEBUG("Using constant direction for direction 1");
-      basis[0] = *(options.direction1ID().position());
-    } else {
-      SPDLOG_DEBUG("Using user defined vector for direction 1");
-      basis[0] = *(options.direction1ID().position()) - center_;
-    }
-  } else {
-    basis[0] = frame_.find(options.direction1ID())->coordinate - center_;
+std::vector<PathSample> countedSamples(
+    const std::vector<gpu::TracedSample>& traced) {
+  std::vector<PathSample> result;
+  result.reserve(traced.size());
+  size_t reachedLength = 0;
+  size_t steps = 0;
+  size_t evaluations = 0;
+  for (const auto& sample : traced) {
+    result.push_back(sample.sample);
+    reachedLength += sample.reachedLength ? 1 : 0;
+    steps += sample.steps;
+    evaluations += sample.evaluations;
   }
-  SPDLOG_DEBUG("Basis[0] is {}", basis[0].transpose());
-  basis[0] = basis[0] / basis[0].norm();
-  SPDLOG_DEBUG("Normalized, basis[0] is {}", basis[0].transpose());
+  auto& profiler = util::Profiler::instance();
+  profiler.add(util::Profiler::Counter::samples, traced.size());
+  profiler.add(util::Profiler::Counter::samplesLeftVolume,
+               traced.size() - reachedLength);
+  profiler.add(util::Profiler::Counter::samplesReachedLength, reachedLength);
+  profiler.add(util::Profiler::Counter::integrationSteps, steps);
+  profiler.add(util::Profiler::Counter::fieldEvaluations, evaluations);
+  return result;
+}
+}  // namespace
 
-  if (options.direction2ID().position()) {
-    if (options.direction2ID().isConstant()) {
-      SPDLOG_DEBUG("Using constant direction for direction 2");
-      basis[1] = *(options.direction2ID().position());
-    } else {
-      SPDLOG_DEBUG("Using user defined vector for direction 2");
-      basis[1] = *(options.direction2ID().position()) - center_;
-    }
-  } else {
-    basis[1] = frame_.find(options.direction2ID())->coordinate - center_;
+System::System(Frame frame, const Eigen::Vector3d& center,
+               const Eigen::Matrix3d& basis, const bool useOctree)
+    : System(std::move(frame), center, basis, useOctree, Deferred{}) {
+  buildChargeStore_();
+}
+
+System System::inUserSpace(Frame frame, const Eigen::Vector3d& center,
+                           const Eigen::Matrix3d& basis, const bool useOctree,
+                           const Device& device) {
+  System result{std::move(frame), center, basis, useOctree, Deferred{}};
+  result.translateSystemToCenter_();
+  result.transformToUserBasis_();
+  result.buildChargeStore_();
+  result.useDevice(device);
+  return result;
+}
+
+System::System(Frame frame, const Eigen::Vector3d& center,
+               const Eigen::Matrix3d& basis, const bool useOctree, Deferred)
+    : frame_(std::move(frame)),
+      useOctree_(useOctree),
+      center_(center),
+      basisMatrix_(basis) {
+  if (basisMatrix_.determinant() == 0) {
+    SPDLOG_ERROR("Basis is not linearly independent");
+    throw cpet::value_error("Basis is not linearly independent");
   }
-  SPDLOG_DEBUG("Basis[1] is {}", basis[1].transpose());
-  basis[1] = basis[1] / basis[1].norm();
-  SPDLOG_DEBUG("Normalized, basis[1] is {}", basis[1].transpose());
+}
+
+Eigen::Matrix3d System::orthonormalBasis(const Eigen::Vector3d& direction1,
+                                         const Eigen::Vector3d& direction2) {
+  std::array<Eigen::Vector3d, 3> basis{direction1 / direction1.norm(),
+                                       direction2 / direction2.norm(),
+                                       Eigen::Vector3d::Zero()};
+  SPDLOG_DEBUG("Constructing orthonormal basis...");
+  basis[2] = basis[0].cross(basis[1]);
+  basis[1] = basis[2].cross(basis[0]);
 
-  constructOrthonormalBasis_(basis);
+  basis[2] = basis[2] / basis[2].norm();
+  basis[1] = basis[1] / basis[1].norm();
 
   SPDLOG_DEBUG("Final Basis Vectors:");
 #if SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_DEBUG
@@ -66,157 +122,276 @@ System::System(Frame frame, const Option& options)
   }
 #endif
 
-  SPDLOG_DEBUG("Constructing basis matrix...");
+  Eigen::Matrix3d result;
   for (size_t i = 0; i < basis.size(); i++) {
-    basisMatrix_.block(0, static_cast<Eigen::Index>(i), 3, 1) = basis.at(i);
+    result.block(0, static_cast<Eigen::Index>(i), 3, 1) = basis.at(i);
   }
-  if (basisMatrix_.determinant() == 0) {
+  if (result.determinant() == 0) {
     SPDLOG_ERROR("Basis is not linearly independent");
     throw cpet::value_error("Basis is not linearly independent");
   }
-
-  SPDLOG_DEBUG("Removing point charges with charge of 0...");
-  pointCharges_.erase(remove_if(begin(pointCharges_), end(pointCharges_),
-                                [](const auto& p) { return p.charge == 0.0; }),
-                      end(pointCharges_));
+  return result;
 }
 
 Eigen::Vector3d System::electricFieldAt(const Eigen::Vector3d& position) const {
-  Eigen::Vector3d result(0, 0, 0);
-  constexpr double PERM_SPACE = 0.0055263495;
-  constexpr double TO_V_PER_ANG = (1.0 / (4.0 * M_PI * PERM_SPACE));
-
-  /* If we can speed this up, we should!! */
-  for (const auto& pc : pointCharges_) {
-    const Eigen::Vector3d d = (position - pc.coordinate);
-    const auto dNorm = d.norm();
-    result += ((pc.charge * d) / (dNorm * dNorm * dNorm));
-  }
-  result *= TO_V_PER_ANG;
-  return result;
+  return field::electricFieldAt(chargeStore_, position);
 }
 
-std::vector<PathSample> System::electricFieldTopologyIn(
-    int numOfThreads, const Volume& volume, const double stepsize,
-    const int numberOfSamples) const {
-  std::vector<PathSample> sampleResults;
-  sampleResults.reserve(static_cast<size_t>(numberOfSamples));
+Eigen::Vector3d System::electricFieldAt(const Eigen::Vector3d& position,
+                                        const FieldSolver& solver) const {
+  return fieldEvaluator(solver)(position);
+}
 
-  std::shared_ptr<spdlog::logger> thread_logger;
-  if (!(thread_logger = spdlog::get("Thread"))) {
-    thread_logger = spdlog::stdout_logger_mt("Thread");
+FieldEvaluator System::fieldEvaluator(const FieldSolver& solver) const {
+  /* The octree is only built when some block of the option file asks for
+   * it; anything else gets the exact sum */
+  if (solver.type == FieldSolver::Type::barneshut && useOctree_) {
+    return {octree_, solver.theta};
   }
+  return FieldEvaluator{chargeStore_};
+}
 
-  if (numOfThreads == 1) {
-    SPDLOG_DEBUG("Single thread...");
-    int samples = numberOfSamples;
-    while (samples-- > 0) {
-      sampleResults.emplace_back(
-          sampleElectricFieldTopologyIn_(volume, stepsize));
-    }
-    SPDLOG_INFO("{} Points calculated", numberOfSamples);
-  } else {
-    SPDLOG_DEBUG("Multi-threads: {}", numOfThreads);
-#if SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_DEBUG
-    thread_logger->set_pattern("[Thread: %t] [%l] %v");
-#else
-    thread_logger->set_pattern("[Thread: %t] ==>> %v");
-#endif
+FieldEvaluator System::fieldEvaluator(const FieldSolver& solver,
+                                      const Volume& region) const {
+  if (solver.type == FieldSolver::Type::multipole) {
+    FarFieldExpansion expansion{
+        chargeStore_, region.center(),
+        solver.nearFieldFactor * region.boundingRadius()};
+    SPDLOG_DEBUG("Far-field expansion: {} near charges, {} far charges",
+                 expansion.numberOfNearCharges(),
+                 expansion.numberOfFarCharges());
+    return FieldEvaluator{std::move(expansion)};
+  }
+  return fieldEvaluator(solver);
+}
 
-    /* Initialize thread-safe data types */
-    SPDLOG_DEBUG("Initializing data structures...");
-    std::atomic_int samples = numberOfSamples;
-    libguarded::plain_guarded<std::vector<PathSample>> shared_vector;
-    {
-      auto sharedVectorHandle = shared_vector.lock();
-      sharedVectorHandle->reserve(static_cast<size_t>(numberOfSamples));
-    }
+std::vector<Eigen::Vector3d> System::electricFieldAt(
+    const std::vector<Eigen::Vector3d>& positions) const {
+  std::vector<Eigen::Vector3d> results(positions.size());
+  field::electricFieldAt(chargeStore_, positions.data(), positions.size(),
+                         results.data());
+  return results;
+}
 
-    SPDLOG_INFO("====[Initializing threads]====");
-    {
-      const auto thread_work = [&, this]() {
-        auto this_thread_logger = spdlog::get("Thread");
-        this_thread_logger->info("Spinning up...");
-        int completed = 0;
-        while (samples-- > 0) {
-          auto s = sampleElectricFieldTopologyIn_(volume, stepsize);
-          {
-            auto vector_handler = shared_vector.lock();
-            vector_handler->push_back(s);
-          }
-          completed++;
-        }
-        this_thread_logger->info("{} Points calculated", completed);
-      };
-
-      std::vector<util::RAIIThread> workers;
-      workers.reserve(static_cast<size_t>(numOfThreads));
-      for (int i = 0; i < numOfThreads; i++) {
-        workers.emplace_back(thread_work);
-      }
-    }
-    SPDLOG_DEBUG("Gathering results from shared vector");
-    sampleResults = *(shared_vector.lock());
+std::vector<Eigen::Vector3d> System::electricFieldAt(
+    const std::vector<Eigen::Vector3d>& positions,
+    const FieldSolver& solver) const {
+  if (solver.type == FieldSolver::Type::direct) {
+    return electricFieldAt(positions);
   }
-  return sampleResults;
+  const auto field = fieldEvaluator(solver);
+  std::vector<Eigen::Vector3d> results;
+  results.reserve(positions.size());
+  std::transform(positions.begin(), positions.end(),
+                 std::back_inserter(results), field);
+  return results;
 }
 
-PathSample System::sampleElectricFieldTopologyIn_(const Volume& region,
-                                                  const double stepSize) const
-    noexcept(true) {
-  /* This is not thread-safe, however, implementation is thread-safe */
-  const Eigen::Vector3d initialPosition = region.randomPoint();
-  /* This is not thread-safe, however, implementation is thread-safe */
-  const int maxSteps = region.randomDistance(stepSize);
-
-  Eigen::Vector3d finalPosition = initialPosition;
-  SPDLOG_DEBUG("Initial position {}", initialPosition.transpose());
-  int steps = 0;
+std::vector<Eigen::Vector3d> System::electricFieldAt(
+    const std::vector<Eigen::Vector3d>& positions, const FieldSolver& solver,
+    const Volume& region, util::ThreadPool& pool) const {
+  std::vector<Eigen::Vector3d> results(positions.size());
+  if (gpuCharges_ != nullptr) {
+    gpuCharges_->fieldAt(positions.data(), positions.size(), results.data());
+    return results;
+  }
+  /* Chunks of at least one tile keep the batched kernel's blocking intact */
+  const size_t chunkSize =
+      std::max(pool.chunkSizeFor(positions.size()), field::POINT_TILE_SIZE);
 
-  while (region.isInside(finalPosition) && ++steps < maxSteps) {
-    finalPosition = nextPoint_(finalPosition, stepSize);
-    SPDLOG_DEBUG("Updated position: {}", finalPosition.transpose());
+  if (solver.type == FieldSolver::Type::direct) {
+    pool.parallelFor(positions.size(), chunkSize,
+                     [&](const size_t begin, const size_t end, size_t) {
+                       field::electricFieldAt(chargeStore_, &positions[begin],
+                                              end - begin, &results[begin]);
+                     });
+    return results;
   }
 
-  SPDLOG_DEBUG("Initial position {}", initialPosition.transpose());
-  SPDLOG_DEBUG("Final position: {}", finalPosition.transpose());
-  SPDLOG_DEBUG("Num of steps: {}", steps);
-  SPDLOG_DEBUG("Distance between end and start: {}",
-               (finalPosition - initialPosition).norm());
+  const auto field = fieldEvaluator(solver, region);
+  pool.parallelFor(positions.size(), chunkSize,
+                   [&](const size_t begin, const size_t end, size_t) {
+                     for (size_t i = begin; i < end; i++) {
+                       results[i] = field(positions[i]);
+                     }
+                   });
+  return results;
+}
+
+std::vector<Eigen::Vector3d> System::electricFieldsAt(
+    const std::vector<Eigen::Vector3d>& positions) const {
+  std::vector<Eigen::Vector3d> results(positions.size() * chargeSets());
+  if (chargeSets() == 1) {
+    field::electricFieldAt(chargeStore_, positions.data(), positions.size(),
+                           results.data());
+  } else {
+    field::electricFieldsAt(chargeSetStore_, positions.data(),
+                            positions.size(), results.data());
+  }
+  return results;
+}
 
-  return {(finalPosition - initialPosition).norm(),
-          (curvatureAt_(finalPosition, stepSize) +
-           curvatureAt_(initialPosition, stepSize)) /
-              2.0};
+std::vector<Eigen::Vector3d> System::electricFieldsAt(
+    const std::vector<Eigen::Vector3d>& positions,
+    util::ThreadPool& pool) const {
+  const size_t sets = chargeSets();
+  std::vector<Eigen::Vector3d> results(positions.size() * sets);
+  pool.parallelFor(
+      positions.size(),
+      std::max(pool.chunkSizeFor(positions.size()), field::POINT_TILE_SIZE),
+      [&](const size_t begin, const size_t end, size_t) {
+        if (sets == 1) {
+          field::electricFieldAt(chargeStore_, &positions[begin], end - begin,
+                                 &results[begin]);
+        } else {
+          field::electricFieldsAt(chargeSetStore_, &positions[begin],
+                                  end - begin, &results[begin * sets]);
+        }
+      });
+  return results;
 }
 
-double System::curvatureAt_(const Eigen::Vector3d& alpha_0,
-                            const double stepSize) const noexcept {
-  SPDLOG_DEBUG("Calculating curvature of field at {}", alpha_0.transpose());
+FieldGrid System::fieldGrid(const FieldSolver& solver, const Volume& region,
+                            const GridInterpolation& interpolation,
+                            const double padding,
+                            util::ThreadPool& pool) const {
+  constexpr size_t MAX_PROBES = 512;
+
+  /* The extra spacing keeps queries at the padded edge inside the stencil */
+  const Eigen::Vector3d halfWidths =
+      region.halfExtents() +
+      Eigen::Vector3d::Constant(padding + interpolation.spacing);
+  FieldGrid grid{region.center() - halfWidths, region.center() + halfWidths,
+                 interpolation.spacing, interpolation.type};
+  grid.values(electricFieldAt(grid.nodes(), solver, region, pool));
+
+  const auto probes = grid.probes(MAX_PROBES);
+  grid.estimateError(probes, electricFieldAt(probes, solver, region, pool));
+  return grid;
+}
 
-  Eigen::Vector3d alpha_1 = nextPoint_(alpha_0, stepSize);
-  Eigen::Vector3d alpha_2 = nextPoint_(alpha_1, stepSize);
+std::vector<PathSample> System::electricFieldTopologyIn(
+    util::ThreadPool& pool, const Volume& volume, const double stepsize,
+    const int numberOfSamples, const FieldSolver& solver,
+    const GridInterpolation& interpolation, const Integrator& integrator,
+    const util::SampleStream& stream, const size_t batchSize,
+    const SampleBatchCallback& onBatch) const {
+  /* A streamline stops one step outside the volume and the curvature there
+   * looks one step further */
+  constexpr double STEPS_OUTSIDE = 3.0;
 
-  Eigen::Vector3d alpha_0_prime = alpha_1 - alpha_0;
-  Eigen::Vector3d alpha_1_prime = alpha_2 - alpha_1;
+  std::optional<gpu::TraceSettings> gpuSettings;
+  FieldEvaluator field{chargeStore_};
+  if (gpuCharges_ != nullptr) {
+    gpuSettings = gpuTraceSettings(volume, stepsize, integrator);
+  } else if (interpolation.enabled()) {
+    auto grid = std::make_shared<const FieldGrid>(
+        fieldGrid(solver, volume, interpolation, STEPS_OUTSIDE * stepsize,
+                  pool));
+    SPDLOG_INFO("[Grid]      ==>> {}x{}x{} nodes, max relative error {:.3e}",
+                grid->dimensions()[0], grid->dimensions()[1],
+                grid->dimensions()[2], grid->errorEstimate());
+    field = FieldEvaluator{std::move(grid)};
+  } else {
+    field = fieldEvaluator(solver, volume);
+  }
 
-  Eigen::Vector3d alpha_0_prime_prime = alpha_1_prime - alpha_0_prime;
+  /* Every sample has its own slot, so the order does not depend on which
+   * thread computed it */
+  const auto samples = static_cast<size_t>(std::max(numberOfSamples, 0));
+  const size_t batch = (batchSize == 0) ? samples : batchSize;
+  std::vector<PathSample> sampleResults;
+  sampleResults.reserve(samples);
+  for (size_t done = 0; done < samples; done += batch) {
+    const size_t count = std::min(batch, samples - done);
+    std::vector<PathSample> batchResults(count);
+    if (gpuSettings) {
+      batchResults =
+          countedSamples(gpuCharges_->trace(*gpuSettings, stream, done, count));
+    } else {
+      /* Chunks of a few packets keep the lanes of each packet busy */
+      const size_t chunkSize =
+          std::max(pool.chunkSizeFor(count), 2 * field::PACKET_SIZE);
+      pool.parallelFor(count, chunkSize,
+                       [&](const size_t begin, const size_t end, size_t) {
+                         streamline::sampleTopology(
+                             field, volume, stepsize, integrator, stream,
+                             done + begin, end - begin, &batchResults[begin]);
+                       });
+    }
 
-  double alpha_prime_norm = alpha_0_prime.norm();
+    const bool more = !onBatch || onBatch(batchResults);
+    sampleResults.insert(sampleResults.end(), batchResults.begin(),
+                         batchResults.end());
+    if (!more) {
+      break;
+    }
+  }
+  SPDLOG_DEBUG("{} Points calculated on {} threads", sampleResults.size(),
+               pool.size());
+  return sampleResults;
+}
 
-  return (alpha_0_prime.cross(alpha_0_prime_prime)).norm() /
-         (alpha_prime_norm * alpha_prime_norm * alpha_prime_norm);
+std::vector<Eigen::Vector3d> System::groupFieldsAt(
+    const std::vector<Eigen::Vector3d>& positions,
+    const ChargeGroups& groups) const {
+  /* The charges of each group side by side, so each is one contiguous
+   * range of the kernel */
+  const auto& charges = frame_.topology().charges();
+  PointChargeStore store;
+  store.reserve(groups.atoms().size());
+  for (const auto atom : groups.atoms()) {
+    store.push_back(frame_[atom], charges[atom]);
+  }
+  std::vector<Eigen::Vector3d> results(positions.size() * groups.size());
+  field::groupFieldsAt(store, groups.offsets(), positions.data(),
+                       positions.size(), results.data());
+  return results;
 }
+
 std::vector<Eigen::Vector3d> System::computeElectricFieldIn(
-    const EFieldVolume& volume) const noexcept {
-  const auto compute_volume_in_system =
-      [this](const Eigen::Vector3d& position) -> Eigen::Vector3d {
-    return this->electricFieldAt(position);
-  };
-  std::vector<Eigen::Vector3d> results;
-  results.reserve(volume.points().size());
-  std::transform(volume.points().begin(), volume.points().end(),
-                 std::back_inserter(results), compute_volume_in_system);
+    const StructuredGrid& grid, const FieldSolver& solver,
+    const Volume& region, util::ThreadPool& pool) const {
+  const size_t sets = chargeSets();
+  if (gpuCharges_ != nullptr && sets == 1) {
+    /* The device needs the points in memory anyway */
+    return electricFieldAt(grid.points(), solver, region, pool);
+  }
+
+  /* Several charge sets are always summed directly */
+  const bool direct = sets > 1 || solver.type == FieldSolver::Type::direct;
+  const auto field =
+      direct ? FieldEvaluator{chargeStore_} : fieldEvaluator(solver, region);
+  /* The grid is walked in cubic tiles, each one batch of the kernel, and
+   * only the field values are stored */
+  std::vector<Eigen::Vector3d> results(grid.size() * sets);
+  pool.parallelFor(
+      grid.tiles(), pool.chunkSizeFor(grid.tiles()),
+      [&](const size_t begin, const size_t end, size_t) {
+        StructuredGrid::TileIndices indices;
+        std::array<Eigen::Vector3d, StructuredGrid::TILE_POINTS> positions;
+        std::vector<Eigen::Vector3d> fields(StructuredGrid::TILE_POINTS * sets);
+        for (size_t tile = begin; tile < end; tile++) {
+          const size_t count = grid.tile(tile, indices);
+          for (size_t i = 0; i < count; i++) {
+            positions[i] = grid.point(indices[i]);
+          }
+          if (sets > 1) {
+            field::electricFieldsAt(chargeSetStore_, positions.data(), count,
+                                    fields.data());
+          } else if (direct) {
+            field::electricFieldAt(chargeStore_, positions.data(), count,
+                                   fields.data());
+          } else {
+            std::transform(positions.begin(), positions.begin() + count,
+                           fields.begin(), field);
+          }
+          for (size_t i = 0; i < count; i++) {
+            std::copy_n(fields.begin() + static_cast<long>(i * sets), sets,
+                        results.begin() + static_cast<long>(indices[i] * sets));
+          }
+        }
+      });
   return results;
 }
 }  // namespace cpet
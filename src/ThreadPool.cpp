@@ -0,0 +1,106 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "ThreadPool.h"
+
+/* C++ STL HEADER FILES */
+#include <utility>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet {
+namespace util {
+
+namespace {
+/* Which pool, if any, the running thread is a worker of */
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(const int numberOfThreads) {
+  if (numberOfThreads < 1) {
+    throw cpet::value_error("Thread pool requires at least one thread");
+  }
+  const auto threads = static_cast<size_t>(numberOfThreads);
+  queues_.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    queues_.emplace_back(std::make_unique<Queue>());
+  }
+  workers_.reserve(threads - 1);
+  for (size_t i = 0; i + 1 < threads; i++) {
+    workers_.emplace_back([this, i]() { workerLoop_(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  /* RAIIThread joins */
+  workers_.clear();
+}
+
+void ThreadPool::push_(const size_t queue, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+    queues_[queue]->tasks.emplace_back(std::move(task));
+  }
+  ++queued_;
+}
+
+void ThreadPool::wakeWorkers_() {
+  /* Taking the lock orders this against a worker deciding to sleep */
+  { std::lock_guard<std::mutex> lock(sleepMutex_); }
+  wake_.notify_all();
+}
+
+bool ThreadPool::runOne_(const size_t thread) {
+  Task task;
+  {
+    auto& own = *queues_[thread];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (size_t offset = 1; !task && offset < size(); offset++) {
+    auto& victim = *queues_[(thread + offset) % size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  --queued_;
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop_(const size_t thread) {
+  currentPool = this;
+  currentIndex = thread;
+  while (true) {
+    if (runOne_(thread)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    if (stop_ && queued_ == 0) {
+      return;
+    }
+  }
+}
+
+size_t ThreadPool::currentThread_() const noexcept {
+  return (currentPool == this) ? currentIndex : size() - 1;
+}
+
+}  // namespace util
+}  // namespace cpet
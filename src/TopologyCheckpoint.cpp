@@ -0,0 +1,121 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "TopologyCheckpoint.h"
+
+/* C++ STL HEADER FILES */
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+#include "MappedFile.h"
+#include "OutputFormat.h"
+
+namespace cpet {
+
+constexpr std::string_view CHECKPOINT_MAGIC = "CPETCHK1";
+
+namespace {
+/* Samples are resumed exactly as they were computed */
+OutputFormat checkpointFormat() {
+  OutputFormat result;
+  result.encoding = OutputFormat::Encoding::binary;
+  result.precision = OutputFormat::Precision::float64;
+  return result;
+}
+}  // namespace
+
+TopologyCheckpoint::TopologyCheckpoint(std::string file, const std::string& key)
+    : file_(std::move(file)) {
+  if (std::filesystem::exists(file_) && std::filesystem::file_size(file_) > 0) {
+    const auto end = load_(key);
+    /* Appending after a partial record would hide every later one */
+    std::filesystem::resize_file(file_, end);
+    out_.open(file_, std::ios::out | std::ios::binary | std::ios::app);
+  } else {
+    out_.open(file_, std::ios::out | std::ios::binary | std::ios::trunc);
+    util::BinaryWriter writer;
+    checkpointFormat().writeHeader(writer, CHECKPOINT_MAGIC);
+    writer.writeString(key);
+    out_.write(writer.buffer().data(),
+               static_cast<std::streamsize>(writer.buffer().size()));
+    out_.flush();
+  }
+  if (!out_.is_open() || !out_.good()) {
+    SPDLOG_ERROR("Could not open file {}", file_);
+    throw cpet::io_error("Could not open file " + file_);
+  }
+}
+
+std::vector<PathSample> TopologyCheckpoint::take(const size_t frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = loaded_.find(frame);
+  if (iter == loaded_.end()) {
+    return {};
+  }
+  auto result = std::move(iter->second);
+  loaded_.erase(iter);
+  return result;
+}
+
+void TopologyCheckpoint::record(const size_t frame,
+                                const std::vector<PathSample>& samples) {
+  std::vector<double> values;
+  values.reserve(2 * samples.size());
+  for (const auto& sample : samples) {
+    values.push_back(sample.distance);
+    values.push_back(sample.curvature);
+  }
+  util::BinaryWriter writer;
+  writer.writeUInt64(frame);
+  checkpointFormat().writeReals(writer, values);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  /* Flushed so the record survives the process being killed */
+  out_.write(writer.buffer().data(),
+             static_cast<std::streamsize>(writer.buffer().size()));
+  out_.flush();
+  if (!out_.good()) {
+    throw cpet::io_error("Could not write checkpoint " + file_);
+  }
+}
+
+size_t TopologyCheckpoint::load_(const std::string& key) {
+  const util::MappedFile mapped{file_};
+  util::BinaryCursor cursor{mapped.view(), util::BinaryCursor::Endian::little};
+  const auto format = OutputFormat::readHeader(cursor, CHECKPOINT_MAGIC);
+  if (cursor.readString() != key) {
+    throw cpet::value_error("Checkpoint " + file_ +
+                            " was written for another trajectory, frames "
+                            "or topology options");
+  }
+
+  size_t end = cursor.offset();
+  size_t samples = 0;
+  while (!cursor.atEnd()) {
+    try {
+      const auto frame = cursor.readSize();
+      const auto values = format.readReals(cursor);
+      auto& frameSamples = loaded_[frame];
+      for (size_t i = 0; i + 1 < values.size(); i += 2) {
+        frameSamples.push_back(PathSample{values[i], values[i + 1]});
+      }
+      samples += values.size() / 2;
+      end = cursor.offset();
+    } catch (const cpet::io_error&) {
+      SPDLOG_WARN("Dropping the incomplete last record of checkpoint {}",
+                  file_);
+      break;
+    }
+  }
+  SPDLOG_INFO("Resuming {} samples over {} frames from checkpoint {}",
+              samples, loaded_.size(), file_);
+  return end;
+}
+
+}  // namespace cpet
@@ -0,0 +1,123 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "TopologyHistograms.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+/* CPET HEADER FILES */
+#include "Cluster.h"
+
+namespace cpet {
+
+TopologyHistograms::TopologyHistograms(const std::array<int, 2>& bins,
+                                       std::optional<HistogramLimits> limits)
+    : bins_(bins), limits_(std::move(limits)) {}
+
+void TopologyHistograms::add(std::vector<PathSample> samples,
+                             util::ThreadPool& pool) {
+  if (limits_) {
+    binned_.emplace_back(bin_(samples, *limits_, pool));
+    return;
+  }
+  for (const auto& sample : samples) {
+    distanceRange_.add(sample.distance);
+    curvatureRange_.add(sample.curvature);
+  }
+  pending_.emplace_back(std::move(samples));
+}
+
+HistogramLimits TopologyHistograms::limits() const {
+  if (limits_) {
+    return *limits_;
+  }
+  if (distanceRange_.empty()) {
+    return {{0.0, 0.0}, {0.0, 0.0}};
+  }
+  const auto round = [](const double value) {
+    return std::round(value * 1000.0) / 1000.0;
+  };
+  return {{round(distanceRange_.min), round(distanceRange_.max)},
+          {round(curvatureRange_.min), round(curvatureRange_.max)}};
+}
+
+bool TopologyHistograms::adoptLimits(const HistogramLimits& limits) {
+  if (limits_) {
+    return limits_->distance == limits.distance &&
+           limits_->curvature == limits.curvature;
+  }
+  const auto& cluster = util::Cluster::instance();
+  cluster.extremes(distanceRange_.min, distanceRange_.max);
+  cluster.extremes(curvatureRange_.min, curvatureRange_.max);
+  /* Compared as finish() would round the running range */
+  const auto running = this->limits();
+  const auto within = [](const std::array<double, 2>& range,
+                         const std::array<double, 2>& bounds) {
+    return range[0] >= bounds[0] && range[1] <= bounds[1];
+  };
+  if (!distanceRange_.empty() && (!within(running.distance, limits.distance) ||
+                                  !within(running.curvature,
+                                          limits.curvature))) {
+    return false;
+  }
+  limits_ = limits;
+  return true;
+}
+
+histo::HistogramMatrix TopologyHistograms::finish(util::ThreadPool& pool) {
+  const auto& cluster = util::Cluster::instance();
+  if (!limits_) {
+    /* Every rank bins its share of the samples with the same limits */
+    cluster.extremes(distanceRange_.min, distanceRange_.max);
+    cluster.extremes(curvatureRange_.min, curvatureRange_.max);
+  }
+  const auto histogramLimits = limits();
+  /* Each frame's samples are released as soon as they are binned */
+  for (auto& samples : pending_) {
+    binned_.emplace_back(bin_(samples, histogramLimits, pool));
+    std::vector<PathSample>{}.swap(samples);
+  }
+  pending_.clear();
+
+  const size_t bins = binned_.empty() ? 0 : binned_.front().counts().size();
+  std::vector<int64_t> counts;
+  counts.reserve(binned_.size() * bins);
+  for (const auto& histogram : binned_) {
+    counts.insert(counts.end(), histogram.counts().begin(),
+                  histogram.counts().end());
+  }
+  binned_.clear();
+  cluster.sumToRoot(counts);
+  if (!cluster.root()) {
+    return {};
+  }
+
+  histo::HistogramMatrix result{counts.size() / std::max<size_t>(bins, 1),
+                                bins};
+  for (size_t frame = 0; frame < result.rows(); frame++) {
+    const auto first = counts.begin() + static_cast<long>(frame * bins);
+    const auto last = first + static_cast<long>(bins);
+    const double sum = std::accumulate(first, last, 0.0);
+    std::transform(first, last, result.row(frame), [sum](const auto count) {
+      return static_cast<double>(count) / sum;
+    });
+  }
+  return result;
+}
+
+histo::Histogram2D64 TopologyHistograms::bin_(
+    const std::vector<PathSample>& samples, const HistogramLimits& limits,
+    util::ThreadPool& pool) const {
+  histo::Histogram2D64 histogram{bins_, limits.distance, limits.curvature};
+  histo::addInParallel(
+      histogram, samples,
+      [](const PathSample& sample) { return sample.distance; },
+      [](const PathSample& sample) { return sample.curvature; }, pool);
+  return histogram;
+}
+
+}  // namespace cpet
@@ -4,67 +4,239 @@
 #include "TopologyRegion.h"
 
 /* C++ STL HEADER FILES */
+#include <algorithm>
 #include <utility>
 #include <filesystem>
+#include <cctype>
 #include <iomanip>
+#include <random>
+#include <sstream>
+#include <string_view>
 
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <spdlog/spdlog.h>
-#include <matplot/matplot.h>
 
 /* CPET HEADER FILES */
+#include "Cluster.h"
 #include "Exceptions.h"
 #include "Utilities.h"
 #include "System.h"
 #include "Instrumentation.h"
 #include "Histogram2D.h"
+#include "HistogramCache.h"
+#include "MappedFile.h"
 
 namespace cpet {
 
-void TopologyRegion::computeTopologyWith(const std::vector<System>& systems,
-                                         int numberOfThreads) const {
-  std::vector<std::vector<PathSample>> sampleResults;
+constexpr std::string_view SAMPLE_MAGIC = "CPETTOP1";
 
-  if (!analysisOnly()) {
-    assert(volume_ != nullptr);
+std::vector<std::vector<PathSample>> TopologyRegion::sampleTopologyWith(
+    const std::vector<System>& systems, util::ThreadPool& pool,
+    util::AsyncWriter& writer, const size_t firstFrame,
+    TopologyCheckpoint* checkpoint) const {
+  if (analysisOnly()) {
+    return {};
+  }
+  assert(volume_ != nullptr);
+  /* Each MPI rank draws its own part of the samples of every frame. Draws
+   * are keyed by their index, so together they are those of one process.
+   * With a converge key each rank stops drawing its share on its own, once
+   * the histogram of its samples settles. */
+  const auto& cluster = util::Cluster::instance();
+  const auto [firstSample, lastSample] =
+      cluster.share(static_cast<size_t>(numberOfSamples_));
+  const auto localSamples = static_cast<int>(lastSample - firstSample);
+  if (firstFrame == 0) {
     SPDLOG_INFO("======[Sampling topology]======");
     SPDLOG_INFO("[Volume ]   ==>> {}", volume_->description());
     SPDLOG_INFO("[Npoints]   ==>> {}", numberOfSamples_);
-    SPDLOG_INFO("[Threads]   ==>> {}", numberOfThreads);
+    SPDLOG_INFO("[Threads]   ==>> {}", pool.size());
+    if (cluster.size() > 1) {
+      SPDLOG_INFO("[Ranks]     ==>> {}", cluster.size());
+    }
     SPDLOG_INFO("[STEP SIZE] ==>> {}", stepSize_);
+    SPDLOG_INFO("[Solver]    ==>> {}", solver_.description());
+    SPDLOG_INFO("[Integrator]==>> {}", integrator_.description());
+    SPDLOG_INFO("[Seed]      ==>> {}", seed_);
+    if (interpolation_.enabled()) {
+      SPDLOG_INFO("[Interp]    ==>> {}", interpolation_.description());
+    }
+    if (convergence_) {
+      SPDLOG_INFO("[Converge]  ==>> {}", convergence_->description());
+    }
+    if (computeMatrix() && !limits_) {
+      SPDLOG_WARN("Topology histograms without fixed limits keep every "
+                  "sample until the end of the trajectory; add limits to the "
+                  "block to bin each frame as it is sampled");
+    }
+  }
 
-    int index = 0;
-    for (const auto& system : systems) {
-      SPDLOG_INFO("=~=~=~=~[Trajectory {}]=~=~=~=~", index);
-      std::vector<PathSample> results;
-      {
-        Timer t;
-        results = system.electricFieldTopologyIn(numberOfThreads, *volume_,
-                                                 stepSize_, numberOfSamples_);
-      }
+  /* Frames run concurrently and each splits its samples over the same
+   * pool, so short trajectories still fill every thread */
+  std::vector<std::vector<PathSample>> sampleResults(systems.size());
+  {
+    Timer t;
+    pool.parallelFor(
+        systems.size(), 1, [&](const size_t begin, const size_t end, size_t) {
+          for (size_t frame = begin; frame < end; frame++) {
+            const size_t index = firstFrame + frame;
+            auto& samples = sampleResults[frame];
+            if (checkpoint != nullptr) {
+              samples = checkpoint->take(index);
+            }
+            std::optional<ConvergenceMonitor> monitor;
+            bool converged = false;
+            if (convergence_) {
+              monitor.emplace(*convergence_,
+                              bins_.value_or(std::array<int, 2>{
+                                  DEFAULT_CONVERGENCE_BINS,
+                                  DEFAULT_CONVERGENCE_BINS}),
+                              limits_);
+              /* Resumed samples go in by the batches they were drawn in,
+               * so the monitor decides as it did before the kill */
+              const size_t slice = convergence_->batchSize;
+              for (size_t i = 0; i < samples.size() && !converged;
+                   i += slice) {
+                const auto sliceBegin = samples.begin() + static_cast<long>(i);
+                const auto sliceEnd =
+                    samples.begin() +
+                    static_cast<long>(std::min(i + slice, samples.size()));
+                converged = monitor->add({sliceBegin, sliceEnd});
+              }
+            }
+            const auto onBatch = [&](const std::vector<PathSample>& batch) {
+              if (checkpoint != nullptr) {
+                checkpoint->record(index, batch);
+              }
+              return !monitor || !monitor->add(batch);
+            };
+            /* Convergence is checked after every batch, so it sets their
+             * size over the checkpoint interval */
+            size_t batchSize = 0;
+            if (convergence_) {
+              batchSize = convergence_->batchSize;
+            } else if (checkpoint != nullptr) {
+              batchSize = static_cast<size_t>(checkpointInterval_);
+            }
+
+            const auto remaining =
+                localSamples - static_cast<int>(samples.size());
+            if (remaining <= 0) {
+              samples.resize(static_cast<size_t>(localSamples));
+              continue;
+            }
+            if (converged) {
+              SPDLOG_INFO("[Resume]    ==>> frame {}: converged after {} "
+                          "samples",
+                          index, samples.size());
+              continue;
+            }
+            if (!samples.empty()) {
+              SPDLOG_INFO("[Resume]    ==>> frame {}: {} of {} samples done",
+                          index, samples.size(), localSamples);
+            }
+            /* Resumed samples continue the stream where they stopped */
+            const util::SampleStream stream{seed_, index,
+                                            firstSample + samples.size()};
+            const auto newSamples = systems[frame].electricFieldTopologyIn(
+                pool, *volume_, stepSize_, remaining, solver_, interpolation_,
+                integrator_, stream, batchSize,
+                (monitor || checkpoint != nullptr)
+                    ? System::SampleBatchCallback{onBatch}
+                    : nullptr);
+            samples.insert(samples.end(), newSamples.begin(),
+                           newSamples.end());
+            if (monitor) {
+              SPDLOG_DEBUG("[Converge]  ==>> frame {}: {} samples, chi "
+                           "distance {:.3e}",
+                           index, samples.size(), monitor->distance());
+            }
+          }
+        });
+  }
 
-      if (sampleOutput_) {
-        writeSampleOutput_(results, index);
+  if (sampleOutput_) {
+    /* Written while the next window samples. The job gets its own copy
+     * only if the samples are also kept for the distance matrix. */
+    auto samples = computeMatrix() ? sampleResults : std::move(sampleResults);
+    writer.submit([this, firstFrame, samples = std::move(samples)]() {
+      for (size_t frame = 0; frame < samples.size(); frame++) {
+        writeSampleOutput_(samples[frame],
+                           static_cast<int>(firstFrame + frame));
       }
-      sampleResults.emplace_back(std::move(results));
-      ++index;
-    }
+    });
+  }
+  if (!computeMatrix()) {
+    return {};
   }
+  return sampleResults;
+}
+
+TopologyHistograms TopologyRegion::histograms() const {
+  assert(static_cast<bool>(bins_));
+  return {*bins_, limits_};
+}
 
+void TopologyRegion::analyzeTopology(TopologyHistograms histograms,
+                                     util::ThreadPool& pool) const {
   if (computeMatrix()) {
     assert(static_cast<bool>(bins_));
+    /* Frames an earlier run cached are only compared against, not loaded */
+    std::optional<HistogramCache> cache;
+    if (histogramCache_) {
+      cache.emplace(*histogramCache_, *bins_, limits_);
+    }
     if (sampleInput_) {
-      sampleResults = loadSampleData_();
+      loadSampleData_(histograms, pool, cache ? cache->frames() : 0);
+    }
+    if (cache && cache->frames() > 0 &&
+        !histograms.adoptLimits(*cache->limits())) {
+      SPDLOG_INFO("New frames fall outside the limits of histogram cache {}; "
+                  "recomputing every frame",
+                  cache->file());
+      cache->clear();
+      histograms = this->histograms();
+      loadSampleData_(histograms, pool, 0);
+    }
+
+    SPDLOG_INFO("====[Computing  Histograms]====");
+    SPDLOG_INFO("[Bins] ==>> {} x {}", (*bins_)[0], (*bins_)[1]);
+    histo::HistogramMatrix normalized;
+    {
+      Timer t;
+      const util::ProfileStage stage{"histograms"};
+      normalized = histograms.finish(pool);
+    }
+    /* Only known once the ranges of every MPI rank are merged */
+    const auto limits = histograms.limits();
+    SPDLOG_INFO("[XLim] ==>> [{}, {}]", limits.distance[0],
+                limits.distance[1]);
+    SPDLOG_INFO("[YLim] ==>> [{}, {}]", limits.curvature[0],
+                limits.curvature[1]);
+    /* The histograms of every rank were summed onto the root */
+    if (!util::Cluster::instance().root()) {
+      return;
     }
-    const auto histograms = constructHistograms_(sampleResults);
 
     SPDLOG_INFO("==[Computing Distance Matrix]==");
-    const auto matrix = constructMatrix_(histograms);
+    std::optional<histo::DistanceMatrix> computed;
+    {
+      Timer t;
+      const util::ProfileStage stage{"distance matrix"};
+      if (cache) {
+        SPDLOG_INFO("[Cached] ==>> {} frames, {} new", cache->frames(),
+                    normalized.rows());
+        cache->append(normalized, limits, pool);
+      } else {
+        computed = histo::chiDistanceMatrix(normalized, pool);
+      }
+    }
+    const auto& matrix = cache ? cache->matrix() : *computed;
     SPDLOG_INFO("Distance matrix:");
-    for (const auto& row : matrix) {
+    for (size_t i = 0; i < matrix.size(); i++) {
       std::stringstream output;
-      for (const auto& col : row) {
-        output << col << ' ';
+      for (size_t j = 0; j < matrix.size(); j++) {
+        output << matrix(i, j) << ' ';
       }
       SPDLOG_INFO(output.str());
     }
@@ -74,6 +246,29 @@ void TopologyRegion::computeTopologyWith(const std::vector<System>& systems,
   }
 }
 
+std::unique_ptr<TopologyCheckpoint> TopologyRegion::openCheckpoint(
+    const std::string& input) const {
+  if (!checkpoint_ || analysisOnly()) {
+    return nullptr;
+  }
+  /* Samples of a frame can only be reused if they were drawn alike, from
+   * the same frame */
+  const auto key = input + "; " + details() +
+                   "; Step size: " + std::to_string(stepSize_) +
+                   "; Solver: " + solver_.description() +
+                   "; Interpolation: " + interpolation_.description() +
+                   "; Integrator: " + integrator_.description() +
+                   "; Seed: " + std::to_string(seed_);
+  /* Every MPI rank records its own share of the samples */
+  if (const auto& cluster = util::Cluster::instance(); cluster.size() > 1) {
+    const auto rank = std::to_string(cluster.rank());
+    return std::make_unique<TopologyCheckpoint>(
+        *checkpoint_ + '.' + rank,
+        key + "; Rank: " + rank + '/' + std::to_string(cluster.size()));
+  }
+  return std::make_unique<TopologyCheckpoint>(*checkpoint_, key);
+}
+
 TopologyRegion cpet::TopologyRegion::fromSimple(
     const std::vector<std::string>& options) {
   constexpr size_t MIN_PARSE_TOKENS = 3;
@@ -107,14 +302,34 @@ TopologyRegion TopologyRegion::fromBlock(
   std::optional<std::string> sampleInput{std::nullopt};
   std::optional<std::array<int, 2>> bins{std::nullopt};
   std::optional<std::string> matrixOutput{std::nullopt};
+  bool packedMatrix{false};
+  FieldSolver solver{};
+  GridInterpolation interpolation{};
+  Integrator integrator{};
+  OutputFormat sampleFormat{};
+  std::optional<std::string> checkpoint{std::nullopt};
+  int checkpointInterval{DEFAULT_CHECKPOINT_INTERVAL};
+  std::optional<HistogramLimits> limits{std::nullopt};
+  uint64_t seed{DEFAULT_SEED};
+  std::optional<SampleConvergence> convergence{std::nullopt};
+  std::optional<std::string> histogramCache{std::nullopt};
 
   constexpr const char* VOLUME_KEY = "volume";
   constexpr const char* SAMPLES_KEY = "samples";
   constexpr const char* STEP_SIZE_KEY = "stepsize";
   constexpr const char* SAMPLE_OUTPUT_KEY = "sampleoutput";
+  constexpr const char* SAMPLE_FORMAT_KEY = "sampleformat";
   constexpr const char* SAMPLE_INPUT_KEY = "sampleinput";
   constexpr const char* BINS_KEY = "bins";
   constexpr const char* MATRIX_OUTPUT_KEY = "matrixoutput";
+  constexpr const char* SOLVER_KEY = "solver";
+  constexpr const char* INTERPOLATE_KEY = "interpolate";
+  constexpr const char* INTEGRATOR_KEY = "integrator";
+  constexpr const char* CHECKPOINT_KEY = "checkpoint";
+  constexpr const char* LIMITS_KEY = "limits";
+  constexpr const char* SEED_KEY = "seed";
+  constexpr const char* CONVERGE_KEY = "converge";
+  constexpr const char* HISTOGRAM_CACHE_KEY = "histogramcache";
 
   for (const auto& line : options) {
     const auto tokens = util::split(line, ' ');
@@ -142,6 +357,8 @@ TopologyRegion TopologyRegion::fromBlock(
       stepsize = std::stod(*key_options.begin());
     } else if (key == SAMPLE_OUTPUT_KEY) {
       sampleOutput = *key_options.begin();
+    } else if (key == SAMPLE_FORMAT_KEY) {
+      sampleFormat = OutputFormat::fromOptions(key_options);
     } else if (key == SAMPLE_INPUT_KEY) {
       sampleInput = *key_options.begin();
       analysisOnly = true;
@@ -164,6 +381,66 @@ TopologyRegion TopologyRegion::fromBlock(
       }
     } else if (key == MATRIX_OUTPUT_KEY) {
       matrixOutput = *key_options.begin();
+      if (key_options.size() > 1) {
+        if (util::tolower(key_options[1]) != "packed") {
+          throw cpet::invalid_option(
+              "Invalid Option: matrixoutput accepts a file name and "
+              "optionally packed");
+        }
+        packedMatrix = true;
+      }
+    } else if (key == SOLVER_KEY) {
+      solver = FieldSolver::fromOptions(key_options);
+    } else if (key == INTERPOLATE_KEY) {
+      interpolation = GridInterpolation::fromOptions(key_options);
+    } else if (key == INTEGRATOR_KEY) {
+      integrator = Integrator::fromOptions(key_options);
+    } else if (key == LIMITS_KEY) {
+      constexpr size_t LIMITS_PARAMETERS = 4;
+      if (key_options.size() < LIMITS_PARAMETERS ||
+          !std::all_of(key_options.begin(),
+                       key_options.begin() + LIMITS_PARAMETERS,
+                       util::isDouble)) {
+        throw cpet::invalid_option(
+            "Invalid Option: limits requires 4 numbers: distance min max and "
+            "curvature min max");
+      }
+      limits = HistogramLimits{
+          {std::stod(key_options[0]), std::stod(key_options[1])},
+          {std::stod(key_options[2]), std::stod(key_options[3])}};
+      if (limits->distance[0] >= limits->distance[1] ||
+          limits->curvature[0] >= limits->curvature[1]) {
+        throw cpet::invalid_option(
+            "Invalid Option: limits minimum should be less than maximum");
+      }
+    } else if (key == SEED_KEY) {
+      const auto& value = *key_options.begin();
+      if (util::tolower(value) == "random") {
+        seed = std::random_device{}();
+      } else if (std::all_of(value.begin(), value.end(), [](const char c) {
+                   return std::isdigit(static_cast<unsigned char>(c)) != 0;
+                 })) {
+        seed = std::stoull(value);
+      } else {
+        throw cpet::invalid_option(
+            "Invalid Option: seed should be a non-negative integer or "
+            "random");
+      }
+    } else if (key == CONVERGE_KEY) {
+      convergence = convergenceFromOptions_(key_options);
+    } else if (key == HISTOGRAM_CACHE_KEY) {
+      histogramCache = *key_options.begin();
+    } else if (key == CHECKPOINT_KEY) {
+      checkpoint = *key_options.begin();
+      if (key_options.size() > 1) {
+        if (!util::isDouble(key_options[1]) ||
+            std::stoi(key_options[1]) < 1) {
+          throw cpet::invalid_option(
+              "Invalid Option: checkpoint interval should be a positive "
+              "number of samples");
+        }
+        checkpointInterval = std::stoi(key_options[1]);
+      }
     } else {
       SPDLOG_WARN("Unknown key specified in block topology: {}", key);
     }
@@ -183,9 +460,17 @@ TopologyRegion TopologyRegion::fromBlock(
     }
     result.volume_ = std::move(vol);
     result.stepSize_ = stepsize;
+    result.solver_ = solver;
+    result.interpolation_ = interpolation;
+    result.integrator_ = integrator;
     if (sampleOutput) {
       result.sampleOutput(*sampleOutput);
     }
+    result.sampleFormat_ = sampleFormat;
+    result.checkpoint_ = checkpoint;
+    result.checkpointInterval_ = checkpointInterval;
+    result.seed_ = seed;
+    result.convergence_ = convergence;
   }
 
   if (sampleInput) {
@@ -194,11 +479,41 @@ TopologyRegion TopologyRegion::fromBlock(
       throw cpet::invalid_option(
           "Invalid Option: sampleInput specified but no bins specified!");
     }
+    result.histogramCache_ = histogramCache;
+  } else if (histogramCache) {
+    throw cpet::invalid_option(
+        "Invalid Option: histogramCache requires sampleInput");
   }
   result.bins_ = bins;
+  result.limits_ = limits;
   if (matrixOutput) {
     result.matrixOutput(*matrixOutput);
   }
+  result.packedMatrix(packedMatrix);
+  return result;
+}
+
+SampleConvergence TopologyRegion::convergenceFromOptions_(
+    const std::vector<std::string>& options) {
+  if (!util::isDouble(options[0]) || std::stod(options[0]) <= 0.0) {
+    throw cpet::invalid_option(
+        "Invalid Option: converge tolerance should be a positive number");
+  }
+  SampleConvergence result{std::stod(options[0])};
+  /* Optional minimum number of samples, then batch size */
+  const auto count = [&options](const size_t i, size_t& value) {
+    if (i >= options.size()) {
+      return;
+    }
+    if (!util::isDouble(options[i]) || std::stoi(options[i]) < 1) {
+      throw cpet::invalid_option(
+          "Invalid Option: converge minimum samples and batch size should be "
+          "positive numbers of samples");
+    }
+    value = static_cast<size_t>(std::stoi(options[i]));
+  };
+  count(1, result.minSamples);
+  count(2, result.batchSize);
   return result;
 }
 
@@ -211,30 +526,65 @@ void TopologyRegion::writeSampleOutput_(const std::vector<PathSample>& data,
   SPDLOG_DEBUG("Writing topology results");
   const std::string file =
       *sampleOutput_ + '_' + std::to_string(index) + ".top";
+  /* With MPI, every rank writes its samples after those of the ranks
+   * before it, so the file is the one a single process writes */
+  const auto& cluster = util::Cluster::instance();
+  /* Converged frames hold fewer samples than asked for */
+  auto summary = details();
+  if (convergence_) {
+    summary += "; Drawn: " + std::to_string(cluster.sum(data.size()));
+  }
 
-  std::ofstream outFile(file, std::ios::out);
-  if (outFile.is_open()) {
-    outFile << '#' << details() << '\n';
-    /* TODO add options writing to this file...*/
-    std::for_each(data.begin(), data.end(),
-                  [&outFile](const auto& line) { outFile << line << '\n'; });
-    outFile << std::flush;
-  } else {
-    SPDLOG_ERROR("Could not open file {}", file);
-    throw cpet::io_error("Could not open file " + file);
+  if (sampleFormat_.binary()) {
+    std::vector<double> values;
+    values.reserve(2 * data.size());
+    for (const auto& sample : data) {
+      values.push_back(sample.distance);
+      values.push_back(sample.curvature);
+    }
+    util::BinaryWriter header;
+    sampleFormat_.writeHeader(header, SAMPLE_MAGIC);
+    header.writeString(summary);
+    header.writeUInt64(cluster.sum(values.size()));
+    util::BinaryWriter body;
+    sampleFormat_.writeChunks(body, values);
+
+    cluster.writeOrdered(file, header.buffer(), body.buffer());
+    return;
   }
+
+  std::ostringstream body;
+  /* TODO add options writing to this file...*/
+  std::for_each(data.begin(), data.end(),
+                [&body](const auto& line) { body << line << '\n'; });
+  cluster.writeOrdered(file, '#' + summary + '\n', body.str());
 }
-std::vector<std::vector<PathSample>> TopologyRegion::loadSampleData_() const {
+void TopologyRegion::loadSampleData_(TopologyHistograms& histograms,
+                                     util::ThreadPool& pool,
+                                     const size_t firstFile) const {
   assert(static_cast<bool>(sampleInput_));
 
   SPDLOG_INFO("Loading in pre-sampled data with prefix {}", *sampleInput_);
-  std::vector<std::vector<PathSample>> data;
-  auto nextFileName = [&, index = 0]() mutable {
+  auto nextFileName = [&, index = firstFile]() mutable {
     return *sampleInput_ + '_' + std::to_string(index++) + ".top";
   };
+  /* MPI ranks take turns loading the files; the histograms of the others
+   * stay empty until they are summed */
+  const auto& cluster = util::Cluster::instance();
   std::string filename;
-  while (std::filesystem::exists(filename = nextFileName())) {
+  for (auto file = static_cast<int>(firstFile);
+       std::filesystem::exists(filename = nextFileName()); file++) {
+    if (file % cluster.size() != cluster.rank()) {
+      histograms.add({}, pool);
+      continue;
+    }
     SPDLOG_DEBUG("Loading in data from file {}", filename);
+    if (const util::MappedFile mapped{filename};
+        OutputFormat::isBinary(mapped.view(), SAMPLE_MAGIC)) {
+      histograms.add(loadBinarySamples_(mapped.view()), pool);
+      SPDLOG_INFO("Loaded file: {}", filename);
+      continue;
+    }
     std::vector<PathSample> tmpData;
     util::forEachLineIn(filename, [&,
                                    linenumber = 0](const auto& line) mutable {
@@ -258,77 +608,29 @@ std::vector<std::vector<PathSample>> TopologyRegion::loadSampleData_() const {
       ++linenumber;
     });
     SPDLOG_INFO("Loaded file: {}", filename);
-    data.emplace_back(std::move(tmpData));
+    histograms.add(std::move(tmpData), pool);
   }
-  SPDLOG_INFO("Loaded in {} topology sample files", data.size());
-  return data;
+  SPDLOG_INFO("Loaded in {} topology sample files", histograms.size());
 }
-std::vector<std::vector<double>> TopologyRegion::constructHistograms_(
-    const std::vector<std::vector<PathSample>>& sampleData) const {
-  Timer t;
-  std::vector<std::vector<double>> histograms;
-
-  const auto sampleDataFlatten = util::flatten(sampleData);
-
-  const auto [xmin, xmax] =
-      std::minmax_element(sampleDataFlatten.begin(), sampleDataFlatten.end(),
-                          [](const auto& ps1, const auto& ps2) {
-                            return ps1.distance < ps2.distance;
-                          });
-  const auto [ymin, ymax] =
-      std::minmax_element(sampleDataFlatten.begin(), sampleDataFlatten.end(),
-                          [](const auto& ps1, const auto& ps2) {
-                            return ps1.curvature < ps2.curvature;
-                          });
-
-  const std::array xlim = {round(xmin->distance * 1000.0) / 1000.0,
-                           round(xmax->distance * 1000.0) / 1000.0};
-  std::array ylim = {round(ymin->distance * 1000.0) / 1000.0,
-                     round(ymax->distance * 1000.0) / 1000.0};
-
-  SPDLOG_INFO("====[Computing  Histograms]====");
-  SPDLOG_INFO("[Bins] ==>> {} x {}", (*bins_)[0], (*bins_)[1]);
-  SPDLOG_INFO("[XLim] ==>> [{}, {}]", xlim[0], xlim[1]);
-  SPDLOG_INFO("[YLim] ==>> [{}, {}]", ylim[0], ylim[1]);
-
-  for (const auto& samples : sampleData) {
-    std::vector<double> curvatures;  // y
-    std::vector<double> distances;   // x
-
-    std::for_each(samples.begin(), samples.end(),
-                  [&](const PathSample& sample) {
-                    curvatures.emplace_back(sample.curvature);
-                    distances.emplace_back(sample.distance);
-                  });
-
-    const auto temp_histo =
-        histo::construct2DHistogram(distances, curvatures, *bins_, xlim, ylim);
-    histograms.emplace_back(histo::normalize(util::flatten(temp_histo)));
+std::vector<PathSample> TopologyRegion::loadBinarySamples_(
+    std::string_view data) {
+  util::BinaryCursor cursor{data, util::BinaryCursor::Endian::little};
+  const auto format = OutputFormat::readHeader(cursor, SAMPLE_MAGIC);
+  [[maybe_unused]] const auto details = cursor.readString();
+  const auto values = format.readReals(cursor);
+  if (values.size() % 2 != 0) {
+    throw cpet::io_error("Odd number of values in binary topology samples");
   }
 
-  return histograms;
-}
-std::vector<std::vector<double>> TopologyRegion::constructMatrix_(
-    const std::vector<std::vector<double>>& histograms) {
-  Timer t;
-  std::vector<std::vector<double>> result;
-  result.reserve(histograms.size());
-
-  std::transform(
-      histograms.begin(), histograms.end(), std::back_inserter(result),
-      [&](const auto& h1) {
-        std::vector<double> tempRow;
-        tempRow.reserve(histograms.size());
-        std::transform(
-            histograms.begin(), histograms.end(), std::back_inserter(tempRow),
-            [&](const auto& h2) { return histo::chiDistance(h1, h2); });
-        return tempRow;
-      });
-
+  std::vector<PathSample> result;
+  result.reserve(values.size() / 2);
+  for (size_t i = 0; i < values.size(); i += 2) {
+    result.push_back(PathSample{values[i], values[i + 1]});
+  }
   return result;
 }
 void TopologyRegion::writeMatrixOutput_(
-    const std::vector<std::vector<double>>& matrix) const {
+    const histo::DistanceMatrix& matrix) const {
   assert(static_cast<bool>(matrixOutput_));
   if (!matrixOutput_) {
     return;
@@ -339,10 +641,15 @@ void TopologyRegion::writeMatrixOutput_(
   std::ofstream outFile(file, std::ios::out);
   if (outFile.is_open()) {
     outFile << "#Bins: " << (*bins_)[0] << 'x' << (*bins_)[1] << '\n';
+    if (packedMatrix_) {
+      outFile << "#Packed: upper triangle of " << matrix.size()
+              << " frames\n";
+    }
     outFile << std::fixed << std::setprecision(4);
-    for (const auto& row : matrix) {
-      for (const auto& col : row) {
-        outFile << col << ' ';
+    /* Packed, row i only holds the distances to the frames after it */
+    for (size_t i = 0; i < matrix.size(); i++) {
+      for (size_t j = packedMatrix_ ? i + 1 : 0; j < matrix.size(); j++) {
+        outFile << matrix(i, j) << ' ';
       }
       outFile << '\n';
     }
@@ -0,0 +1,193 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "TrajectoryReader.h"
+
+/* C++ STL HEADER FILES */
+#include <array>
+#include <string>
+#include <utility>
+
+/* EXTERNAL LIBRARY HEADER FILES */
+#include <spdlog/spdlog.h>
+
+/* CPET HEADER FILES */
+#include "AtomID.h"
+#include "DCDTrajectoryReader.h"
+#include "Exceptions.h"
+#include "Utilities.h"
+#include "XTCTrajectoryReader.h"
+
+namespace cpet {
+
+std::vector<Frame> TrajectoryReader::next(const size_t count) {
+  std::vector<Frame> frames;
+  frames.reserve(count);
+  while (frames.size() < count) {
+    auto frame = next();
+    if (!frame) {
+      break;
+    }
+    frames.emplace_back(std::move(*frame));
+  }
+  return frames;
+}
+
+void TrajectoryReader::replaceCharges(std::vector<double> charges) {
+  std::vector<std::vector<double>> sets;
+  sets.push_back(std::move(charges));
+  replaceChargeSets(std::move(sets));
+}
+
+void TrajectoryReader::replaceChargeSets(
+    std::vector<std::vector<double>> sets) {
+  if (topology_ != nullptr) {
+    topology_ = std::make_shared<const Topology>(
+        topology_->withChargeSets(std::move(sets)));
+  } else {
+    chargeSets_ = std::move(sets);
+  }
+}
+
+void TrajectoryReader::setTopology(std::shared_ptr<const Topology> topology) {
+  if (chargeSets_) {
+    topology = std::make_shared<const Topology>(
+        topology->withChargeSets(std::move(*chargeSets_)));
+    chargeSets_.reset();
+  }
+  topology_ = std::move(topology);
+}
+
+std::unique_ptr<TrajectoryReader> TrajectoryReader::open(
+    const std::string& file, const int start, const int step,
+    std::shared_ptr<const Topology> topology) {
+  SPDLOG_DEBUG("Streaming point charge trajectory from {} ...", file);
+  if (util::endswith(file, ".dcd") || util::endswith(file, ".xtc")) {
+    if (topology == nullptr) {
+      throw cpet::value_error(
+          "Binary trajectory " + file +
+          " requires a pdb or pqr file with the topology and charges");
+    }
+    if (util::endswith(file, ".dcd")) {
+      return std::make_unique<DCDTrajectoryReader>(file, std::move(topology),
+                                                   start, step);
+    }
+    return std::make_unique<XTCTrajectoryReader>(file, std::move(topology),
+                                                 start, step);
+  }
+
+  std::unique_ptr<TrajectoryReader> reader;
+  if (util::endswith(file, ".pqr")) {
+    reader = std::make_unique<PDBTrajectoryReader>(
+        file, constants::FileType::pqr, start, step);
+  } else {
+    /* Assume we have a pdb then */
+    reader = std::make_unique<PDBTrajectoryReader>(
+        file, constants::FileType::pdb, start, step);
+  }
+  if (topology != nullptr) {
+    reader->replaceChargeSets(topology->chargeSets());
+  }
+  return reader;
+}
+
+PDBTrajectoryReader::PDBTrajectoryReader(const std::string& file,
+                                         const constants::FileType type,
+                                         const int start, const int step)
+    : TrajectoryReader(start, step),
+      file_(file),
+      lines_(file_.view()),
+      type_(type) {}
+
+std::optional<Frame> PDBTrajectoryReader::next() {
+  std::vector<Eigen::Vector3d> coordinates;
+  /* Only the first selected model fills in the topology */
+  const bool firstModel = (topology() == nullptr);
+  AtomTable atoms;
+  std::vector<double> charges;
+  if (!firstModel) {
+    coordinates.reserve(topology()->size());
+  }
+  bool sawAtoms = false;
+
+  const auto makeFrame = [&]() -> Frame {
+    ++structureIndex_;
+    if (firstModel) {
+      setTopology(std::make_shared<const Topology>(std::move(atoms),
+                                                   std::move(charges)));
+    } else if (coordinates.size() != topology()->size()) {
+      throw cpet::value_error(
+          "Inconsistent number of atoms in model " +
+          std::to_string(structureIndex_) + " of trajectory");
+    }
+    return Frame{std::move(coordinates), topology()};
+  };
+
+  while (const auto line = lines_.next()) {
+    if (util::startswith(*line, "ENDMDL")) {
+      if (selected(structureIndex_)) {
+        return makeFrame();
+      }
+      ++structureIndex_;
+      continue;
+    }
+    /* Lines of unselected structures are skipped without parsing */
+    if (selected(structureIndex_) && (util::startswith(*line, "ATOM") ||
+                                      util::startswith(*line, "HETATM"))) {
+      auto pc = parse_(*line);
+      coordinates.emplace_back(pc.coordinate);
+      if (firstModel) {
+        charges.push_back(pc.charge);
+        atoms.push_back(AtomID::generateID(*line, type_));
+      }
+      sawAtoms = true;
+    }
+  }
+
+  /* A final model need not be terminated by ENDMDL */
+  if (sawAtoms) {
+    return makeFrame();
+  }
+  return std::nullopt;
+}
+
+PointCharge PDBTrajectoryReader::parse_(const std::string_view line) const {
+  if (type_ == constants::FileType::pqr) {
+    /* Whitespace separated: the coordinates and charge follow the fields the
+     * AtomID reads */
+    std::string_view rest = line;
+    std::array<std::string_view, constants::PQR_CHARGE_INDEX + 1> tokens;
+    for (auto& token : tokens) {
+      token = util::nextToken(rest);
+      if (token.empty()) {
+        throw cpet::value_error("pqr line too short: " + std::string{line});
+      }
+    }
+    const auto number = [&tokens](const size_t index) -> double {
+      return util::parseDouble(tokens[index]);
+    };
+    return {Eigen::Vector3d({number(constants::PQR_XCOORD_INDEX),
+                             number(constants::PQR_YCOORD_INDEX),
+                             number(constants::PQR_ZCOORD_INDEX)}),
+            number(constants::PQR_CHARGE_INDEX)};
+  }
+
+  /* Fixed columns. As with std::stod, the first number in the columns is
+   * read and anything after it ignored. */
+  const auto column = [&line](const size_t start,
+                              const size_t width) -> double {
+    if (line.size() <= start) {
+      throw cpet::value_error("pdb line too short: " + std::string{line});
+    }
+    auto field = line.substr(start, width);
+    return util::parseDouble(util::nextToken(field));
+  };
+  return {Eigen::Vector3d({column(constants::PDB_XCOORD_START,
+                                  constants::PDB_COORD_WIDTH),
+                           column(constants::PDB_YCOORD_START,
+                                  constants::PDB_COORD_WIDTH),
+                           column(constants::PDB_ZCOORD_START,
+                                  constants::PDB_COORD_WIDTH)}),
+          column(constants::PDB_CHARGE_START, constants::PDB_CHARGE_WIDTH)};
+}
+}  // namespace cpet
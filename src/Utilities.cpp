@@ -7,6 +7,7 @@
 #else
   #include <numeric>
 #endif
+#include <charconv>
 #include <sstream>
 
 /* CPET HEADER FILES */
@@ -44,6 +45,31 @@ std::vector<std::string> split(const std::string_view str, char delim) {
   return result;
 }
 
+std::optional<double> toDouble(const std::string_view str) noexcept {
+  auto number = trim(str);
+  /* std::from_chars takes a '-' but not a '+', which std::stod allowed */
+  if (!number.empty() && number.front() == '+') {
+    number.remove_prefix(1);
+    if (!number.empty() && number.front() == '-') {
+      return std::nullopt;
+    }
+  }
+  const char* last = number.data() + number.size();
+  double result{0};
+  const auto [end, error] = std::from_chars(number.data(), last, result);
+  if (number.empty() || error != std::errc{} || end != last) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+double parseDouble(const std::string_view str) {
+  if (const auto result = toDouble(str)) {
+    return *result;
+  }
+  throw cpet::value_error("Invalid number: " + std::string{str});
+}
+
 bool isDouble(std::string str) noexcept {
   double result{0};
   /* This removes the trailing whitespace */
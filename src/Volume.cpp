@@ -46,6 +46,7 @@ std::unique_ptr<Volume> makeBox(const std::vector<std::string>& options) {
 
 std::unique_ptr<Volume> Volume::generateVolume(
     const std::vector<std::string>& options) {
+  /* Shapes added here should also be listed in visitVolume */
   static const std::unordered_map<
       std::string,
       std::function<std::unique_ptr<Volume>(const std::vector<std::string>&)>>
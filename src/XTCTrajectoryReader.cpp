@@ -0,0 +1,347 @@
+// Copyright(c) 2020-Present, Matthew R. Hennefarth
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#include "XTCTrajectoryReader.h"
+
+/* C++ STL HEADER FILES */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/* CPET HEADER FILES */
+#include "Exceptions.h"
+
+namespace cpet {
+
+namespace {
+constexpr int32_t XTC_MAGIC = 1995;
+constexpr double NM_TO_ANGSTROM = 10.0;
+/* Up to this many atoms the coordinates are stored as plain floats */
+constexpr size_t MAX_UNCOMPRESSED_ATOMS = 9;
+/* Three sizes above this are too large to combine into one integer */
+constexpr uint32_t MAX_COMBINED_SIZE = 0xffffff;
+
+/* Ranges of the small differences between neighboring atoms, growing by
+ * about 2^(1/3). The values, quirks included, are fixed by the format. */
+constexpr std::array<int, 73> MAGIC_INTS{
+    0,        0,        0,       0,       0,       0,        0,
+    0,        0,        8,       10,      12,      16,       20,
+    25,       32,       40,      50,      64,      80,       101,
+    128,      161,      203,     256,     322,     406,      512,
+    645,      812,      1024,    1290,    1625,    2048,     2580,
+    3250,     4096,     5060,    6501,    8192,    10321,    13003,
+    16384,    20642,    26007,   32768,   41285,   52015,    65536,
+    82570,    104031,   131072,  165140,  208063,  262144,   330280,
+    416127,   524287,   660561,  832255,  1048576, 1321122,  1664510,
+    2097152,  2642245,  3329021, 4194304, 5284491, 6658042,  8388607,
+    10568983, 13316085, 16777216};
+constexpr int FIRST_INDEX = 9;
+constexpr int LAST_INDEX = static_cast<int>(MAGIC_INTS.size()) - 1;
+
+using Sizes = std::array<uint32_t, 3>;
+using IntCoordinate = std::array<int, 3>;
+
+/* Bits needed to store values up to size */
+int sizeOfInt(const uint32_t size) noexcept {
+  uint64_t num = 1;
+  int bits = 0;
+  while (size >= num && bits < 32) {
+    bits++;
+    num <<= 1U;
+  }
+  return bits;
+}
+
+/* Bits needed to store three values below sizes combined into one integer */
+int sizeOfInts(const Sizes& sizes) noexcept {
+  std::array<uint32_t, 32> bytes{};
+  size_t numberOfBytes = 1;
+  bytes[0] = 1;
+  for (const auto size : sizes) {
+    uint32_t carry = 0;
+    size_t byte = 0;
+    for (; byte < numberOfBytes; byte++) {
+      carry += bytes[byte] * size;
+      bytes[byte] = carry & 0xffU;
+      carry >>= 8U;
+    }
+    while (carry != 0) {
+      bytes[byte++] = carry & 0xffU;
+      carry >>= 8U;
+    }
+    numberOfBytes = byte;
+  }
+  uint32_t num = 1;
+  int bits = 0;
+  while (bytes[numberOfBytes - 1] >= num) {
+    bits++;
+    num *= 2;
+  }
+  return bits + static_cast<int>(numberOfBytes - 1) * 8;
+}
+
+/* Most significant bit first reader over the compressed coordinates */
+class BitReader {
+ public:
+  explicit BitReader(std::string_view bytes) noexcept : bytes_(bytes) {}
+
+  [[nodiscard]] uint32_t receiveBits(int bits) {
+    const uint32_t mask =
+        (bits >= 32) ? ~uint32_t{0} : (uint32_t{1} << bits) - 1;
+    uint32_t num = 0;
+    while (bits >= 8) {
+      lastByte_ = (lastByte_ << 8U) | nextByte_();
+      num |= (lastByte_ >> lastBits_) << static_cast<uint32_t>(bits - 8);
+      bits -= 8;
+    }
+    if (bits > 0) {
+      const auto remaining = static_cast<uint32_t>(bits);
+      if (lastBits_ < remaining) {
+        lastBits_ += 8;
+        lastByte_ = (lastByte_ << 8U) | nextByte_();
+      }
+      lastBits_ -= remaining;
+      num |= (lastByte_ >> lastBits_) & ((uint32_t{1} << remaining) - 1);
+    }
+    return num & mask;
+  }
+
+  /* Three values below sizes, stored combined in bits bits */
+  void receiveInts(int bits, const Sizes& sizes, IntCoordinate& nums) {
+    std::array<uint32_t, 32> bytes{};
+    size_t numberOfBytes = 0;
+    while (bits > 8) {
+      bytes[numberOfBytes++] = receiveBits(8);
+      bits -= 8;
+    }
+    if (bits > 0) {
+      bytes[numberOfBytes++] = receiveBits(bits);
+    }
+    for (size_t i = 2; i > 0; i--) {
+      uint32_t num = 0;
+      for (size_t j = numberOfBytes; j-- > 0;) {
+        num = (num << 8U) | bytes[j];
+        const uint32_t quotient = num / sizes[i];
+        bytes[j] = quotient;
+        num -= quotient * sizes[i];
+      }
+      nums[i] = static_cast<int>(num);
+    }
+    nums[0] = static_cast<int>(bytes[0] | (bytes[1] << 8U) |
+                               (bytes[2] << 16U) | (bytes[3] << 24U));
+  }
+
+ private:
+  std::string_view bytes_;
+  size_t position_{0};
+  uint32_t lastBits_{0};
+  uint32_t lastByte_{0};
+
+  [[nodiscard]] uint32_t nextByte_() {
+    if (position_ >= bytes_.size()) {
+      throw cpet::io_error("Corrupt compressed coordinates in XTC file");
+    }
+    return static_cast<unsigned char>(bytes_[position_++]);
+  }
+};
+
+/* Every atom is either stored in full, relative to the minimum, or as a
+ * small difference from the atom before it. A run of small differences
+ * follows an atom in full, and the first of the run is stored swapped with
+ * it (water compresses better that way). */
+std::vector<Eigen::Vector3d> decompress(BitReader& bits, const size_t atoms,
+                                        const float precision,
+                                        const IntCoordinate& minInt,
+                                        const IntCoordinate& maxInt,
+                                        int smallIndex) {
+  Sizes sizeInt{};
+  for (size_t k = 0; k < 3; k++) {
+    sizeInt[k] = static_cast<uint32_t>(maxInt[k] - minInt[k] + 1);
+  }
+  std::array<int, 3> bitSizeInt{};
+  int bitSize = 0;
+  if ((sizeInt[0] | sizeInt[1] | sizeInt[2]) > MAX_COMBINED_SIZE) {
+    for (size_t k = 0; k < 3; k++) {
+      bitSizeInt[k] = sizeOfInt(sizeInt[k]);
+    }
+  } else {
+    bitSize = sizeOfInts(sizeInt);
+  }
+
+  const auto checkIndex = [](int index) {
+    if (index < FIRST_INDEX || index > LAST_INDEX) {
+      throw cpet::io_error("Corrupt compressed coordinates in XTC file");
+    }
+    return static_cast<size_t>(index);
+  };
+  checkIndex(smallIndex);
+  int smaller =
+      MAGIC_INTS[checkIndex(std::max(FIRST_INDEX, smallIndex - 1))] / 2;
+  int smallNum = MAGIC_INTS[checkIndex(smallIndex)] / 2;
+  Sizes sizeSmall{};
+  sizeSmall.fill(static_cast<uint32_t>(MAGIC_INTS[checkIndex(smallIndex)]));
+
+  const float inversePrecision = 1.0F / precision;
+  std::vector<Eigen::Vector3d> coordinates;
+  coordinates.reserve(atoms);
+  const auto emit = [&](const IntCoordinate& c) {
+    if (coordinates.size() >= atoms) {
+      throw cpet::io_error("Corrupt compressed coordinates in XTC file");
+    }
+    /* Scaled in single precision, as the file was written */
+    coordinates.emplace_back(
+        static_cast<double>(static_cast<float>(c[0]) * inversePrecision),
+        static_cast<double>(static_cast<float>(c[1]) * inversePrecision),
+        static_cast<double>(static_cast<float>(c[2]) * inversePrecision));
+    coordinates.back() *= NM_TO_ANGSTROM;
+  };
+
+  /* A run length carries over to atoms that do not give a new one */
+  int run = 0;
+  while (coordinates.size() < atoms) {
+    IntCoordinate current{};
+    if (bitSize == 0) {
+      for (size_t k = 0; k < 3; k++) {
+        current[k] = static_cast<int>(bits.receiveBits(bitSizeInt[k]));
+      }
+    } else {
+      bits.receiveInts(bitSize, sizeInt, current);
+    }
+    for (size_t k = 0; k < 3; k++) {
+      current[k] += minInt[k];
+    }
+    IntCoordinate previous = current;
+
+    int isSmaller = 0;
+    if (bits.receiveBits(1) == 1) {
+      run = static_cast<int>(bits.receiveBits(5));
+      isSmaller = run % 3;
+      run -= isSmaller;
+      isSmaller--;
+    }
+
+    if (run > 0) {
+      for (int k = 0; k < run; k += 3) {
+        bits.receiveInts(smallIndex, sizeSmall, current);
+        for (size_t j = 0; j < 3; j++) {
+          current[j] += previous[j] - smallNum;
+        }
+        if (k == 0) {
+          std::swap(current, previous);
+          emit(previous);
+        } else {
+          previous = current;
+        }
+        emit(current);
+      }
+    } else {
+      emit(current);
+    }
+
+    smallIndex += isSmaller;
+    if (isSmaller < 0) {
+      smallNum = smaller;
+      smaller = (smallIndex > FIRST_INDEX)
+                    ? MAGIC_INTS[checkIndex(smallIndex - 1)] / 2
+                    : 0;
+    } else if (isSmaller > 0) {
+      smaller = smallNum;
+      smallNum = MAGIC_INTS[checkIndex(smallIndex)] / 2;
+    }
+    sizeSmall.fill(static_cast<uint32_t>(MAGIC_INTS[checkIndex(smallIndex)]));
+  }
+  return coordinates;
+}
+}  // namespace
+
+XTCTrajectoryReader::XTCTrajectoryReader(
+    const std::string& file, std::shared_ptr<const Topology> topology,
+    const int start, const int step)
+    : TrajectoryReader(start, step),
+      file_(file),
+      cursor_(file_.view(), util::BinaryCursor::Endian::big),
+      numberOfAtoms_(topology->size()) {
+  setTopology(std::move(topology));
+}
+
+std::optional<Frame> XTCTrajectoryReader::next() {
+  while (!cursor_.atEnd()) {
+    readHeader_();
+    if (selected(structureIndex_++)) {
+      return Frame{readCoordinates_(), topology()};
+    }
+    skipCoordinates_();
+  }
+  return std::nullopt;
+}
+
+void XTCTrajectoryReader::readHeader_() {
+  if (cursor_.readInt32() != XTC_MAGIC) {
+    throw cpet::io_error("Corrupt frame header in XTC file");
+  }
+  const auto atoms = cursor_.readInt32();
+  if (atoms < 0 || static_cast<size_t>(atoms) != numberOfAtoms_) {
+    throw cpet::value_error("Number of atoms in XTC file (" +
+                            std::to_string(atoms) +
+                            ") does not match the topology (" +
+                            std::to_string(numberOfAtoms_) + ")");
+  }
+  /* Step, time and box */
+  cursor_.skip(2 * sizeof(int32_t) + 9 * sizeof(float));
+  if (cursor_.readInt32() != atoms) {
+    throw cpet::io_error("Corrupt frame header in XTC file");
+  }
+}
+
+void XTCTrajectoryReader::skipCoordinates_() {
+  if (numberOfAtoms_ <= MAX_UNCOMPRESSED_ATOMS) {
+    cursor_.skip(3 * numberOfAtoms_ * sizeof(float));
+    return;
+  }
+  /* Precision, minimum, maximum and small index */
+  cursor_.skip(8 * sizeof(int32_t));
+  const auto bytes = static_cast<size_t>(cursor_.readInt32());
+  /* XDR pads opaque data to whole words */
+  cursor_.skip((bytes + 3) / 4 * 4);
+}
+
+std::vector<Eigen::Vector3d> XTCTrajectoryReader::readCoordinates_() {
+  if (numberOfAtoms_ <= MAX_UNCOMPRESSED_ATOMS) {
+    std::vector<Eigen::Vector3d> coordinates(numberOfAtoms_);
+    for (auto& coordinate : coordinates) {
+      for (Eigen::Index k = 0; k < 3; k++) {
+        coordinate[k] =
+            static_cast<double>(cursor_.readFloat()) * NM_TO_ANGSTROM;
+      }
+    }
+    return coordinates;
+  }
+
+  const float precision = cursor_.readFloat();
+  if (!(precision > 0.0F)) {
+    throw cpet::io_error("Invalid precision in XTC file");
+  }
+  IntCoordinate minInt{};
+  IntCoordinate maxInt{};
+  for (auto& value : minInt) {
+    value = cursor_.readInt32();
+  }
+  for (auto& value : maxInt) {
+    value = cursor_.readInt32();
+  }
+  const int smallIndex = cursor_.readInt32();
+  const auto bytes = cursor_.readInt32();
+  if (bytes < 0) {
+    throw cpet::io_error("Corrupt compressed coordinates in XTC file");
+  }
+  const auto size = static_cast<size_t>(bytes);
+  BitReader bits{cursor_.readBytes(size)};
+  cursor_.skip((size + 3) / 4 * 4 - size);
+
+  return decompress(bits, numberOfAtoms_, precision, minInt, maxInt,
+                    smallIndex);
+}
+}  // namespace cpet
@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 /* EXTERNAL LIBRARY HEADER FILES */
 #include <spdlog/sinks/stdout_sinks.h>
@@ -14,7 +15,9 @@
 
 /* CPET HEADER FILES */
 #include "Calculator.h"
+#include "Cluster.h"
 #include "Exceptions.h"
+#include "Instrumentation.h"
 #include "config.h"
 
 std::optional<std::string> validPDBFile(const cxxopts::ParseResult& result) {
@@ -35,13 +38,18 @@ std::optional<std::string> validOptionFile(const cxxopts::ParseResult& result) {
   return std::nullopt;
 }
 
-std::optional<std::string> validChargeFile(const cxxopts::ParseResult& result) {
-  if (!result["charges"].as<std::string>().empty()) {
-    if (!std::filesystem::exists(result["charges"].as<std::string>())) {
+std::optional<std::vector<std::string>> validChargeFiles(
+    const cxxopts::ParseResult& result) {
+  if (result.count("charges") == 0) {
+    return std::vector<std::string>{};
+  }
+  const auto files = result["charges"].as<std::vector<std::string>>();
+  for (const auto& file : files) {
+    if (!std::filesystem::exists(file)) {
       return std::nullopt;
     }
   }
-  return result["charges"].as<std::string>();
+  return files;
 }
 
 std::optional<int> validThreads(const cxxopts::ParseResult& result) {
@@ -52,6 +60,9 @@ std::optional<int> validThreads(const cxxopts::ParseResult& result) {
 }
 
 int main(int argc, char** argv) {
+  /* Every rank of an MPI run parses the same command line */
+  const cpet::util::Cluster::Session session{argc, argv};
+  const auto& cluster = cpet::util::Cluster::instance();
   spdlog::set_pattern("%v");
 
   cxxopts::Options options(
@@ -61,17 +72,29 @@ int main(int argc, char** argv) {
   options.add_options()(
       "d,debug", "Enable debugging",
       cxxopts::value<bool>()->default_value("false"))  // a bool parameter
-      ("p,protein", "PDB", cxxopts::value<std::string>())(
+      ("p,protein", "PDB, PQR, DCD or XTC trajectory",
+       cxxopts::value<std::string>())(
           "o,options", "Option file", cxxopts::value<std::string>())(
-          "c,charges", "Partial atomic charge definitions",
-          cxxopts::value<std::string>()->default_value(""))(
+          "c,charges",
+          "Partial atomic charge definitions (PDB or PQR); the topology of "
+          "DCD and XTC trajectories. Several files (comma separated or "
+          "repeated) give fields for each charge set in one run",
+          cxxopts::value<std::vector<std::string>>())(
           "t,threads", "Number of threads",
           cxxopts::value<int>()->default_value("1"))(
           "O,out", "[DEPRECATED!] Output file",
           cxxopts::value<std::string>()->default_value(""))("h,help",
                                                             "Print usage")(
           "v,verbose", "Verbose output",
-          cxxopts::value<bool>()->default_value("false"));
+          cxxopts::value<bool>()->default_value("false"))(
+          "profile",
+          "Write stage times and work counters to this file at exit (CSV if "
+          "it ends in .csv, JSON otherwise)",
+          cxxopts::value<std::string>()->default_value(""))(
+          "device",
+          "Compute fields and streamlines on the cpu or the gpu (builds with "
+          "ENABLE_CUDA)",
+          cxxopts::value<std::string>()->default_value("cpu"));
 
   std::unique_ptr<cxxopts::ParseResult> tmp_result{nullptr};
   try {
@@ -102,6 +125,10 @@ int main(int argc, char** argv) {
   }
 
 #endif
+  /* The other ranks of an MPI run only report problems */
+  if (!cluster.root()) {
+    spdlog::set_level(spdlog::level::warn);
+  }
 
   if (result.count("help") != 0) {
     SPDLOG_WARN(options.help());
@@ -129,28 +156,45 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  std::optional<std::string> chargesFile;
-  if (!(chargesFile = validChargeFile(result))) {
+  std::optional<std::vector<std::string>> chargesFiles;
+  if (!(chargesFiles = validChargeFiles(result))) {
     SPDLOG_WARN("Invalid charge file");
     SPDLOG_WARN(options.help());
     return EXIT_FAILURE;
   }
+  const auto profileFile = result["profile"].as<std::string>();
+  if (!profileFile.empty()) {
+    cpet::util::Profiler::instance().enable();
+  }
+
   /* Begin the actual program here */
   try {
-    cpet::Calculator c(proteinFile.value(), optionFile.value(),
-                       chargesFile.value(), numberOfThreads.value());
+    cpet::Calculator c(
+        proteinFile.value(), optionFile.value(), chargesFiles.value(),
+        numberOfThreads.value(),
+        cpet::Device::fromString(result["device"].as<std::string>()));
     if (!result["out"].as<std::string>().empty()) {
       SPDLOG_WARN(
           "DEPRECATION WARNING: -O is deprecated and does not do anything! Use "
           "block sections to define output");
     }
     c.compute();
+    if (!profileFile.empty() && cluster.root()) {
+      cpet::util::Profiler::instance().writeReport(profileFile);
+    }
   } catch (const cpet::exception& exc) {
     SPDLOG_ERROR(exc.what());
+    /* The other ranks may be waiting on this one */
+    if (cluster.size() > 1) {
+      cluster.abort(EXIT_FAILURE);
+    }
     return EXIT_FAILURE;
   } catch (const std::exception& exc) {
     SPDLOG_ERROR("Unknown exception occured while running");
     SPDLOG_ERROR(exc.what());
+    if (cluster.size() > 1) {
+      cluster.abort(EXIT_FAILURE);
+    }
     return EXIT_FAILURE;
   }
 
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "Cluster.h"
+
+TEST(Cluster, SingleProcessOwnsEverything) {
+  const auto& cluster = cpet::util::Cluster::instance();
+  EXPECT_EQ(cluster.rank(), 0);
+  EXPECT_EQ(cluster.size(), 1);
+  EXPECT_TRUE(cluster.root());
+
+  const auto [begin, end] = cluster.share(17);
+  EXPECT_EQ(begin, 0);
+  EXPECT_EQ(end, 17);
+  EXPECT_EQ(cluster.sum(5), 5);
+
+  double min = -1.0;
+  double max = 2.0;
+  cluster.extremes(min, max);
+  EXPECT_EQ(min, -1.0);
+  EXPECT_EQ(max, 2.0);
+}
+
+TEST(Cluster, WriteOrderedPutsHeaderFirst) {
+  constexpr const char* FILE_NAME = "cluster_test.txt";
+  {
+    std::ofstream old(FILE_NAME);
+    old << "an older and much longer file";
+  }
+  cpet::util::Cluster::instance().writeOrdered(FILE_NAME, "#header\n",
+                                               "1,2\n");
+  std::ifstream in(FILE_NAME);
+  const std::string contents{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_EQ(contents, "#header\n1,2\n");
+  std::filesystem::remove(FILE_NAME);
+}
@@ -0,0 +1,408 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "ElectricField.h"
+#include "Exceptions.h"
+#include "FarFieldExpansion.h"
+#include "FieldGrid.h"
+#include "FieldSolver.h"
+#include "GpuField.h"
+#include "Octree.h"
+#include "PointChargeStore.h"
+
+namespace {
+cpet::PointChargeStore randomStore(size_t count) {
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> coord(-20.0, 20.0);
+  std::uniform_real_distribution<double> charge(-1.0, 1.0);
+  cpet::PointChargeStore store;
+  for (size_t i = 0; i < count; i++) {
+    store.push_back({coord(gen), coord(gen), coord(gen)}, charge(gen));
+  }
+  return store;
+}
+}  // namespace
+
+TEST(ElectricField, SingleCharge) {
+  cpet::PointChargeStore store;
+  store.push_back({0, 0, 0}, 1);
+
+  const Eigen::Vector3d field =
+      cpet::field::electricFieldAt(store, Eigen::Vector3d{1, 1, 1});
+  const Eigen::Vector3d expected{2.77121, 2.77121, 2.77121};
+  EXPECT_NEAR((field - expected).norm(), 0, 0.00001);
+}
+
+TEST(ElectricField, EmptyStore) {
+  cpet::PointChargeStore store;
+  EXPECT_EQ(cpet::field::electricFieldAt(store, Eigen::Vector3d{1, 2, 3}),
+            Eigen::Vector3d::Zero());
+}
+
+TEST(ElectricField, KernelsAgree) {
+  /* Odd size so the vector kernels also exercise their scalar tail */
+  const auto store = randomStore(1021);
+  const Eigen::Vector3d position{25.0, -3.5, 1.25};
+
+  const Eigen::Vector3d reference = cpet::field::electricFieldAt(
+      store, position, cpet::field::KernelISA::scalar);
+
+  for (const auto isa :
+       {cpet::field::KernelISA::avx2, cpet::field::KernelISA::avx512}) {
+    const Eigen::Vector3d field =
+        cpet::field::electricFieldAt(store, position, isa);
+    EXPECT_NEAR((field - reference).norm() / reference.norm(), 0, 1e-12)
+        << cpet::field::name(isa);
+  }
+  const Eigen::Vector3d dispatched =
+      cpet::field::electricFieldAt(store, position);
+  EXPECT_NEAR((dispatched - reference).norm() / reference.norm(), 0, 1e-12);
+}
+
+TEST(ElectricField, GradientMatchesFiniteDifferences) {
+  const auto store = randomStore(1021);
+  const Eigen::Vector3d position{25.0, -3.5, 1.25};
+  constexpr double STEP = 1e-4;
+
+  Eigen::Matrix3d expected;
+  for (Eigen::Index axis = 0; axis < 3; axis++) {
+    const Eigen::Vector3d offset = STEP * Eigen::Vector3d::Unit(axis);
+    expected.col(axis) =
+        (cpet::field::electricFieldAt(store, position + offset) -
+         cpet::field::electricFieldAt(store, position - offset)) /
+        (2.0 * STEP);
+  }
+  const Eigen::Vector3d field = cpet::field::electricFieldAt(store, position);
+
+  for (const auto isa :
+       {cpet::field::KernelISA::scalar, cpet::field::KernelISA::avx2,
+        cpet::field::KernelISA::avx512}) {
+    const auto value = cpet::field::fieldGradientAt(store, position, isa);
+    EXPECT_NEAR((value.field - field).norm() / field.norm(), 0, 1e-12)
+        << cpet::field::name(isa);
+    EXPECT_NEAR((value.gradient - expected).norm() / expected.norm(), 0, 1e-7)
+        << cpet::field::name(isa);
+  }
+}
+
+TEST(ElectricField, CurvatureOfFieldLines) {
+  /* Field lines of a single charge are straight */
+  cpet::PointChargeStore single;
+  single.push_back({0, 0, 0}, 1);
+  EXPECT_NEAR(cpet::field::curvature(cpet::field::fieldGradientAt(
+                  single, Eigen::Vector3d{1.0, 2.0, -0.5})),
+              0, 1e-12);
+
+  /* Dipole field lines bend as fast as their unit tangent turns */
+  cpet::PointChargeStore dipole;
+  dipole.push_back({-1, 0, 0}, 1);
+  dipole.push_back({1, 0, 0}, -1);
+  const Eigen::Vector3d position{0.3, 0.7, 0.2};
+  constexpr double ARC = 1e-5;
+  const Eigen::Vector3d tangent =
+      cpet::field::electricFieldAt(dipole, position).normalized();
+  const Eigen::Vector3d ahead =
+      cpet::field::electricFieldAt(dipole, position + ARC * tangent)
+          .normalized();
+  const Eigen::Vector3d behind =
+      cpet::field::electricFieldAt(dipole, position - ARC * tangent)
+          .normalized();
+  const double expected = (ahead - behind).norm() / (2.0 * ARC);
+  EXPECT_NEAR(cpet::field::curvature(
+                  cpet::field::fieldGradientAt(dipole, position)),
+              expected, 1e-6 * expected);
+}
+
+TEST(ElectricField, BatchedMatchesSinglePoint) {
+  /* Spans several charge blocks and a partial final point tile */
+  const auto store = randomStore(2 * cpet::field::CHARGE_BLOCK_SIZE + 37);
+
+  std::vector<Eigen::Vector3d> positions;
+  for (size_t i = 0; i < cpet::field::POINT_TILE_SIZE + 5; i++) {
+    const auto offset = static_cast<double>(i);
+    positions.emplace_back(30.0 + offset, -30.0 + 0.5 * offset, 2.0);
+  }
+
+  std::vector<Eigen::Vector3d> results(positions.size());
+  cpet::field::electricFieldAt(store, positions.data(), positions.size(),
+                               results.data());
+
+  for (size_t i = 0; i < positions.size(); i++) {
+    const Eigen::Vector3d expected =
+        cpet::field::electricFieldAt(store, positions[i]);
+    EXPECT_NEAR((results[i] - expected).norm() / expected.norm(), 0, 1e-12);
+  }
+}
+
+TEST(ElectricField, ChargeSetsMatchSeparateStores) {
+  /* More sets than one kernel pass takes, and a partial vector of charges */
+  constexpr size_t SETS = 6;
+  constexpr size_t CHARGES = 1021;
+  std::mt19937 gen(99);
+  std::uniform_real_distribution<double> coord(-20.0, 20.0);
+  std::uniform_real_distribution<double> charge(-1.0, 1.0);
+  cpet::ChargeSetStore sets{SETS};
+  std::vector<cpet::PointChargeStore> stores(SETS);
+  for (size_t i = 0; i < CHARGES; i++) {
+    const Eigen::Vector3d position{coord(gen), coord(gen), coord(gen)};
+    std::array<double, SETS> charges{};
+    for (size_t set = 0; set < SETS; set++) {
+      charges[set] = charge(gen);
+      stores[set].push_back(position, charges[set]);
+    }
+    sets.push_back(position, charges.data());
+  }
+  const std::vector<Eigen::Vector3d> positions{{25.0, -3.5, 1.25},
+                                               {-30.0, 2.0, 0.5}};
+
+  for (const auto isa :
+       {cpet::field::KernelISA::scalar, cpet::field::KernelISA::avx2,
+        cpet::field::KernelISA::avx512}) {
+    std::vector<Eigen::Vector3d> results(positions.size() * SETS);
+    cpet::field::electricFieldsAt(sets, positions.data(), positions.size(),
+                                  results.data(), isa);
+    for (size_t i = 0; i < positions.size(); i++) {
+      for (size_t set = 0; set < SETS; set++) {
+        const Eigen::Vector3d expected =
+            cpet::field::electricFieldAt(stores[set], positions[i]);
+        EXPECT_NEAR(
+            (results[i * SETS + set] - expected).norm() / expected.norm(), 0,
+            1e-12)
+            << cpet::field::name(isa) << " set " << set;
+      }
+    }
+  }
+}
+
+TEST(ElectricField, GroupFieldsAddUpToTotal) {
+  const auto store = randomStore(1021);
+  /* Groups of uneven size, including an empty one */
+  const std::vector<size_t> offsets{0, 1, 300, 300, 1000, 1021};
+  const size_t groups = offsets.size() - 1;
+  const std::vector<Eigen::Vector3d> positions{{25.0, 0.0, -3.0},
+                                               {1.5, -30.0, 2.0}};
+
+  std::vector<Eigen::Vector3d> results(positions.size() * groups);
+  cpet::field::groupFieldsAt(store, offsets, positions.data(),
+                             positions.size(), results.data());
+  for (size_t i = 0; i < positions.size(); i++) {
+    Eigen::Vector3d total = Eigen::Vector3d::Zero();
+    for (size_t group = 0; group < groups; group++) {
+      total += results[i * groups + group];
+    }
+    const auto expected = cpet::field::electricFieldAt(store, positions[i]);
+    EXPECT_NEAR((total - expected).norm() / expected.norm(), 0, 1e-12);
+    EXPECT_EQ(results[i * groups + 2], Eigen::Vector3d::Zero());
+  }
+}
+
+TEST(ElectricField, PacketMatchesSinglePoint) {
+  /* Spans several charge blocks and ends in a partial one */
+  const auto store = randomStore(2 * cpet::field::CHARGE_BLOCK_SIZE + 37);
+
+  cpet::field::PointPacket positions;
+  for (size_t i = 0; i < cpet::field::PACKET_SIZE; i++) {
+    const auto offset = static_cast<double>(i);
+    positions[i] = {30.0 - 2.0 * offset, -25.0 + offset, 0.5 * offset};
+  }
+
+  for (const auto isa :
+       {cpet::field::KernelISA::scalar, cpet::field::KernelISA::avx2,
+        cpet::field::KernelISA::avx512}) {
+    cpet::field::PointPacket fields;
+    cpet::field::electricFieldAt(store, positions, fields, isa);
+    for (size_t i = 0; i < cpet::field::PACKET_SIZE; i++) {
+      const Eigen::Vector3d expected =
+          cpet::field::electricFieldAt(store, positions[i]);
+      EXPECT_NEAR((fields[i] - expected).norm() / expected.norm(), 0, 1e-12)
+          << cpet::field::name(isa) << " lane " << i;
+    }
+
+    /* A lane does not see the other lanes */
+    auto moved = positions;
+    moved[0] = {-40.0, 40.0, 40.0};
+    cpet::field::PointPacket movedFields;
+    cpet::field::electricFieldAt(store, moved, movedFields, isa);
+    for (size_t i = 1; i < cpet::field::PACKET_SIZE; i++) {
+      EXPECT_EQ(movedFields[i], fields[i]) << cpet::field::name(isa);
+    }
+  }
+}
+
+TEST(GpuField, MatchesCpuWithinTolerance) {
+  const auto store = randomStore(300);
+  if (!cpet::gpu::available()) {
+    EXPECT_THROW(cpet::gpu::Charges{store}, cpet::value_error);
+    return;
+  }
+  const std::vector<Eigen::Vector3d> positions{
+      {25.0, -3.5, 1.25}, {0.5, 0.5, 0.5}, {-30.0, 12.0, 4.0}};
+  std::vector<Eigen::Vector3d> results(positions.size());
+  const cpet::gpu::Charges charges{store};
+  charges.fieldAt(positions.data(), positions.size(), results.data());
+  for (size_t i = 0; i < positions.size(); i++) {
+    const Eigen::Vector3d expected =
+        cpet::field::electricFieldAt(store, positions[i]);
+    EXPECT_NEAR((results[i] - expected).norm() / expected.norm(), 0,
+                cpet::gpu::FIELD_TOLERANCE);
+  }
+}
+
+TEST(Octree, ZeroOpeningAngleIsExact) {
+  const auto store = randomStore(3000);
+  const cpet::Octree tree{store};
+  ASSERT_FALSE(tree.empty());
+
+  const Eigen::Vector3d position{3.0, -1.5, 0.25};
+  const Eigen::Vector3d expected =
+      cpet::field::electricFieldAt(store, position);
+  const Eigen::Vector3d field = tree.electricFieldAt(position, 0.0);
+  EXPECT_NEAR((field - expected).norm() / expected.norm(), 0, 1e-10);
+}
+
+TEST(Octree, FarFieldApproximation) {
+  const auto store = randomStore(3000);
+  const cpet::Octree tree{store};
+
+  for (const Eigen::Vector3d& position :
+       {Eigen::Vector3d{60.0, 0.0, 0.0}, Eigen::Vector3d{-5.0, 45.0, 10.0},
+        Eigen::Vector3d{1.0, 2.0, 3.0}}) {
+    const Eigen::Vector3d expected =
+        cpet::field::electricFieldAt(store, position);
+    const Eigen::Vector3d field =
+        tree.electricFieldAt(position, cpet::DEFAULT_OPENING_ANGLE);
+    EXPECT_NEAR((field - expected).norm() / expected.norm(), 0, 0.02);
+  }
+}
+
+TEST(Octree, Empty) {
+  const cpet::Octree tree{cpet::PointChargeStore{}};
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.electricFieldAt({1, 1, 1}, 0.5), Eigen::Vector3d::Zero());
+}
+
+TEST(FarFieldExpansion, MatchesDirectNearCenter) {
+  const auto store = randomStore(3000);
+  const Eigen::Vector3d center{2.0, 1.0, -1.0};
+  constexpr double radius = 1.5;
+  const cpet::FarFieldExpansion expansion{store, center, 4 * radius};
+
+  EXPECT_EQ(expansion.numberOfNearCharges() + expansion.numberOfFarCharges(),
+            store.size());
+  EXPECT_GT(expansion.numberOfFarCharges(), expansion.numberOfNearCharges());
+
+  for (const Eigen::Vector3d& offset :
+       {Eigen::Vector3d{0, 0, 0}, Eigen::Vector3d{radius, 0, 0},
+        Eigen::Vector3d{-0.8, 0.8, 0.8}}) {
+    const Eigen::Vector3d position = center + offset;
+    const Eigen::Vector3d expected =
+        cpet::field::electricFieldAt(store, position);
+    const Eigen::Vector3d field = expansion.electricFieldAt(position);
+    EXPECT_NEAR((field - expected).norm() / expected.norm(), 0, 1e-2);
+  }
+}
+
+TEST(FarFieldExpansion, ExactAtCenter) {
+  /* Only the truncated terms vanish at the expansion center */
+  const auto store = randomStore(500);
+  const Eigen::Vector3d center{0.5, 0.5, 0.5};
+  const cpet::FarFieldExpansion expansion{store, center, 2.0};
+
+  const Eigen::Vector3d expected = cpet::field::electricFieldAt(store, center);
+  EXPECT_NEAR((expansion.electricFieldAt(center) - expected).norm() /
+                  expected.norm(),
+              0, 1e-12);
+}
+
+TEST(FieldGrid, ReproducesPolynomials) {
+  /* Each scheme is exact for polynomials up to its order on every axis */
+  const auto linear = [](const Eigen::Vector3d& p) -> Eigen::Vector3d {
+    return {p[0] * p[1] * p[2], 2.0 * p[0] - p[2], 1.0};
+  };
+  const auto cubic = [](const Eigen::Vector3d& p) -> Eigen::Vector3d {
+    return {p[0] * p[0] * p[0] * p[1], p[1] * p[1] * p[2] * p[2], p[2]};
+  };
+  const auto expectReproduces = [](cpet::GridInterpolation::Type type,
+                                    const auto& f) {
+    cpet::FieldGrid grid{{-1, -1, -1}, {1, 2, 1.5}, 0.3, type};
+    const auto nodes = grid.nodes();
+    ASSERT_EQ(nodes.size(), grid.size());
+    std::vector<Eigen::Vector3d> values;
+    std::transform(nodes.begin(), nodes.end(), std::back_inserter(values), f);
+    grid.values(values);
+
+    for (const Eigen::Vector3d& p :
+         {Eigen::Vector3d{0.123, 0.456, -0.789},
+          Eigen::Vector3d{-0.95, 1.9, 1.4}, Eigen::Vector3d{0.5, 0.5, 0.5}}) {
+      EXPECT_NEAR((grid.electricFieldAt(p) - f(p)).norm(), 0, 1e-10);
+    }
+  };
+
+  expectReproduces(cpet::GridInterpolation::Type::trilinear, linear);
+  expectReproduces(cpet::GridInterpolation::Type::tricubic, cubic);
+}
+
+TEST(FieldGrid, MatchesDirectAwayFromCharges) {
+  cpet::PointChargeStore store;
+  store.push_back({6, 0, 0}, 1.0);
+  store.push_back({-5, 3, 1}, -0.5);
+  store.push_back({0, -7, 4}, 0.8);
+  const Eigen::Vector3d lower{-1.5, -1.5, -1.5};
+  const Eigen::Vector3d upper{1.5, 1.5, 1.5};
+
+  for (const auto type : {cpet::GridInterpolation::Type::trilinear,
+                          cpet::GridInterpolation::Type::tricubic}) {
+    cpet::FieldGrid grid{lower, upper, 0.1, type};
+    const auto nodes = grid.nodes();
+    std::vector<Eigen::Vector3d> values(nodes.size());
+    cpet::field::electricFieldAt(store, nodes.data(), nodes.size(),
+                                 values.data());
+    grid.values(values);
+
+    const auto probes = grid.probes(200);
+    ASSERT_FALSE(probes.empty());
+    EXPECT_LE(probes.size(), 200);
+    std::vector<Eigen::Vector3d> exact(probes.size());
+    cpet::field::electricFieldAt(store, probes.data(), probes.size(),
+                                 exact.data());
+    const double tolerance =
+        (type == cpet::GridInterpolation::Type::tricubic) ? 1e-6 : 1e-3;
+    EXPECT_LT(grid.estimateError(probes, exact), tolerance);
+    EXPECT_EQ(grid.errorEstimate(), grid.estimateError(probes, exact));
+  }
+}
+
+TEST(FieldGrid, HandlesFarAndNonFinitePositions) {
+  for (const auto type : {cpet::GridInterpolation::Type::trilinear,
+                          cpet::GridInterpolation::Type::tricubic}) {
+    cpet::FieldGrid grid{{-1, -1, -1}, {1, 1, 1}, 0.5, type};
+    std::vector<Eigen::Vector3d> values(grid.size(), Eigen::Vector3d{1, 2, 3});
+    grid.values(values);
+
+    /* Lattice coordinates beyond the range of int are clamped to the grid */
+    EXPECT_NEAR((grid.electricFieldAt({1e12, 0, -1e12}) -
+                 Eigen::Vector3d{1, 2, 3})
+                    .norm(),
+                0, 1e-6);
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    EXPECT_TRUE(grid.electricFieldAt({nan, 0, 0}).array().isNaN().all());
+    EXPECT_TRUE(grid.electricFieldAt({0, -inf, 0}).array().isNaN().all());
+  }
+}
+
+TEST(FieldGrid, InvalidBounds) {
+  EXPECT_THROW(cpet::FieldGrid({0, 0, 0}, {1, 0, 1}, 0.1,
+                               cpet::GridInterpolation::Type::trilinear),
+               cpet::value_error);
+  EXPECT_THROW(cpet::FieldGrid({0, 0, 0}, {1, 1, 1}, 0.0,
+                               cpet::GridInterpolation::Type::trilinear),
+               cpet::value_error);
+}
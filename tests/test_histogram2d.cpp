@@ -1,6 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "DistanceMatrix.h"
+#include "Exceptions.h"
 #include "Histogram2D.h"
+#include "HistogramCache.h"
+#include "SampleConvergence.h"
+#include "ThreadPool.h"
+#include "TopologyHistograms.h"
 
 TEST(Histogram2D, edges) {
   {
@@ -112,3 +123,209 @@ TEST(Histogram2D, histogram2DSimple) {
     EXPECT_EQ(result[0][1], 1);
   }
 }
+
+TEST(Histogram2D, mergesStreamedSamples) {
+  cpet::histo::Histogram2D first{{2, 2}, {0, 2}, {0, 2}};
+  cpet::histo::Histogram2D second{{2, 2}, {0, 2}, {0, 2}};
+  first.add(0, 0);
+  first.add(1.5, 0);
+  first.add(3, 0);
+  second.add(1, 1);
+  second.add(2, 2);
+
+  first.merge(second);
+  EXPECT_EQ(first.counts(), (std::vector<int>{2, 1, 0, 1}));
+
+  const cpet::histo::Histogram2D other{{2, 2}, {0, 1}, {0, 2}};
+  EXPECT_THROW(first.merge(other), cpet::value_error);
+}
+
+TEST(Histogram2D, axisIndex) {
+  /* Upper edges are inclusive, as in construct2DHistogram */
+  const cpet::histo::Axis uniform{0.0, 1.0, 10};
+  EXPECT_TRUE(uniform.uniform());
+  EXPECT_EQ(uniform.index(0.0), 0);
+  EXPECT_EQ(uniform.index(0.1), 0);
+  EXPECT_EQ(uniform.index(0.3), 2);
+  EXPECT_EQ(uniform.index(0.30001), 3);
+  EXPECT_EQ(uniform.index(0.95), 9);
+  EXPECT_FALSE(uniform.index(-0.01));
+  EXPECT_FALSE(uniform.index(1.01));
+  const auto edges = cpet::histo::constructEdges(0.0, 1.0, 10);
+  for (int i = 0; i <= 1000; i++) {
+    const double value = i / 1000.0;
+    const auto edge = std::lower_bound(edges.begin(), edges.end(), value);
+    if (edge == edges.end()) {
+      EXPECT_FALSE(uniform.index(value));
+    } else {
+      EXPECT_EQ(uniform.index(value),
+                static_cast<size_t>(edge - edges.begin()));
+    }
+  }
+
+  const cpet::histo::Axis uneven{0.0, {0.5, 1.0, 4.0}};
+  EXPECT_FALSE(uneven.uniform());
+  EXPECT_EQ(uneven.index(0.5), 0);
+  EXPECT_EQ(uneven.index(0.7), 1);
+  EXPECT_EQ(uneven.index(3.0), 2);
+  EXPECT_FALSE(uneven.index(4.5));
+  EXPECT_THROW(cpet::histo::Axis(0.0, {1.0, 0.5}), cpet::value_error);
+}
+
+TEST(Histogram2D, addInParallel) {
+  std::vector<std::pair<double, double>> samples;
+  for (int i = 0; i < 50000; i++) {
+    samples.emplace_back((i % 997) / 99.7, (i % 101) / 10.1);
+  }
+  const auto x = [](const std::pair<double, double>& s) { return s.first; };
+  const auto y = [](const std::pair<double, double>& s) { return s.second; };
+
+  cpet::histo::Histogram2D64 serial{{7, 5}, {0, 10}, {0, 10}};
+  for (const auto& [first, second] : samples) {
+    serial.add(first, second);
+  }
+  cpet::util::ThreadPool pool{4};
+  cpet::histo::Histogram2D64 parallel{{7, 5}, {0, 10}, {0, 10}};
+  cpet::histo::addInParallel(parallel, samples, x, y, pool);
+  EXPECT_EQ(parallel.counts(), serial.counts());
+}
+
+TEST(TopologyHistograms, limits) {
+  cpet::util::ThreadPool pool{1};
+  const std::vector<cpet::PathSample> frame0{{0.0, 0.5}, {1.0, 1.0}};
+  const std::vector<cpet::PathSample> frame1{{2.0, 0.0}, {2.0, 0.0}};
+
+  /* Running limits span the samples of every frame */
+  cpet::TopologyHistograms running{{2, 2}, std::nullopt};
+  running.add(frame0, pool);
+  running.add(frame1, pool);
+  const auto limits = running.limits();
+  EXPECT_EQ(limits.distance, (std::array<double, 2>{0.0, 2.0}));
+  EXPECT_EQ(limits.curvature, (std::array<double, 2>{0.0, 1.0}));
+  const auto histograms = running.finish(pool);
+  ASSERT_EQ(histograms.rows(), 2);
+  ASSERT_EQ(histograms.bins(), 4);
+  EXPECT_EQ(std::vector<double>(histograms.row(0), histograms.row(1)),
+            (std::vector<double>{0.5, 0.0, 0.5, 0.0}));
+  EXPECT_EQ(std::vector<double>(histograms.row(1), histograms.row(2)),
+            (std::vector<double>{0.0, 1.0, 0.0, 0.0}));
+
+  /* Fixed limits bin each frame as it is added */
+  cpet::TopologyHistograms fixed{{2, 2},
+                                 cpet::HistogramLimits{{0.0, 4.0}, {0.0, 1.0}}};
+  fixed.add(frame0, pool);
+  fixed.add(frame1, pool);
+  const auto fixedHistograms = fixed.finish(pool);
+  EXPECT_EQ(
+      std::vector<double>(fixedHistograms.row(1), fixedHistograms.row(2)),
+      (std::vector<double>{1.0, 0.0, 0.0, 0.0}));
+}
+
+TEST(ConvergenceMonitor, stopsOnceTheHistogramSettles) {
+  const cpet::SampleConvergence settings{0.01, 4, 4};
+  const std::vector<cpet::PathSample> spread{
+      {0.0, 0.0}, {0.0, 1.0}, {1.0, 0.0}, {1.0, 1.0}};
+  const std::vector<cpet::PathSample> corner(4, cpet::PathSample{0.0, 0.0});
+
+  /* Axes from the range of the first minSamples samples */
+  cpet::ConvergenceMonitor monitor{settings, {2, 2}, std::nullopt};
+  EXPECT_FALSE(monitor.add({spread.begin(), spread.begin() + 2}));
+  EXPECT_FALSE(monitor.add({spread.begin() + 2, spread.end()}));
+  EXPECT_FALSE(monitor.add(corner));
+  EXPECT_GT(monitor.distance(), settings.tolerance);
+  /* A batch in the proportions of the histogram leaves it alone */
+  std::vector<cpet::PathSample> same{corner};
+  same.insert(same.end(), spread.begin(), spread.end());
+  EXPECT_TRUE(monitor.add(same));
+  EXPECT_EQ(monitor.distance(), 0.0);
+  EXPECT_EQ(monitor.count(), 16);
+}
+
+TEST(DistanceMatrix, matchesPairwiseChiDistance) {
+  /* Sizes that leave partial tiles of rows and of bins */
+  constexpr size_t FRAMES = 19;
+  constexpr size_t BINS = 5000;
+  cpet::histo::HistogramMatrix histograms{FRAMES, BINS};
+  std::vector<std::vector<double>> rows(FRAMES);
+  for (size_t frame = 0; frame < FRAMES; frame++) {
+    for (size_t bin = 0; bin < BINS; bin++) {
+      rows[frame].push_back(
+          static_cast<double>((frame * 7 + bin * 13) % 31 == 0) / 100.0);
+    }
+    std::copy(rows[frame].begin(), rows[frame].end(), histograms.row(frame));
+  }
+
+  cpet::util::ThreadPool pool{3};
+  const auto matrix = cpet::histo::chiDistanceMatrix(histograms, pool);
+  ASSERT_EQ(matrix.size(), FRAMES);
+  EXPECT_EQ(matrix.packed().size(), FRAMES * (FRAMES - 1) / 2);
+  for (size_t i = 0; i < FRAMES; i++) {
+    EXPECT_EQ(matrix(i, i), 0.0);
+    for (size_t j = 0; j < FRAMES; j++) {
+      EXPECT_NEAR(matrix(i, j), cpet::histo::chiDistance(rows[i], rows[j]),
+                  1e-12);
+    }
+  }
+}
+
+TEST(DistanceMatrix, extendsWithTheNewFramesOnly) {
+  constexpr size_t FRAMES = 21;
+  constexpr size_t BINS = 3000;
+  cpet::histo::HistogramMatrix histograms{FRAMES, BINS};
+  for (size_t frame = 0; frame < FRAMES; frame++) {
+    for (size_t bin = 0; bin < BINS; bin++) {
+      histograms.row(frame)[bin] =
+          static_cast<double>((frame * 5 + bin * 11) % 29 == 0) / 100.0;
+    }
+  }
+  cpet::util::ThreadPool pool{2};
+  const auto full = cpet::histo::chiDistanceMatrix(histograms, pool);
+
+  /* A cached matrix over the first frames, cut mid tile */
+  cpet::histo::HistogramMatrix first{11, BINS};
+  std::copy(histograms.row(0), histograms.row(11), first.row(0));
+  auto extended = cpet::histo::chiDistanceMatrix(first, pool);
+  cpet::histo::extendChiDistanceMatrix(histograms, extended, pool);
+  EXPECT_EQ(extended.size(), FRAMES);
+  EXPECT_EQ(extended.packed(), full.packed());
+}
+
+TEST(HistogramCache, AppendsFramesAcrossRuns) {
+  constexpr const char* FILE_NAME = "histogram_cache_test.hst";
+  std::filesystem::remove(FILE_NAME);
+  const cpet::HistogramLimits limits{{0.0, 1.0}, {0.0, 2.0}};
+  cpet::histo::HistogramMatrix histograms{5, 4};
+  for (size_t frame = 0; frame < 5; frame++) {
+    histograms.row(frame)[frame % 4] = 1.0;
+  }
+  cpet::histo::HistogramMatrix first{3, 4};
+  std::copy(histograms.row(0), histograms.row(3), first.row(0));
+  cpet::histo::HistogramMatrix second{2, 4};
+  std::copy(histograms.row(3), histograms.row(5), second.row(0));
+  cpet::util::ThreadPool pool{1};
+  {
+    cpet::HistogramCache cache{FILE_NAME, {2, 2}, std::nullopt};
+    EXPECT_EQ(cache.frames(), 0);
+    cache.append(first, limits, pool);
+  }
+  {
+    cpet::HistogramCache cache{FILE_NAME, {2, 2}, std::nullopt};
+    ASSERT_EQ(cache.frames(), 3);
+    EXPECT_EQ(cache.limits()->curvature, limits.curvature);
+    cache.append(second, limits, pool);
+  }
+  const auto full = cpet::histo::chiDistanceMatrix(histograms, pool);
+  {
+    const cpet::HistogramCache cache{FILE_NAME, {2, 2}, std::nullopt};
+    ASSERT_EQ(cache.frames(), 5);
+    EXPECT_EQ(cache.matrix().packed(), full.packed());
+  }
+
+  /* Other bins or fixed limits start over */
+  const cpet::HistogramCache otherBins{FILE_NAME, {4, 1}, std::nullopt};
+  EXPECT_EQ(otherBins.frames(), 0);
+  const cpet::HistogramCache otherLimits{
+      FILE_NAME, {2, 2}, cpet::HistogramLimits{{0.0, 1.0}, {0.0, 3.0}}};
+  EXPECT_EQ(otherLimits.frames(), 0);
+  std::filesystem::remove(FILE_NAME);
+}
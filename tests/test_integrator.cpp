@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Box.h"
+#include "FieldEvaluator.h"
+#include "Integrator.h"
+#include "PointChargeStore.h"
+
+namespace {
+cpet::PointChargeStore dipole() {
+  cpet::PointChargeStore store;
+  store.push_back({-1, 0, 0}, 1.0);
+  store.push_back({1, 0, 0}, -1.0);
+  return store;
+}
+}  // namespace
+
+TEST(Integrator, RadialFieldLineIsStraight) {
+  cpet::PointChargeStore store;
+  store.push_back({0, 0, 0}, 1.0);
+  const cpet::FieldEvaluator field{store};
+  const cpet::Box box{{5, 5, 5}};
+
+  for (const auto type :
+       {cpet::Integrator::Type::euler, cpet::Integrator::Type::rk4,
+        cpet::Integrator::Type::dormandprince}) {
+    const auto trace = cpet::streamline::trace(
+        field, box, {0.5, 0.5, 0}, 1.0, 0.01, cpet::Integrator{type});
+    EXPECT_NEAR(trace.length, 1.0, 1e-12);
+    const Eigen::Vector3d expected =
+        Eigen::Vector3d{0.5, 0.5, 0} * (1.0 + 1.0 / std::sqrt(0.5));
+    EXPECT_NEAR((trace.position - expected).norm(), 0, 1e-9);
+  }
+}
+
+TEST(Integrator, AdaptiveMatchesRK4WithFewerEvaluations) {
+  const auto store = dipole();
+  const cpet::FieldEvaluator field{store};
+  const cpet::Box box{{3, 3, 3}};
+  const Eigen::Vector3d start{-0.8, 0.4, 0.1};
+  constexpr double length = 2.0;
+  constexpr double stepSize = 0.001;
+
+  const auto reference = cpet::streamline::trace(
+      field, box, start, length, stepSize,
+      cpet::Integrator{cpet::Integrator::Type::rk4});
+  const auto euler = cpet::streamline::trace(field, box, start, length,
+                                             stepSize, cpet::Integrator{});
+  const auto adaptive = cpet::streamline::trace(
+      field, box, start, length, stepSize,
+      cpet::Integrator{cpet::Integrator::Type::dormandprince, 1e-8});
+
+  EXPECT_NEAR(adaptive.length, length, 1e-12);
+  EXPECT_NEAR((adaptive.position - reference.position).norm(), 0, 1e-5);
+  EXPECT_LT((adaptive.position - reference.position).norm(),
+            (euler.position - reference.position).norm());
+  EXPECT_LT(10 * adaptive.evaluations, euler.evaluations);
+}
+
+TEST(Integrator, StopsOnLeavingRegion) {
+  const auto store = dipole();
+  const cpet::FieldEvaluator field{store};
+  const cpet::Box box{{0.5, 0.5, 0.5}, {-1, 0, 0}};
+  constexpr double stepSize = 0.001;
+
+  for (const auto type :
+       {cpet::Integrator::Type::euler, cpet::Integrator::Type::rk4,
+        cpet::Integrator::Type::dormandprince}) {
+    const auto trace = cpet::streamline::trace(
+        field, box, {-1.2, 0.1, 0}, 100.0, stepSize, cpet::Integrator{type});
+    EXPECT_FALSE(box.isInside(trace.position));
+    EXPECT_LT(trace.length, 100.0);
+    /* The last step crossed the boundary */
+    const Eigen::Vector3d overshoot =
+        (trace.position - box.center()).cwiseAbs() - box.halfExtents();
+    EXPECT_LE(overshoot.maxCoeff(), stepSize);
+  }
+}
+
+TEST(Integrator, PacketsMatchSingleTraces) {
+  const auto store = dipole();
+  const cpet::FieldEvaluator field{store};
+  const cpet::Box box{{1.5, 1.5, 1.5}};
+  constexpr double stepSize = 0.01;
+
+  /* More lines than lanes, of different lengths, one starting outside */
+  std::vector<cpet::streamline::Start> starts;
+  for (int i = 0; i < 37; i++) {
+    const double offset = 0.05 * i;
+    starts.push_back({{-0.8 + offset, 0.3 - 0.02 * i, 0.1},
+                      0.05 + 0.1 * (i % 7)});
+  }
+  starts.push_back({{2.0, 0.0, 0.0}, 1.0});
+
+  for (const auto type :
+       {cpet::Integrator::Type::euler, cpet::Integrator::Type::rk4,
+        cpet::Integrator::Type::dormandprince}) {
+    const cpet::Integrator integrator{type};
+    std::vector<cpet::streamline::Trace> traces(starts.size());
+    cpet::streamline::tracePackets(field, box, starts.data(), starts.size(),
+                                   stepSize, integrator, traces.data());
+    for (size_t i = 0; i < starts.size(); i++) {
+      const auto expected =
+          cpet::streamline::trace(field, box, starts[i].position,
+                                  starts[i].maxLength, stepSize, integrator);
+      EXPECT_EQ(traces[i].steps, expected.steps) << i;
+      EXPECT_EQ(traces[i].evaluations, expected.evaluations) << i;
+      EXPECT_NEAR(traces[i].length, expected.length, 1e-12) << i;
+      EXPECT_NEAR((traces[i].position - expected.position).norm(), 0, 1e-9)
+          << i;
+    }
+  }
+}
+
+TEST(Integrator, FromOptions) {
+  EXPECT_EQ(cpet::Integrator::fromOptions({"RK4"}).type,
+            cpet::Integrator::Type::rk4);
+  const auto adaptive =
+      cpet::Integrator::fromOptions({"dormandprince", "1e-8"});
+  EXPECT_EQ(adaptive.type, cpet::Integrator::Type::dormandprince);
+  EXPECT_EQ(adaptive.tolerance, 1e-8);
+  EXPECT_THROW((void)cpet::Integrator::fromOptions({"leapfrog"}),
+               cpet::invalid_option);
+  EXPECT_THROW((void)cpet::Integrator::fromOptions({"rk45", "-1"}),
+               cpet::invalid_option);
+}
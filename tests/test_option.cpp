@@ -210,7 +210,7 @@ TEST(Option, Plot3DSimpleValid) {
   const cpet::EFieldVolume& efv = option.calculateEFieldVolumes()[0];
 
   EXPECT_TRUE(efv.showPlot());
-  EXPECT_FALSE(efv.points().empty());
+  EXPECT_NE(efv.grid().size(), 0);
   std::array<int, 3> expectedDensity = {3, 4, 3};
   EXPECT_EQ(efv.sampleDensity(), expectedDensity);
   EXPECT_EQ(efv.volume().type(), "box");
@@ -243,8 +243,8 @@ TEST(Option, Plot3dBlockBoxValid) {
   EXPECT_TRUE(efv0.showPlot());
   EXPECT_FALSE(efv1.showPlot());
 
-  EXPECT_FALSE(efv0.points().empty());
-  EXPECT_FALSE(efv1.points().empty());
+  EXPECT_NE(efv0.grid().size(), 0);
+  EXPECT_NE(efv1.grid().size(), 0);
 
   std::array<int, 3> expectedDensity = {5, 4, 5};
   EXPECT_EQ(efv0.sampleDensity(), expectedDensity);
@@ -514,4 +514,70 @@ TEST(Option, StartStepEmptyValid) {
 
   EXPECT_EQ(option.coordinatesStartIndex(), 0);
   EXPECT_EQ(option.coordinatesStepSize(), 1);
-}
\ No newline at end of file
+}
+TEST(Option, SolverBlocks) {
+  std::string options_file = "Data/valid_options/topology_block_solver";
+  ASSERT_TRUE(std::filesystem::exists(options_file));
+
+  cpet::Option option;
+  ASSERT_NO_THROW(option = cpet::Option{options_file});
+  ASSERT_EQ(option.calculateEFieldTopology().size(), 1);
+  ASSERT_EQ(option.calculateEFieldVolumes().size(), 1);
+
+  const auto& topoSolver = option.calculateEFieldTopology()[0].solver();
+  EXPECT_EQ(topoSolver.type, cpet::FieldSolver::Type::barneshut);
+  EXPECT_EQ(topoSolver.theta, 0.3);
+
+  const auto& volumeSolver = option.calculateEFieldVolumes()[0].solver();
+  EXPECT_EQ(volumeSolver.type, cpet::FieldSolver::Type::barneshut);
+  EXPECT_EQ(volumeSolver.theta, cpet::DEFAULT_OPENING_ANGLE);
+}
+
+TEST(Option, InvalidSolver) {
+  std::string options_file = "Data/invalid_options/topo_block_invalidsolver";
+  ASSERT_TRUE(std::filesystem::exists(options_file));
+
+  cpet::Option option;
+  ASSERT_THROW(option = cpet::Option{options_file}, cpet::invalid_option);
+}
+
+TEST(Option, InterpolationBlock) {
+  std::string options_file = "Data/valid_options/topology_block_interpolate";
+  ASSERT_TRUE(std::filesystem::exists(options_file));
+
+  cpet::Option option;
+  ASSERT_NO_THROW(option = cpet::Option{options_file});
+  ASSERT_EQ(option.calculateEFieldTopology().size(), 1);
+
+  const auto& interpolation =
+      option.calculateEFieldTopology()[0].interpolation();
+  EXPECT_EQ(interpolation.type, cpet::GridInterpolation::Type::tricubic);
+  EXPECT_EQ(interpolation.spacing, 0.05);
+  EXPECT_EQ(option.calculateEFieldTopology()[0].solver().type,
+            cpet::FieldSolver::Type::direct);
+}
+
+TEST(Option, TopologyBlockConverge) {
+  std::string options_file = "Data/valid_options/topology_block_converge";
+  ASSERT_TRUE(std::filesystem::exists(options_file));
+
+  cpet::Option option;
+  ASSERT_NO_THROW(option = cpet::Option{options_file});
+  ASSERT_EQ(option.calculateEFieldTopology().size(), 1);
+
+  const auto& tr = option.calculateEFieldTopology()[0];
+  EXPECT_EQ(tr.numberOfSamples(), 100000);
+  ASSERT_TRUE(tr.convergence());
+  EXPECT_EQ(tr.convergence()->tolerance, 0.00001);
+  EXPECT_EQ(tr.convergence()->minSamples, 500);
+  EXPECT_EQ(tr.convergence()->batchSize, cpet::DEFAULT_CONVERGENCE_BATCH);
+}
+
+TEST(Option, InvalidInterpolation) {
+  std::string options_file =
+      "Data/invalid_options/topo_block_invalidinterpolate";
+  ASSERT_TRUE(std::filesystem::exists(options_file));
+
+  cpet::Option option;
+  ASSERT_THROW(option = cpet::Option{options_file}, cpet::invalid_option);
+}
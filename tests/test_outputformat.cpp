@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Exceptions.h"
+#include "OutputFormat.h"
+
+namespace {
+constexpr std::string_view MAGIC = "CPETTEST";
+
+std::vector<double> roundTrip(const cpet::OutputFormat& format,
+                              const std::vector<double>& values,
+                              size_t* bytes = nullptr) {
+  cpet::util::BinaryWriter writer;
+  format.writeHeader(writer, MAGIC);
+  format.writeReals(writer, values);
+  if (bytes != nullptr) {
+    *bytes = writer.buffer().size();
+  }
+
+  cpet::util::BinaryCursor cursor{writer.buffer(),
+                                  cpet::util::BinaryCursor::Endian::little};
+  const auto read = cpet::OutputFormat::readHeader(cursor, MAGIC);
+  EXPECT_EQ(read.precision, format.precision);
+  EXPECT_EQ(read.compressed, format.compressed);
+  auto result = read.readReals(cursor);
+  EXPECT_TRUE(cursor.atEnd());
+  return result;
+}
+
+/* A smooth field over more than one chunk */
+std::vector<double> smoothValues() {
+  std::vector<double> values(3 * cpet::OUTPUT_CHUNK_BYTES / sizeof(double));
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = std::sin(static_cast<double>(i) * 1e-4);
+  }
+  return values;
+}
+}  // namespace
+
+TEST(OutputFormat, fromOptions) {
+  EXPECT_FALSE(cpet::OutputFormat::fromOptions({"text"}).binary());
+
+  const auto format =
+      cpet::OutputFormat::fromOptions({"Binary", "float64", "compressed"});
+  EXPECT_TRUE(format.binary());
+  EXPECT_EQ(format.precision, cpet::OutputFormat::Precision::float64);
+  EXPECT_TRUE(format.compressed);
+  EXPECT_EQ(format.description(), "binary float64 compressed");
+
+  EXPECT_EQ(cpet::OutputFormat::fromOptions({"binary"}).precision,
+            cpet::OutputFormat::Precision::float32);
+
+  EXPECT_THROW((void)cpet::OutputFormat::fromOptions({}),
+               cpet::invalid_option);
+  EXPECT_THROW((void)cpet::OutputFormat::fromOptions({"hdf5"}),
+               cpet::invalid_option);
+  EXPECT_THROW((void)cpet::OutputFormat::fromOptions({"binary", "float16"}),
+               cpet::invalid_option);
+  EXPECT_THROW((void)cpet::OutputFormat::fromOptions({"text", "float64"}),
+               cpet::invalid_option);
+}
+
+TEST(OutputFormat, RoundTripsReals) {
+  const std::vector<double> values{0.0, -1.5, 1.0 / 3.0, 1e-12, 4.2e7};
+
+  auto format = cpet::OutputFormat::fromOptions({"binary", "float64"});
+  EXPECT_EQ(roundTrip(format, values), values);
+  EXPECT_TRUE(roundTrip(format, {}).empty());
+
+  format.precision = cpet::OutputFormat::Precision::float32;
+  const auto single = roundTrip(format, values);
+  ASSERT_EQ(single.size(), values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(single[i], static_cast<double>(static_cast<float>(values[i])));
+  }
+}
+
+TEST(OutputFormat, CompressesChunks) {
+  const auto values = smoothValues();
+
+  size_t plainBytes{0};
+  size_t compressedBytes{0};
+  const auto plain = cpet::OutputFormat::fromOptions({"binary", "float64"});
+  const auto compressed =
+      cpet::OutputFormat::fromOptions({"binary", "float64", "compressed"});
+  EXPECT_EQ(roundTrip(plain, values, &plainBytes), values);
+  EXPECT_EQ(roundTrip(compressed, values, &compressedBytes), values);
+  EXPECT_LT(compressedBytes, plainBytes);
+}
+
+TEST(OutputFormat, InvalidInput) {
+  const auto format =
+      cpet::OutputFormat::fromOptions({"binary", "float32", "compressed"});
+  cpet::util::BinaryWriter writer;
+  format.writeHeader(writer, MAGIC);
+  format.writeReals(writer, smoothValues());
+  const std::string_view data = writer.buffer();
+
+  EXPECT_TRUE(cpet::OutputFormat::isBinary(data, MAGIC));
+  EXPECT_FALSE(cpet::OutputFormat::isBinary("#Samples: 10", MAGIC));
+
+  cpet::util::BinaryCursor wrongMagic{data,
+                                      cpet::util::BinaryCursor::Endian::little};
+  EXPECT_THROW((void)cpet::OutputFormat::readHeader(wrongMagic, "CPETVOL1"),
+               cpet::io_error);
+
+  cpet::util::BinaryCursor truncated{data.substr(0, data.size() / 2),
+                                     cpet::util::BinaryCursor::Endian::little};
+  const auto read = cpet::OutputFormat::readHeader(truncated, MAGIC);
+  EXPECT_THROW((void)read.readReals(truncated), cpet::io_error);
+}
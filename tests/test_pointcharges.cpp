@@ -2,12 +2,15 @@
 
 #include <Eigen/Core>
 #include <exception>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "AtomID.h"
+#include "AtomTable.h"
+#include "ChargeGroups.h"
+#include "Topology.h"
 #include "Exceptions.h"
-#include "PointCharge.h"
 #include "Frame.h"
 
 TEST(AtomID, GenerateFromPDB) {
@@ -200,26 +203,83 @@ TEST(AtomID, AssignVectorToConstant) {
   EXPECT_EQ(a.position(), Eigen::Vector3d({105.3, -303.00, 299}));
 }
 
-TEST(PointCharge, find) {
-  cpet::PointCharge pc1{Eigen::Vector3d{3.0, 2.0, 2.5}, 1.0,
-                        cpet::AtomID{"A:4:CD"}};
-  cpet::PointCharge pc2{Eigen::Vector3d{3.5, 1.0, 3.5}, 1.0,
-                        cpet::AtomID{"C:35:SG\'"}};
-  cpet::PointCharge pc3{Eigen::Vector3d{-1.0, 0.92, 6.5}, 1.0,
-                        cpet::AtomID{"A:45:C100"}};
-  cpet::PointCharge pc4{Eigen::Vector3d{4.23, 8.0, -2.5}, 1.0,
-                        cpet::AtomID{"B:200:HB"}};
+TEST(Frame, find) {
+  const std::vector<Eigen::Vector3d> coordinates{{3.0, 2.0, 2.5},
+                                                 {3.5, 1.0, 3.5},
+                                                 {-1.0, 0.92, 6.5},
+                                                 {4.23, 8.0, -2.5},
+                                                 {0.0, 0.0, 0.0}};
+  cpet::AtomTable atoms;
+  for (const auto* id :
+       {"A:4:CD", "C:35:SG\'", "A:45:C100", "B:200:HB", "A:4:CD"}) {
+    atoms.push_back(cpet::AtomID{id});
+  }
+  const auto topology = std::make_shared<const cpet::Topology>(
+      atoms, std::vector<double>{1.0, 0.0, -1.0, 0.5, 2.0});
+  EXPECT_EQ(topology->chargedAtoms(),
+            (std::vector<cpet::Topology::index_type>{0, 2, 3, 4}));
 
-  cpet::Frame system({pc1, pc2, pc3, pc4});
+  cpet::Frame system(coordinates, topology);
 
-  EXPECT_EQ(*system.find(cpet::AtomID{"C:35:SG\'"}), pc2);
-  EXPECT_EQ(*system.find(cpet::AtomID{"A:4:CD"}), pc1);
-  EXPECT_EQ(*system.find(cpet::AtomID{"B:200:HB"}), pc4);
+  EXPECT_EQ(system.find(cpet::AtomID{"C:35:SG\'"}), coordinates[1]);
+  /* Repeated IDs resolve to the first atom */
+  EXPECT_EQ(system.find(cpet::AtomID{"A:4:CD"}), coordinates[0]);
+  EXPECT_EQ(system.find(cpet::AtomID{"B:200:HB"}), coordinates[3]);
 
   EXPECT_THROW((void)system.find(cpet::AtomID("C:35:SG")),
                cpet::value_not_found);
   EXPECT_THROW((void)system.find(cpet::AtomID("D:54:C102")),
                cpet::value_not_found);
+
+  EXPECT_THROW(cpet::Frame({coordinates[0]}, topology), cpet::value_error);
+  EXPECT_THROW((void)topology->withCharges({1.0}), cpet::value_error);
+}
+
+TEST(Topology, ChargeSets) {
+  cpet::AtomTable atoms;
+  for (const auto* id : {"A:1:N", "A:1:CA", "A:1:C"}) {
+    atoms.push_back(cpet::AtomID{id});
+  }
+  const cpet::Topology topology{atoms, std::vector<double>{1.0, 0.0, 0.0}};
+  EXPECT_EQ(topology.chargeSets().size(), 1);
+  EXPECT_EQ(topology.chargedAtomsOfAnySet(), topology.chargedAtoms());
+
+  const auto sets =
+      topology.withChargeSets({{1.0, 0.0, 0.0}, {0.5, 0.0, -1.0}});
+  EXPECT_EQ(sets.chargeSets().size(), 2);
+  EXPECT_EQ(sets.charges(), (std::vector<double>{1.0, 0.0, 0.0}));
+  EXPECT_EQ(sets.chargedAtoms(), (std::vector<cpet::Topology::index_type>{0}));
+  EXPECT_EQ(sets.chargedAtomsOfAnySet(),
+            (std::vector<cpet::Topology::index_type>{0, 2}));
+
+  EXPECT_THROW((void)topology.withChargeSets({}), cpet::value_error);
+  EXPECT_THROW((void)topology.withChargeSets({{1.0, 0.0, 0.0}, {1.0}}),
+               cpet::value_error);
+}
+
+TEST(ChargeGroups, GroupsByResidueAndChain) {
+  cpet::AtomTable atoms;
+  for (const auto* id : {"A:1:N", "B:7:O", "A:2:CA", "A:1:CA", "B:7:H"}) {
+    atoms.push_back(cpet::AtomID{id});
+  }
+  const cpet::Topology topology{
+      atoms, std::vector<double>{0.5, -1.0, 0.0, 0.25, 0.3}};
+
+  const cpet::ChargeGroups residues{topology,
+                                    cpet::ChargeGroups::Key::residue};
+  /* The uncharged A:2 contributes nothing and gets no group */
+  EXPECT_EQ(residues.names(), (std::vector<std::string>{"A:1", "B:7"}));
+  EXPECT_EQ(residues.atoms(),
+            (std::vector<cpet::ChargeGroups::index_type>{0, 3, 1, 4}));
+  EXPECT_EQ(residues.offsets(), (std::vector<size_t>{0, 2, 4}));
+
+  const cpet::ChargeGroups chains{topology,
+                                  cpet::ChargeGroups::keyFromString("Chain")};
+  EXPECT_EQ(chains.names(), (std::vector<std::string>{"A", "B"}));
+  EXPECT_EQ(chains.offsets(), (std::vector<size_t>{0, 2, 4}));
+
+  EXPECT_THROW((void)cpet::ChargeGroups::keyFromString("atom"),
+               cpet::invalid_option);
 }
 
 // test pointcharges (some of the basic functionalities...)
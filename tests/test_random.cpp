@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "Random.h"
+
+TEST(Philox4x32, KnownAnswers) {
+  using cpet::util::Philox4x32;
+  EXPECT_EQ(Philox4x32::generate({0, 0, 0, 0}, {0, 0}),
+            (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                 0x9b00dbd8}));
+  EXPECT_EQ(Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff,
+                                  0xffffffff},
+                                 {0xffffffff, 0xffffffff}),
+            (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                 0x6d5451fd}));
+  EXPECT_EQ(Philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                  0x03707344},
+                                 {0xa4093822, 0x299f31d0}),
+            (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420,
+                                 0x24126ea1}));
+}
+
+TEST(SampleRandom, DependsOnlyOnItsKey) {
+  cpet::util::SampleRandom a{7, 2, 11};
+  cpet::util::SampleRandom b{7, 2, 11};
+  cpet::util::SampleRandom otherSample{7, 2, 12};
+  cpet::util::SampleRandom otherFrame{7, 3, 11};
+  for (int i = 0; i < 10; i++) {
+    const double value = a.uniform(-1.0, 1.0);
+    EXPECT_EQ(value, b.uniform(-1.0, 1.0));
+    EXPECT_GE(value, -1.0);
+    EXPECT_LT(value, 1.0);
+    EXPECT_NE(value, otherSample.uniform(-1.0, 1.0));
+    EXPECT_NE(value, otherFrame.uniform(-1.0, 1.0));
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    const int value = a.uniformInt(1, 6);
+    EXPECT_GE(value, 1);
+    EXPECT_LE(value, 6);
+  }
+  EXPECT_EQ(a.uniformInt(3, 3), 3);
+}
@@ -1,14 +1,37 @@
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <vector>
 
 #include <Eigen/Dense>
 
+#include "AtomTable.h"
+#include "Topology.h"
 #include "Option.h"
 #include "System.h"
 #include "PointCharge.h"
 #include "FieldLocations.h"
 #include "Frame.h"
+#include "Box.h"
+#include "FrameView.h"
+#include "FramePlan.h"
+
+namespace {
+/* Frame whose atoms are all named A:<i + 1>:NH */
+cpet::Frame makeFrame(const std::vector<cpet::PointCharge>& pc) {
+  cpet::AtomTable atoms;
+  std::vector<Eigen::Vector3d> coordinates;
+  std::vector<double> charges;
+  for (size_t i = 0; i < pc.size(); i++) {
+    atoms.push_back(cpet::AtomID{"A:" + std::to_string(i + 1) + ":NH"});
+    coordinates.push_back(pc[i].coordinate);
+    charges.push_back(pc[i].charge);
+  }
+  return cpet::Frame{std::move(coordinates),
+                     std::make_shared<const cpet::Topology>(
+                         std::move(atoms), std::move(charges))};
+}
+}  // namespace
 
 TEST(System, SimpleField) {
   cpet::Option option;
@@ -16,10 +39,10 @@ TEST(System, SimpleField) {
   option.addFieldLocations(cpet::FieldLocations::fromSimple({"1:1:1"}));
 
   std::vector<cpet::PointCharge> pc;
-  pc.emplace_back(Eigen::Vector3d{0, 0, 0}, 1, cpet::AtomID{"A:1:NH"});
-  cpet::Frame frame{pc};
+  pc.emplace_back(Eigen::Vector3d{0, 0, 0}, 1);
+  const auto frame = makeFrame(pc);
   {
-    cpet::System sys{frame, option};
+    const auto sys = cpet::systemFor(frame, option);
     EXPECT_FLOAT_EQ(sys.center().norm(), 0.0);
 
     Eigen::Matrix3d identity = Eigen::Matrix3d::Identity();
@@ -37,7 +60,7 @@ TEST(System, SimpleField) {
   option.centerID("1:1:1");
 
   {
-    cpet::System sys{frame, option};
+    auto sys = cpet::systemFor(frame, option);
     sys.transformToUserSpace();
     Eigen::Vector3d expected_center{1, 1, 1};
     EXPECT_NEAR((sys.center() - expected_center).norm(), 0, 0.00001);
@@ -53,3 +76,149 @@ TEST(System, SimpleField) {
     EXPECT_NEAR((field - expected_result).norm(), 0, 0.00001);
   }
 }
+
+TEST(FramePlan, PreparesSystemsInUserSpace) {
+  cpet::Option option;
+  option.centerID("1:1:1");
+  std::vector<cpet::PointCharge> pc;
+  pc.emplace_back(Eigen::Vector3d{0, 0, 0}, 1);
+  pc.emplace_back(Eigen::Vector3d{2, -1, 0.5}, -0.5);
+  const auto frame = makeFrame(pc);
+
+  auto expected = cpet::systemFor(frame, option);
+  expected.transformToUserSpace();
+  cpet::util::ThreadPool pool{2};
+  const cpet::FramePlan plan{option, cpet::Device{}};
+  const auto systems = plan.prepare({frame, frame, frame}, pool);
+  ASSERT_EQ(systems.size(), 3);
+  const Eigen::Vector3d position{0.3, -0.2, 1.1};
+  for (const auto& system : systems) {
+    EXPECT_EQ(system.center(), expected.center());
+    EXPECT_EQ(system.electricFieldAt(position),
+              expected.electricFieldAt(position));
+  }
+}
+
+TEST(System, FieldGridCoversPaddedVolume) {
+  std::vector<cpet::PointCharge> pc;
+  pc.emplace_back(Eigen::Vector3d{4, 0, 0}, 1);
+  pc.emplace_back(Eigen::Vector3d{0, -4, 1}, -1);
+  const cpet::System sys{makeFrame(pc)};
+
+  const cpet::Box box{{1, 1, 1}};
+  constexpr double padding = 0.1;
+  const cpet::GridInterpolation interpolation{
+      cpet::GridInterpolation::Type::tricubic, 0.05};
+  cpet::util::ThreadPool pool{2};
+  const auto grid =
+      sys.fieldGrid(cpet::FieldSolver{}, box, interpolation, padding, pool);
+
+  EXPECT_LT(grid.errorEstimate(), 1e-4);
+  for (const Eigen::Vector3d& p :
+       {Eigen::Vector3d{0.3, -0.2, 0.9}, Eigen::Vector3d{1.05, 1.05, -1.05}}) {
+    const Eigen::Vector3d expected = sys.electricFieldAt(p);
+    EXPECT_NEAR((grid.electricFieldAt(p) - expected).norm() / expected.norm(),
+                0, 1e-4);
+  }
+}
+
+TEST(System, PooledFieldsMatchSerial) {
+  std::vector<cpet::PointCharge> pc;
+  for (int i = 0; i < 50; i++) {
+    pc.emplace_back(Eigen::Vector3d{5.0 + i % 7, -3.0 + i % 5, 4.0 - i % 3},
+                    (i % 2 == 0) ? 0.4 : -0.3);
+  }
+  const cpet::System sys{makeFrame(pc)};
+
+  const cpet::Box box{{1, 1, 1}};
+  const auto points = box.partition({10, 10, 10});
+  cpet::util::ThreadPool pool{4};
+
+  cpet::FieldSolver multipole;
+  multipole.type = cpet::FieldSolver::Type::multipole;
+  for (const auto& solver : {cpet::FieldSolver{}, multipole}) {
+    const auto fields = sys.electricFieldAt(points, solver, box, pool);
+    const auto field = sys.fieldEvaluator(solver, box);
+    ASSERT_EQ(fields.size(), points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      const Eigen::Vector3d expected = field(points[i]);
+      EXPECT_NEAR((fields[i] - expected).norm() / expected.norm(), 0, 1e-12);
+    }
+  }
+}
+
+TEST(System, TopologySamplesAreReproducible) {
+  std::vector<cpet::PointCharge> pc;
+  pc.emplace_back(Eigen::Vector3d{4, 0, 0}, 1);
+  pc.emplace_back(Eigen::Vector3d{0, -4, 1}, -1);
+  const cpet::System sys{makeFrame(pc)};
+  const cpet::Box box{{1, 1, 1}};
+  constexpr double STEP_SIZE = 0.01;
+  const cpet::util::SampleStream stream{42, 3, 0};
+
+  cpet::util::ThreadPool serial{1};
+  cpet::util::ThreadPool pool{3};
+  const auto expected = sys.electricFieldTopologyIn(
+      serial, box, STEP_SIZE, 20, {}, {}, {}, stream);
+  const auto samples = sys.electricFieldTopologyIn(pool, box, STEP_SIZE, 20,
+                                                   {}, {}, {}, stream, 7);
+  ASSERT_EQ(samples.size(), expected.size());
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(samples[i].distance, expected[i].distance);
+    EXPECT_EQ(samples[i].curvature, expected[i].curvature);
+  }
+
+  /* A resumed run draws the samples the killed one had not reached */
+  const auto resumed = sys.electricFieldTopologyIn(
+      pool, box, STEP_SIZE, 5, {}, {}, {}, cpet::util::SampleStream{42, 3, 15});
+  ASSERT_EQ(resumed.size(), 5);
+  EXPECT_EQ(resumed[0].distance, expected[15].distance);
+  EXPECT_EQ(resumed[4].curvature, expected[19].curvature);
+
+  const auto otherSeed =
+      sys.electricFieldTopologyIn(serial, box, STEP_SIZE, 20, {}, {}, {},
+                                  cpet::util::SampleStream{43, 3, 0});
+  EXPECT_NE(otherSeed[0].distance, expected[0].distance);
+}
+
+TEST(FrameView, MatchesSystem) {
+  std::vector<cpet::PointCharge> pc;
+  pc.emplace_back(Eigen::Vector3d{4, 0, 0}, 1);
+  pc.emplace_back(Eigen::Vector3d{2, 2, 2}, 0);
+  pc.emplace_back(Eigen::Vector3d{0, -4, 1}, -1);
+  const cpet::System sys{makeFrame(pc)};
+
+  /* x y z and a padding value per atom, charges interleaved with radii */
+  std::vector<double> coordinates;
+  std::vector<double> charges;
+  for (const auto& charge : pc) {
+    coordinates.insert(coordinates.end(),
+                       {charge.coordinate[0], charge.coordinate[1],
+                        charge.coordinate[2], -1.0});
+    charges.insert(charges.end(), {charge.charge, 1.5});
+  }
+  const cpet::FrameView view{{coordinates.data(), pc.size(), 4},
+                             {charges.data(), 2}};
+  EXPECT_EQ(view.size(), 2);
+
+  const cpet::Box box{{1, 1, 1}};
+  const auto points = box.partition({4, 4, 4});
+  cpet::util::ThreadPool pool{3};
+  std::vector<Eigen::Vector3d> fields(points.size());
+  view.electricFieldAt(points.data(), points.size(), fields.data(), pool);
+  for (size_t i = 0; i < points.size(); i++) {
+    EXPECT_EQ(fields[i], sys.electricFieldAt(points[i]));
+  }
+
+  constexpr double STEP_SIZE = 0.01;
+  const cpet::util::SampleStream stream{42, 3, 0};
+  const auto expected = sys.electricFieldTopologyIn(
+      pool, box, STEP_SIZE, 20, {}, {}, {}, stream);
+  std::vector<cpet::PathSample> samples(expected.size());
+  view.electricFieldTopologyIn(box, STEP_SIZE, samples.size(), samples.data(),
+                               pool, {}, stream);
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(samples[i].distance, expected[i].distance);
+    EXPECT_EQ(samples[i].curvature, expected[i].curvature);
+  }
+}
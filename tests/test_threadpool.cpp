@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AsyncWriter.h"
+#include "Exceptions.h"
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+
+TEST(ThreadPool, CoversRangeOnce) {
+  for (const int threads : {1, 2, 4}) {
+    cpet::util::ThreadPool pool{threads};
+    EXPECT_EQ(pool.size(), static_cast<size_t>(threads));
+
+    constexpr size_t count = 10007;
+    std::vector<int> hits(count, 0);
+    std::vector<std::vector<size_t>> perThread(pool.size());
+    pool.parallelFor(count, 64,
+                     [&](size_t begin, size_t end, size_t thread) {
+                       ASSERT_LT(thread, pool.size());
+                       for (size_t i = begin; i < end; i++) {
+                         ++hits[i];
+                         perThread[thread].push_back(i);
+                       }
+                     });
+
+    EXPECT_TRUE(std::all_of(hits.begin(), hits.end(),
+                            [](int h) { return h == 1; }));
+    const size_t merged = std::accumulate(
+        perThread.begin(), perThread.end(), size_t{0},
+        [](size_t sum, const auto& v) { return sum + v.size(); });
+    EXPECT_EQ(merged, count);
+  }
+}
+
+TEST(ThreadPool, Nested) {
+  cpet::util::ThreadPool pool{3};
+  std::vector<std::vector<int>> grid(16, std::vector<int>(50, 0));
+  pool.parallelFor(grid.size(), 1, [&](size_t begin, size_t end, size_t) {
+    for (size_t row = begin; row < end; row++) {
+      pool.parallelFor(grid[row].size(), 7,
+                       [&](size_t b, size_t e, size_t) {
+                         for (size_t col = b; col < e; col++) {
+                           grid[row][col] += 1;
+                         }
+                       });
+    }
+  });
+  for (const auto& row : grid) {
+    EXPECT_EQ(std::accumulate(row.begin(), row.end(), 0),
+              static_cast<int>(row.size()));
+  }
+}
+
+TEST(ThreadPool, PropagatesExceptions) {
+  cpet::util::ThreadPool pool{4};
+  EXPECT_THROW(pool.parallelFor(100, 1,
+                                [](size_t begin, size_t, size_t) {
+                                  if (begin == 42) {
+                                    throw std::runtime_error("chunk failed");
+                                  }
+                                }),
+               std::runtime_error);
+
+  /* Still usable afterwards */
+  int total = 0;
+  pool.parallelFor(10, 10, [&](size_t begin, size_t end, size_t) {
+    total += static_cast<int>(end - begin);
+  });
+  EXPECT_EQ(total, 10);
+}
+
+TEST(ThreadPool, InvalidSize) {
+  EXPECT_THROW(cpet::util::ThreadPool{0}, cpet::value_error);
+}
+
+TEST(AsyncWriter, RunsJobsInOrder) {
+  std::vector<int> written;
+  {
+    cpet::util::AsyncWriter writer{2};
+    for (int i = 0; i < 100; i++) {
+      writer.submit([&written, i]() { written.push_back(i); });
+    }
+    writer.wait();
+    EXPECT_EQ(written.size(), 100);
+
+    /* Jobs still queued when the writer goes away are finished */
+    writer.submit([&written]() { written.push_back(100); });
+  }
+  std::vector<int> expected(101);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(written, expected);
+}
+
+TEST(AsyncWriter, PropagatesExceptions) {
+  cpet::util::AsyncWriter writer;
+  writer.submit([]() { throw cpet::io_error("Could not open file"); });
+  EXPECT_THROW(writer.wait(), cpet::io_error);
+
+  /* Nothing runs after a failed job */
+  bool ran = false;
+  EXPECT_THROW(writer.submit([&ran]() { ran = true; }), cpet::io_error);
+  EXPECT_THROW(writer.wait(), cpet::io_error);
+  EXPECT_FALSE(ran);
+}
+
+TEST(Profiler, SumsStagesAndCounters) {
+  auto& profiler = cpet::util::Profiler::instance();
+  profiler.reset();
+  using Counter = cpet::util::Profiler::Counter;
+
+  /* Nothing is recorded until the profiler is enabled */
+  if (!profiler.enabled()) {
+    { const cpet::util::ProfileStage stage{"ignored"}; }
+    profiler.add(Counter::samples, 5);
+    EXPECT_TRUE(profiler.stages().empty());
+    EXPECT_EQ(profiler.count(Counter::samples), 0);
+    profiler.enable();
+  }
+
+  cpet::util::ThreadPool pool{4};
+  pool.parallelFor(100, 1, [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; i++) {
+      const cpet::util::ProfileStage stage{"work"};
+      profiler.add(Counter::samples);
+      profiler.add(Counter::integrationSteps, 3);
+    }
+  });
+  EXPECT_EQ(profiler.stages().at("work").calls, 100);
+  EXPECT_EQ(profiler.count(Counter::samples), 100);
+  EXPECT_EQ(profiler.count(Counter::integrationSteps), 300);
+
+  const std::string file = "profile_test.json";
+  profiler.writeReport(file);
+  std::ifstream in(file);
+  const std::string report{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_NE(report.find("\"work\": {\"seconds\": "), std::string::npos);
+  EXPECT_NE(report.find("\"samples\": 100"), std::string::npos);
+  EXPECT_NE(report.find("\"steps_per_sample\": 3"), std::string::npos);
+  std::remove(file.c_str());
+  profiler.reset();
+}
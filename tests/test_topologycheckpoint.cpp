@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Exceptions.h"
+#include "TopologyCheckpoint.h"
+
+namespace {
+constexpr const char* FILE_NAME = "topology_checkpoint_test.chk";
+constexpr const char* KEY = "Samples: 4; Volume: Box: 1 1 1";
+
+bool operator==(const cpet::PathSample& a, const cpet::PathSample& b) {
+  return a.distance == b.distance && a.curvature == b.curvature;
+}
+}  // namespace
+
+TEST(TopologyCheckpoint, ResumesRecordedSamples) {
+  std::filesystem::remove(FILE_NAME);
+  const std::vector<cpet::PathSample> first{{0.1, 0.2}, {0.3, 0.4}};
+  const std::vector<cpet::PathSample> second{{0.5, 0.6}};
+  {
+    cpet::TopologyCheckpoint checkpoint{FILE_NAME, KEY};
+    EXPECT_EQ(checkpoint.loadedFrames(), 0);
+    checkpoint.record(0, first);
+    checkpoint.record(7, second);
+    checkpoint.record(0, second);
+  }
+
+  /* A record cut short by a kill is dropped */
+  const auto size = std::filesystem::file_size(FILE_NAME);
+  {
+    std::ofstream out(FILE_NAME, std::ios::app | std::ios::binary);
+    out << '\x07';
+  }
+
+  {
+    cpet::TopologyCheckpoint checkpoint{FILE_NAME, KEY};
+    EXPECT_EQ(std::filesystem::file_size(FILE_NAME), size);
+    EXPECT_EQ(checkpoint.loadedFrames(), 2);
+    const auto frame0 = checkpoint.take(0);
+    ASSERT_EQ(frame0.size(), 3);
+    EXPECT_TRUE(frame0[1] == first[1]);
+    EXPECT_TRUE(frame0[2] == second[0]);
+    EXPECT_TRUE(checkpoint.take(0).empty());
+    EXPECT_TRUE(checkpoint.take(3).empty());
+
+    /* Appends after reopening are kept too */
+    checkpoint.record(3, first);
+  }
+  {
+    cpet::TopologyCheckpoint checkpoint{FILE_NAME, KEY};
+    EXPECT_EQ(checkpoint.loadedFrames(), 3);
+    EXPECT_EQ(checkpoint.take(3).size(), 2);
+    EXPECT_EQ(checkpoint.take(7).size(), 1);
+  }
+
+  /* Samples drawn with other options are not mixed in */
+  EXPECT_THROW(cpet::TopologyCheckpoint(FILE_NAME, "Samples: 5"),
+               cpet::value_error);
+  std::filesystem::remove(FILE_NAME);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Exceptions.h"
+#include "TrajectoryReader.h"
+
+namespace {
+/* The models of the test trajectories are shifted by their index along x */
+double modelOf(const cpet::Frame& frame) {
+  return (*frame.begin())[0];
+}
+}  // namespace
+
+TEST(TrajectoryReader, ReadsEveryModel) {
+  for (const std::string file : {"Data/trajectories/three_models.pdb",
+                                 "Data/trajectories/three_models.pqr"}) {
+    auto reader = cpet::TrajectoryReader::open(file, 0, 1);
+    std::vector<double> models;
+    const cpet::Topology* topology = nullptr;
+    while (auto frame = reader->next()) {
+      ASSERT_EQ(frame->size(), 3);
+      /* Every frame shares the topology read with the first */
+      if (topology == nullptr) {
+        topology = &frame->topology();
+      }
+      EXPECT_EQ(&frame->topology(), topology);
+      EXPECT_EQ(topology->atoms()[1], cpet::AtomID{"A:1:CA"});
+      EXPECT_NEAR(topology->charges()[0], -0.4, 1e-12);
+      EXPECT_NEAR(frame->find(cpet::AtomID{"A:1:C"})[1], 2.0, 1e-12);
+      models.push_back(modelOf(*frame));
+    }
+    /* The last model is not terminated by ENDMDL */
+    EXPECT_EQ(models, (std::vector<double>{0.0, 1.0, 2.0}));
+    EXPECT_FALSE(reader->next());
+  }
+}
+
+TEST(TrajectoryReader, SelectsStartAndStep) {
+  auto reader =
+      cpet::TrajectoryReader::open("Data/trajectories/three_models.pdb", 1, 1);
+  auto frames = reader->next(5);
+  ASSERT_EQ(frames.size(), 2);
+  EXPECT_EQ(modelOf(frames[0]), 1.0);
+  EXPECT_EQ(modelOf(frames[1]), 2.0);
+
+  reader =
+      cpet::TrajectoryReader::open("Data/trajectories/three_models.pdb", 0, 2);
+  frames = reader->next(1);
+  ASSERT_EQ(frames.size(), 1);
+  EXPECT_EQ(modelOf(frames[0]), 0.0);
+  frames = reader->next(1);
+  ASSERT_EQ(frames.size(), 1);
+  EXPECT_EQ(modelOf(frames[0]), 2.0);
+  EXPECT_TRUE(reader->next(1).empty());
+}
+
+TEST(TrajectoryReader, ReplacesCharges) {
+  auto reader =
+      cpet::TrajectoryReader::open("Data/trajectories/three_models.pqr", 0, 1);
+  reader->replaceCharges({1.0, 0.0, 2.0});
+  const auto frames = reader->next(3);
+  ASSERT_EQ(frames.size(), 3);
+  for (const auto& frame : frames) {
+    EXPECT_EQ(frame.topology().charges(), (std::vector<double>{1.0, 0.0, 2.0}));
+    EXPECT_EQ(frame.topology().chargedAtoms().size(), 2);
+  }
+
+  reader =
+      cpet::TrajectoryReader::open("Data/trajectories/three_models.pqr", 0, 1);
+  reader->replaceCharges({1.0});
+  EXPECT_THROW((void)reader->next(), cpet::value_error);
+}
+
+namespace {
+std::shared_ptr<const cpet::Topology> topologyOf(const std::string& file) {
+  auto reader = cpet::TrajectoryReader::open(file, 0, 1);
+  EXPECT_TRUE(reader->next());
+  return reader->topology();
+}
+
+/* Coordinates written to twelve_atoms.xtc, in 0.001 nm, for frame 0. Later
+ * frames are shifted by 0.1 nm along x. */
+const std::vector<std::array<double, 3>> XTC_ATOMS{
+    {1000, 2000, 1500}, {1003, 2005, 1498}, {995, 2001, 1502},
+    {1200, 1800, 1600}, {1195, 1805, 1607}, {1201, 1799, 1595},
+    {1198, 1801, 1600}, {1204, 1796, 1606}, {1195, 1805, 1603},
+    {2500, 900, 40},    {2492, 907, 45},    {3000, 3000, 3000}};
+}  // namespace
+
+TEST(TrajectoryReader, ReadsDCD) {
+  const auto topology = topologyOf("Data/trajectories/three_models.pqr");
+  auto reader = cpet::TrajectoryReader::open(
+      "Data/trajectories/three_atoms.dcd", 1, 2, topology);
+  const auto frames = reader->next(4);
+  ASSERT_EQ(frames.size(), 2);
+  for (size_t i = 0; i < frames.size(); i++) {
+    EXPECT_EQ(&frames[i].topology(), topology.get());
+    for (size_t atom = 0; atom < 3; atom++) {
+      const Eigen::Vector3d expected{1.0 + 2.0 * static_cast<double>(i),
+                                     static_cast<double>(atom), -1.5};
+      EXPECT_NEAR((frames[i][atom] - expected).norm(), 0, 1e-6);
+    }
+  }
+}
+
+TEST(TrajectoryReader, ReadsXTC) {
+  const auto topology = topologyOf("Data/trajectories/twelve_atoms.pqr");
+  for (const int start : {0, 2}) {
+    auto reader = cpet::TrajectoryReader::open(
+        "Data/trajectories/twelve_atoms.xtc", start, 1, topology);
+    int frame = start;
+    while (const auto next = reader->next()) {
+      ASSERT_EQ(next->size(), XTC_ATOMS.size());
+      for (size_t atom = 0; atom < XTC_ATOMS.size(); atom++) {
+        /* 0.001 nm is 0.01 Angstrom */
+        const Eigen::Vector3d expected =
+            0.01 * Eigen::Vector3d{XTC_ATOMS[atom][0] + 100.0 * frame,
+                                   XTC_ATOMS[atom][1], XTC_ATOMS[atom][2]};
+        EXPECT_NEAR(((*next)[atom] - expected).norm(), 0, 1e-4)
+            << "frame " << frame << " atom " << atom;
+      }
+      frame++;
+    }
+    EXPECT_EQ(frame, 3);
+  }
+
+  /* Few atoms are stored uncompressed */
+  auto reader = cpet::TrajectoryReader::open(
+      "Data/trajectories/three_atoms.xtc", 0, 2,
+      topologyOf("Data/trajectories/three_models.pqr"));
+  const auto frames = reader->next(3);
+  ASSERT_EQ(frames.size(), 2);
+  EXPECT_NEAR((frames[1][2] - Eigen::Vector3d{20, 20, -1.5}).norm(), 0, 1e-5);
+}
+
+TEST(TrajectoryReader, InvalidInput) {
+  EXPECT_THROW(
+      (void)cpet::TrajectoryReader::open("Data/trajectories/missing.pdb", 0, 1),
+      cpet::io_error);
+  EXPECT_THROW((void)cpet::TrajectoryReader::open(
+                   "Data/trajectories/three_models.pdb", 0, 0),
+               cpet::value_error);
+  /* Binary trajectories need a topology with as many atoms */
+  EXPECT_THROW((void)cpet::TrajectoryReader::open(
+                   "Data/trajectories/three_atoms.dcd", 0, 1),
+               cpet::value_error);
+  EXPECT_THROW(
+      (void)cpet::TrajectoryReader::open(
+          "Data/trajectories/three_atoms.dcd", 0, 1,
+          topologyOf("Data/trajectories/twelve_atoms.pqr")),
+      cpet::value_error);
+}
@@ -251,4 +251,37 @@ TEST(endswith, normal) {
   EXPECT_FALSE(cpet::util::endswith("hello", "hhello"));
   EXPECT_TRUE(cpet::util::endswith("something", ""));
   EXPECT_FALSE(cpet::util::endswith("", "something"));
-}
\ No newline at end of file
+}
+TEST(parseDouble, NumericInput) {
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble("4"), 4.0);
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble("  -23.5 "), -23.5);
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble("-.02"), -0.02);
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble("1e-3\t"), 1e-3);
+}
+
+TEST(parseDouble, LeadingPlus) {
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble("+0.500"), 0.5);
+  EXPECT_DOUBLE_EQ(cpet::util::parseDouble(" +2e+1 "), 20.0);
+  EXPECT_FALSE(cpet::util::toDouble("+"));
+  EXPECT_FALSE(cpet::util::toDouble("++1"));
+  EXPECT_FALSE(cpet::util::toDouble("+-1"));
+  EXPECT_FALSE(cpet::util::toDouble("+ 1"));
+}
+
+TEST(parseDouble, NoNumericInput) {
+  EXPECT_FALSE(cpet::util::toDouble(""));
+  EXPECT_FALSE(cpet::util::toDouble("   "));
+  EXPECT_FALSE(cpet::util::toDouble("4.0a"));
+  EXPECT_FALSE(cpet::util::toDouble("4 5"));
+  EXPECT_THROW((void)cpet::util::parseDouble("hello"), cpet::value_error);
+}
+
+TEST(nextToken, WhitespaceTokens) {
+  std::string_view rest = "  ATOM\t 1  N ";
+  EXPECT_EQ(cpet::util::nextToken(rest), "ATOM");
+  EXPECT_EQ(cpet::util::nextToken(rest), "1");
+  EXPECT_EQ(cpet::util::nextToken(rest), "N");
+  EXPECT_EQ(cpet::util::nextToken(rest), "");
+  EXPECT_TRUE(rest.empty());
+  EXPECT_EQ(cpet::util::trim(" \t a b \t"), "a b");
+}
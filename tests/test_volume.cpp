@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <array>
+#include <type_traits>
 #include <vector>
 
 #include "Box.h"
 #include "Exceptions.h"
+#include "VolumeVisit.h"
 
 TEST(Box, BasicProperties) {
   cpet::Box b({1.3, 2.4, 2});
@@ -30,14 +33,15 @@ TEST(Box, BasicProperties) {
   EXPECT_FALSE(b.isInside(point))
       << "Point " << point.transpose() << " within " << b.description();
 
+  cpet::util::SampleRandom random{1, 0, 0};
   for (int i = 0; i < 100; i++) {
-    EXPECT_TRUE(b.isInside(b.randomPoint()));
+    EXPECT_TRUE(b.isInside(b.randomPoint(random)));
   }
 
   constexpr double STEP_SIZE = 0.001;
   const double max_distance = b.diagonal() / STEP_SIZE;
   for (int i = 0; i < 10; i++) {
-    EXPECT_TRUE(b.randomDistance(STEP_SIZE) <= max_distance);
+    EXPECT_TRUE(b.randomDistance(STEP_SIZE, random) <= max_distance);
   }
 }
 
@@ -48,13 +52,20 @@ TEST(Box, Displaced) {
   EXPECT_FALSE(b.isInside({-0.5, -0.5, -0.5}));
   EXPECT_TRUE(b.isInside({0.5, 1.5, 0}));
 
+  cpet::util::SampleRandom random{1, 0, 0};
   for (int i = 0; i < 100; i++) {
-    EXPECT_TRUE(b.isInside(b.randomPoint()));
+    const Eigen::Vector3d p = b.randomPoint(random);
+    EXPECT_TRUE(b.isInside(p));
+    EXPECT_LE((p - b.center()).norm(), b.boundingRadius());
+    EXPECT_TRUE(((p - b.center()).cwiseAbs().array() <=
+                 b.halfExtents().array())
+                    .all());
   }
+  EXPECT_EQ(b.center(), Eigen::Vector3d(0, 1, 0));
   constexpr double STEP_SIZE = 0.001;
   const double max_distance = b.diagonal() / STEP_SIZE;
   for (int i = 0; i < 10; i++) {
-    EXPECT_TRUE(b.randomDistance(STEP_SIZE) <= max_distance);
+    EXPECT_TRUE(b.randomDistance(STEP_SIZE, random) <= max_distance);
   }
 }
 
@@ -118,6 +129,34 @@ TEST(Box, PartitionDisplaced) {
   }
 }
 
+TEST(StructuredGrid, TilesCoverEveryPointOnce) {
+  const cpet::Box b({3, 3, 2}, {1, 0, 1});
+  const auto grid = b.grid({3, 3, 2});
+  ASSERT_EQ(grid.dims, (std::array<size_t, 3>{7, 7, 5}));
+
+  const auto points = grid.points();
+  std::vector<int> seen(grid.size(), 0);
+  cpet::StructuredGrid::TileIndices indices;
+  for (size_t tile = 0; tile < grid.tiles(); tile++) {
+    const size_t count = grid.tile(tile, indices);
+    for (size_t i = 0; i < count; i++) {
+      seen[indices[i]]++;
+      EXPECT_EQ(grid.point(indices[i]), points[indices[i]]);
+    }
+  }
+  EXPECT_TRUE(std::all_of(seen.begin(), seen.end(),
+                          [](int count) { return count == 1; }));
+  EXPECT_EQ(b.grid({0, 1, 1}).size(), 0);
+}
+
+TEST(Volume, VisitsConcreteShape) {
+  const auto volume = cpet::Volume::generateVolume({"box", "1", "2", "3"});
+  const bool isBox = cpet::visitVolume(*volume, [](const auto& shape) {
+    return std::is_same_v<std::decay_t<decltype(shape)>, cpet::Box>;
+  });
+  EXPECT_TRUE(isBox);
+}
+
 TEST(Box, InvalidParameters) {
   EXPECT_THROW(cpet::Box({-1.5, 2, 3}), cpet::value_error);
   EXPECT_THROW(cpet::Box({1.5, -2, 3}), cpet::value_error);